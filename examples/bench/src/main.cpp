@@ -0,0 +1,383 @@
+#include <neogfx/neogfx.hpp>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <boost/lexical_cast.hpp>
+#include <boost/optional.hpp>
+#include <neogfx/app.hpp>
+#include <neogfx/window.hpp>
+#include <neogfx/vertical_layout.hpp>
+#include <neogfx/widget.hpp>
+#include <neogfx/image.hpp>
+#include <neogfx/texture.hpp>
+#include <neogfx/path.hpp>
+#include <neogfx/i_native_window.hpp>
+
+namespace ng = neogfx;
+
+namespace
+{
+	struct settings
+	{
+		ng::renderer renderer = ng::renderer::Offscreen;
+		uint32_t width = 1024;
+		uint32_t height = 768;
+		std::vector<uint32_t> sizes = { 16, 64, 256 };
+		std::vector<uint32_t> counts = { 100, 1000 };
+		uint32_t frames = 60;
+		uint32_t warmUpFrames = 5;
+		std::string filter;
+		std::string output;
+	};
+
+	struct result
+	{
+		std::string name;
+		uint32_t size;
+		uint32_t count;
+		uint32_t frames;
+		double microsecondsPerFrame;
+		double operationsPerSecond;
+	};
+
+	typedef std::function<void(const ng::graphics_context&, const ng::rect&, uint32_t)> operation;
+
+	struct benchmark
+	{
+		std::string name;
+		std::function<operation(uint32_t)> prepare;
+	};
+
+	// draws the current benchmark's operation aCount times per frame
+	class canvas : public ng::widget
+	{
+	public:
+		canvas(ng::i_layout& aLayout) : 
+			ng::widget(aLayout), iSize(0), iCount(0)
+		{
+			set_size_policy(ng::size_policy::Expanding);
+		}
+	public:
+		void set_operation(const operation& aOperation, uint32_t aSize, uint32_t aCount)
+		{
+			iOperation = aOperation;
+			iSize = aSize;
+			iCount = aCount;
+		}
+	public:
+		virtual void paint(ng::graphics_context& aGraphicsContext) const
+		{
+			if (!iOperation)
+				return;
+			ng::size area = client_rect().extents() - ng::size{ static_cast<ng::dimension>(iSize), static_cast<ng::dimension>(iSize) };
+			uint32_t across = std::max<uint32_t>(1, static_cast<uint32_t>(area.cx));
+			uint32_t down = std::max<uint32_t>(1, static_cast<uint32_t>(area.cy));
+			for (uint32_t i = 0; i < iCount; ++i)
+			{
+				// scatter the operations so that successive ones neither overlap exactly nor hit the same tile
+				ng::point position{ static_cast<ng::coordinate>((i * 37) % across), static_cast<ng::coordinate>((i * 53) % down) };
+				iOperation(aGraphicsContext, ng::rect{ position, ng::size{ static_cast<ng::dimension>(iSize), static_cast<ng::dimension>(iSize) } }, i);
+			}
+		}
+	private:
+		operation iOperation;
+		uint32_t iSize;
+		uint32_t iCount;
+	};
+
+	ng::colour colour_of(uint32_t aIndex)
+	{
+		return ng::colour{ static_cast<uint8_t>(64 + (aIndex * 47) % 192), static_cast<uint8_t>(64 + (aIndex * 89) % 192), static_cast<uint8_t>(64 + (aIndex * 131) % 192), 0xC0 };
+	}
+
+	ng::path star(const ng::rect& aRect)
+	{
+		ng::path result;
+		ng::point centre = aRect.centre();
+		for (uint32_t i = 0; i < 10; ++i)
+		{
+			double radius = (i % 2 == 0 ? aRect.cx : aRect.cx * 0.4) / 2.0;
+			double angle = i * 3.14159265358979 / 5.0;
+			ng::point p{ centre.x + radius * std::sin(angle), centre.y - radius * std::cos(angle) };
+			if (i == 0)
+				result.move_to(p);
+			else
+				result.line_to(p);
+		}
+		return result;
+	}
+
+	std::string sample_text(uint32_t aSize)
+	{
+		static const std::string sWords = "The quick brown fox jumps over the lazy dog. ";
+		std::string result;
+		while (result.size() < aSize)
+			result += sWords;
+		return result.substr(0, std::max<uint32_t>(aSize, 1));
+	}
+
+	std::vector<benchmark> benchmarks(const ng::font& aFont)
+	{
+		std::vector<benchmark> result;
+		auto simple = [&result](const std::string& aName, const operation& aOperation)
+		{
+			result.push_back(benchmark{ aName, [aOperation](uint32_t) { return aOperation; } });
+		};
+		simple("fill_rect", [](const ng::graphics_context& aGc, const ng::rect& aRect, uint32_t aIndex)
+		{
+			aGc.fill_rect(aRect, colour_of(aIndex));
+		});
+		simple("fill_rect_gradient", [](const ng::graphics_context& aGc, const ng::rect& aRect, uint32_t aIndex)
+		{
+			aGc.fill_rect(aRect, ng::gradient{ colour_of(aIndex), colour_of(aIndex + 1), aIndex % 2 == 0 ? ng::gradient::Vertical : ng::gradient::Horizontal });
+		});
+		simple("fill_rect_radial_gradient", [](const ng::graphics_context& aGc, const ng::rect& aRect, uint32_t aIndex)
+		{
+			aGc.fill_rect(aRect, ng::gradient{ colour_of(aIndex), colour_of(aIndex + 1), ng::gradient::Radial });
+		});
+		simple("draw_rect", [](const ng::graphics_context& aGc, const ng::rect& aRect, uint32_t aIndex)
+		{
+			aGc.draw_rect(aRect, ng::pen{ colour_of(aIndex), 1.0 });
+		});
+		simple("fill_rounded_rect", [](const ng::graphics_context& aGc, const ng::rect& aRect, uint32_t aIndex)
+		{
+			aGc.fill_rounded_rect(aRect, aRect.cx / 8.0, colour_of(aIndex));
+		});
+		simple("fill_rounded_rect_gradient", [](const ng::graphics_context& aGc, const ng::rect& aRect, uint32_t aIndex)
+		{
+			aGc.fill_rounded_rect(aRect, aRect.cx / 8.0, ng::gradient{ colour_of(aIndex), colour_of(aIndex + 1) });
+		});
+		simple("draw_rounded_rect", [](const ng::graphics_context& aGc, const ng::rect& aRect, uint32_t aIndex)
+		{
+			aGc.draw_rounded_rect(aRect, aRect.cx / 8.0, ng::pen{ colour_of(aIndex), 2.0 });
+		});
+		simple("draw_line", [](const ng::graphics_context& aGc, const ng::rect& aRect, uint32_t aIndex)
+		{
+			aGc.draw_line(aRect.top_left(), aRect.bottom_right(), ng::pen{ colour_of(aIndex), 1.0 });
+		});
+		simple("fill_circle", [](const ng::graphics_context& aGc, const ng::rect& aRect, uint32_t aIndex)
+		{
+			aGc.fill_circle(aRect.centre(), aRect.cx / 2.0, colour_of(aIndex));
+		});
+		simple("draw_circle", [](const ng::graphics_context& aGc, const ng::rect& aRect, uint32_t aIndex)
+		{
+			aGc.draw_circle(aRect.centre(), aRect.cx / 2.0, ng::pen{ colour_of(aIndex), 2.0 });
+		});
+		simple("draw_arc", [](const ng::graphics_context& aGc, const ng::rect& aRect, uint32_t aIndex)
+		{
+			aGc.draw_arc(aRect.centre(), aRect.cx / 2.0, 0.0, 4.0, ng::pen{ colour_of(aIndex), 2.0 });
+		});
+		simple("fill_arc", [](const ng::graphics_context& aGc, const ng::rect& aRect, uint32_t aIndex)
+		{
+			aGc.fill_arc(aRect.centre(), aRect.cx / 2.0, 0.0, 4.0, colour_of(aIndex));
+		});
+		result.push_back(benchmark{ "draw_path", [](uint32_t aSize) -> operation
+		{
+			auto path = std::make_shared<ng::path>(star(ng::rect{ ng::point{}, ng::size{ static_cast<ng::dimension>(aSize), static_cast<ng::dimension>(aSize) } }));
+			return [path](const ng::graphics_context& aGc, const ng::rect& aRect, uint32_t aIndex)
+			{
+				path->set_position(aRect.top_left());
+				aGc.draw_path(*path, ng::pen{ colour_of(aIndex), 1.0 });
+			};
+		} });
+		result.push_back(benchmark{ "fill_and_draw_path", [](uint32_t aSize) -> operation
+		{
+			auto path = std::make_shared<ng::path>(star(ng::rect{ ng::point{}, ng::size{ static_cast<ng::dimension>(aSize), static_cast<ng::dimension>(aSize) } }));
+			return [path](const ng::graphics_context& aGc, const ng::rect& aRect, uint32_t aIndex)
+			{
+				path->set_position(aRect.top_left());
+				aGc.fill_and_draw_path(*path, colour_of(aIndex), ng::pen{ colour_of(aIndex + 1), 1.0 });
+			};
+		} });
+		result.push_back(benchmark{ "draw_texture", [](uint32_t aSize) -> operation
+		{
+			ng::image checkerboard;
+			checkerboard.resize(ng::size{ static_cast<ng::dimension>(aSize), static_cast<ng::dimension>(aSize) });
+			for (uint32_t y = 0; y < aSize; ++y)
+				for (uint32_t x = 0; x < aSize; ++x)
+					checkerboard.set_pixel(ng::point{ static_cast<ng::coordinate>(x), static_cast<ng::coordinate>(y) }, ((x / 8) + (y / 8)) % 2 == 0 ? ng::colour::White : ng::colour::Black);
+			auto texture = std::make_shared<ng::texture>(checkerboard);
+			return [texture](const ng::graphics_context& aGc, const ng::rect& aRect, uint32_t)
+			{
+				aGc.draw_texture(aRect, *texture);
+			};
+		} });
+		result.push_back(benchmark{ "draw_text", [aFont](uint32_t aSize) -> operation
+		{
+			// shaped on every call
+			std::string text = sample_text(aSize / 4);
+			return [aFont, text](const ng::graphics_context& aGc, const ng::rect& aRect, uint32_t aIndex)
+			{
+				aGc.draw_text(aRect.top_left(), text, aFont, colour_of(aIndex));
+			};
+		} });
+		result.push_back(benchmark{ "draw_glyph_text_cached", [aFont](uint32_t aSize) -> operation
+		{
+			// shaped once, on first use, then only drawn
+			std::string text = sample_text(aSize / 4);
+			auto glyphText = std::make_shared<boost::optional<ng::glyph_text>>();
+			return [aFont, text, glyphText](const ng::graphics_context& aGc, const ng::rect& aRect, uint32_t aIndex)
+			{
+				if (*glyphText == boost::none)
+					*glyphText = aGc.to_glyph_text(text, aFont);
+				aGc.draw_glyph_text(aRect.top_left(), **glyphText, aFont, colour_of(aIndex));
+			};
+		} });
+		result.push_back(benchmark{ "draw_multiline_text", [aFont](uint32_t aSize) -> operation
+		{
+			std::string text = sample_text(aSize * 2);
+			return [aFont, text](const ng::graphics_context& aGc, const ng::rect& aRect, uint32_t aIndex)
+			{
+				aGc.draw_multiline_text(aRect.top_left(), text, aFont, aRect.cx, colour_of(aIndex));
+			};
+		} });
+		return result;
+	}
+
+	// renders aFrames frames and returns the time taken per frame in microseconds; reading back the final frame waits 
+	// for all of the queued drawing to complete
+	double run(ng::window& aWindow, canvas& aCanvas, uint32_t aFrames)
+	{
+		ng::i_native_window& surface = aWindow.native_surface();
+		ng::image readBack;
+		auto start = std::chrono::steady_clock::now();
+		uint64_t target = surface.frame_counter() + aFrames;
+		while (surface.frame_counter() < target)
+		{
+			aCanvas.update();
+			surface.render();
+		}
+		surface.read_pixels(readBack);
+		auto finish = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::micro>(finish - start).count() / std::max<uint32_t>(aFrames, 1);
+	}
+
+	std::vector<uint32_t> parse_list(const std::string& aValue)
+	{
+		std::vector<uint32_t> result;
+		std::istringstream input(aValue);
+		std::string item;
+		while (std::getline(input, item, ','))
+			result.push_back(boost::lexical_cast<uint32_t>(item));
+		return result;
+	}
+
+	settings parse_arguments(int argc, char* argv[])
+	{
+		settings result;
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string argument = argv[i];
+			auto separator = argument.find('=');
+			std::string name = argument.substr(0, separator);
+			std::string value = separator != std::string::npos ? argument.substr(separator + 1) : std::string{};
+			if (name == "--renderer")
+				result.renderer = (value == "software" ? ng::renderer::Software : ng::renderer::Offscreen);
+			else if (name == "--width")
+				result.width = boost::lexical_cast<uint32_t>(value);
+			else if (name == "--height")
+				result.height = boost::lexical_cast<uint32_t>(value);
+			else if (name == "--sizes")
+				result.sizes = parse_list(value);
+			else if (name == "--counts")
+				result.counts = parse_list(value);
+			else if (name == "--frames")
+				result.frames = boost::lexical_cast<uint32_t>(value);
+			else if (name == "--warm-up")
+				result.warmUpFrames = boost::lexical_cast<uint32_t>(value);
+			else if (name == "--filter")
+				result.filter = value;
+			else if (name == "--output")
+				result.output = value;
+			else
+				throw std::invalid_argument("unknown argument '" + argument + "'");
+		}
+		return result;
+	}
+
+	void write_json(std::ostream& aOutput, const settings& aSettings, double aBaseline, const std::vector<result>& aResults)
+	{
+		aOutput << "{\n";
+		aOutput << "  \"renderer\": \"" << (aSettings.renderer == ng::renderer::Software ? "software" : "offscreen") << "\",\n";
+		aOutput << "  \"surface\": { \"width\": " << aSettings.width << ", \"height\": " << aSettings.height << " },\n";
+		aOutput << "  \"frames\": " << aSettings.frames << ",\n";
+		aOutput << "  \"baselineMicrosecondsPerFrame\": " << aBaseline << ",\n";
+		aOutput << "  \"results\": [";
+		for (std::size_t i = 0; i < aResults.size(); ++i)
+		{
+			const auto& r = aResults[i];
+			aOutput << (i == 0 ? "\n" : ",\n");
+			aOutput << "    { \"name\": \"" << r.name << "\", \"size\": " << r.size << ", \"count\": " << r.count << ", \"frames\": " << r.frames <<
+				", \"microsecondsPerFrame\": " << r.microsecondsPerFrame << ", \"operationsPerSecond\": " << r.operationsPerSecond << " }";
+		}
+		aOutput << "\n  ]\n}" << std::endl;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	settings benchSettings;
+	try
+	{
+		benchSettings = parse_arguments(argc, argv);
+	}
+	catch (std::exception& e)
+	{
+		std::cerr << "neogfx_bench: " << e.what() << std::endl;
+		std::cerr << "usage: neogfx_bench [--renderer=offscreen|software] [--width=W] [--height=H] [--sizes=S1,S2,...] [--counts=N1,N2,...] [--frames=F] [--warm-up=F] [--filter=NAME] [--output=FILE]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	ng::app app("neogfx_bench", benchSettings.renderer);
+	ng::window window(ng::size{ static_cast<ng::dimension>(benchSettings.width), static_cast<ng::dimension>(benchSettings.height) });
+	window.set_margins(ng::margins{});
+	ng::vertical_layout layout(window);
+	layout.set_margins(ng::margins{});
+	canvas benchCanvas(layout);
+
+	// nothing should throttle the frames we ask for
+	window.native_surface().set_frame_pacing(ng::frame_pacing::OnDemand);
+	window.native_surface().limit_frame_rate(1000000);
+
+	ng::app::event_processing_context context(app, "neogfx_bench");
+	while (!window.ready_to_render())
+		app.process_events(context);
+
+	// the cost of a frame that draws nothing (background, present and read back) is subtracted from each result
+	run(window, benchCanvas, benchSettings.warmUpFrames);
+	double baseline = run(window, benchCanvas, benchSettings.frames);
+
+	std::vector<result> results;
+	for (const auto& b : benchmarks(benchCanvas.font()))
+	{
+		if (!benchSettings.filter.empty() && b.name.find(benchSettings.filter) == std::string::npos)
+			continue;
+		for (auto size : benchSettings.sizes)
+		{
+			operation op = b.prepare(size);
+			for (auto count : benchSettings.counts)
+			{
+				benchCanvas.set_operation(op, size, count);
+				run(window, benchCanvas, benchSettings.warmUpFrames);
+				double microsecondsPerFrame = run(window, benchCanvas, benchSettings.frames);
+				double net = std::max(microsecondsPerFrame - baseline, 1.0e-3);
+				results.push_back(result{ b.name, size, count, benchSettings.frames, microsecondsPerFrame, count * 1.0e6 / net });
+				std::cerr << b.name << " size=" << size << " count=" << count << ": " << microsecondsPerFrame << " us/frame" << std::endl;
+			}
+		}
+		benchCanvas.set_operation(operation{}, 0, 0);
+	}
+
+	if (benchSettings.output.empty())
+		write_json(std::cout, benchSettings, baseline, results);
+	else
+	{
+		std::ofstream output(benchSettings.output);
+		write_json(output, benchSettings, baseline, results);
+	}
+	return EXIT_SUCCESS;
+}
@@ -33,6 +33,7 @@
 #include "style.hpp"
 #include "action.hpp"
 #include "i_mnemonic.hpp"
+#include "profiler.hpp"
 
 namespace neogfx
 {
@@ -65,7 +66,7 @@ namespace neogfx
 		struct style_not_found : std::runtime_error { style_not_found() : std::runtime_error("neogfx::app::style_not_found") {} };
 		struct style_exists : std::runtime_error { style_exists() : std::runtime_error("neogfx::app::style_exists") {} };
 	public:
-		app(const std::string& aName = std::string());
+		app(const std::string& aName = std::string(), neogfx::renderer aRenderer = neogfx::renderer::OpenGL);
 		~app();
 	public:
 		static app& instance();
@@ -73,6 +74,7 @@ namespace neogfx
 		virtual int exec(bool aQuitWhenLastWindowClosed = true);
 		virtual void quit(int aResultCode);
 		virtual i_basic_services& basic_services() const;
+		neogfx::renderer renderer() const;
 		virtual i_rendering_engine& rendering_engine() const;
 		virtual i_surface_manager& surface_manager() const;
 		virtual i_keyboard& keyboard() const;
@@ -90,11 +92,15 @@ namespace neogfx
 		virtual void remove_action(i_action& aAction);
 		virtual void add_mnemonic(i_mnemonic& aMnemonic);
 		virtual void remove_mnemonic(i_mnemonic& aMnemonic);
+	public:
+		const neogfx::profiler& profiler() const;
+		neogfx::profiler& profiler();
 	public:
 		virtual bool process_events(i_event_processing_context& aContext);
 	private:
 		virtual void task() {}
 		bool do_process_events();
+		void wait_for_events();
 	private:
 		virtual bool key_pressed(scan_code_e aScanCode, key_code_e aKeyCode, key_modifiers_e aKeyModifiers);
 		virtual bool key_released(scan_code_e aScanCode, key_code_e aKeyCode, key_modifiers_e aKeyModifiers);
@@ -106,6 +112,7 @@ namespace neogfx
 		std::unique_ptr<i_basic_services> iBasicServices;
 		std::unique_ptr<i_keyboard> iKeyboard;
 		std::unique_ptr<i_clipboard> iClipboard;
+		neogfx::renderer iRenderer;
 		std::unique_ptr<i_rendering_engine> iRenderingEngine;
 		std::unique_ptr<i_surface_manager> iSurfaceManager;
 		boost::optional<int> iQuitResultCode;
@@ -115,5 +122,6 @@ namespace neogfx
 		mnemonic_list iMnemonics;
 		std::unique_ptr<i_widget> iSystemCache;
 		std::unique_ptr<event_processing_context> iContext;
+		neogfx::profiler iProfiler;
 	};
 }
\ No newline at end of file
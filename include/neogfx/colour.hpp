@@ -788,14 +788,19 @@ namespace neogfx
 		{
 			Vertical,
 			Horizontal,
+			Diagonal,
 			Radial
 		};
+		typedef std::pair<double, colour> colour_stop;
+		typedef std::vector<colour_stop> colour_stop_list;
 	public:
 		struct bad_position : std::logic_error { bad_position() : std::logic_error("neogfx::gradient::bad_position") {} };
+		struct bad_colour_stops : std::logic_error { bad_colour_stops() : std::logic_error("neogfx::gradient::bad_colour_stops") {} };
 		// construction
 	public:
 		gradient(const colour& aFrom, const colour& aTo, direction_e aDirection = Vertical);
 		gradient(const colour& aFromTo, direction_e aDirection = Vertical);
+		gradient(const colour_stop_list& aColourStops, direction_e aDirection = Vertical);
 		// operations
 	public:
 		colour at(coordinate aPos, coordinate aStart, coordinate aEnd) const;
@@ -804,6 +809,7 @@ namespace neogfx
 		colour& from();
 		const colour& to() const;
 		colour& to();
+		const colour_stop_list& colour_stops() const;
 		gradient with_alpha(colour::component aAlpha) const;
 		gradient with_combined_alpha(colour::component aAlpha) const;
 		direction_e direction() const;
@@ -812,8 +818,7 @@ namespace neogfx
 		bool operator<(const gradient& aOther) const;
 		// attributes
 	private:
-		colour iFrom;
-		colour iTo;
+		colour_stop_list iColourStops;
 		direction_e iDirection;
 	};
 
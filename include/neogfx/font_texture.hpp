@@ -37,6 +37,7 @@ namespace neogfx
 		virtual const size& extents() const;
 		virtual bool allocate_glyph_space(const size& aSize, rect& aResult);
 		virtual void* handle() const;
+		virtual void update(const rect& aRect, const void* aPixels);
 	private:
 		size iExtents;
 		bool iSubPixelRendering;
@@ -47,17 +48,19 @@ namespace neogfx
 	class glyph_texture : public i_glyph_texture
 	{
 	public:
-		glyph_texture(const i_font_texture& aFontTexture, const rect& aFontTextureLocation, const size& aExtents, const point& aPlacement);
+		glyph_texture(const i_font_texture& aFontTexture, const rect& aFontTextureLocation, const size& aExtents, const point& aPlacement, std::vector<uint8_t> aCoverage);
 		~glyph_texture();
 	public:
 		virtual const i_font_texture& font_texture() const;
 		virtual const rect& font_texture_location() const;
 		virtual const size& extents() const;
 		virtual const point& placement() const;
+		virtual const std::vector<uint8_t>& coverage() const;
 	private:
 		const i_font_texture& iFontTexture;
 		const rect iFontTextureLocation;
 		const size iExtents;
 		const point iPlacement;
+		const std::vector<uint8_t> iCoverage;
 	};
 }
\ No newline at end of file
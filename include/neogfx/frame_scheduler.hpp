@@ -0,0 +1,93 @@
+// frame_scheduler.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include "neogfx.hpp"
+#include <chrono>
+#include <array>
+#include <boost/optional.hpp>
+
+namespace neogfx
+{
+	enum class frame_pacing : uint32_t
+	{
+		OnDemand,	// a frame is only produced when something has been invalidated (GUI windows)
+		Continuous	// frames are produced on a regular cadence (games, animation)
+	};
+
+	struct frame_statistics
+	{
+		uint64_t frames;
+		uint64_t missedDeadlines;
+		double minimumFrameTime;	// milliseconds
+		double averageFrameTime;	// milliseconds
+		double p99FrameTime;		// milliseconds
+	};
+
+	// Decides when a surface should next produce a frame. Deadlines are absolute times on a monotonic clock; the time 
+	// a frame takes (from the start of rendering until the present returns) is fed back so that with a present that 
+	// is synchronized to vertical blank rendering can start just in time for the next refresh.
+	class frame_scheduler
+	{
+		// types
+	public:
+		typedef std::chrono::steady_clock clock;
+		typedef clock::time_point time_point;
+		typedef clock::duration duration;
+		// constants
+	public:
+		static const std::size_t FrameTimeSamples = 256;
+		// construction
+	public:
+		frame_scheduler(neogfx::frame_pacing aPacing = neogfx::frame_pacing::OnDemand, const boost::optional<uint32_t>& aFrameRate = 60);
+		// attributes
+	public:
+		neogfx::frame_pacing frame_pacing() const;
+		void set_frame_pacing(neogfx::frame_pacing aPacing);
+		const boost::optional<uint32_t>& frame_rate() const;
+		void set_frame_rate(const boost::optional<uint32_t>& aFrameRate);
+		void set_refresh_rate(const boost::optional<uint32_t>& aRefreshRate);
+		time_point next_frame_time() const;
+		neogfx::frame_statistics frame_statistics() const;
+		// operations
+	public:
+		bool frame_due(time_point aNow) const;
+		void frame_started(time_point aNow);
+		void frame_skipped(time_point aNow);
+		void frame_presented(time_point aPresentStarted, time_point aPresentFinished);
+		// implementation
+	private:
+		duration frame_period() const;
+		duration refresh_period() const;
+		duration render_estimate() const;
+		void record(duration aFrameTime);
+	private:
+		neogfx::frame_pacing iPacing;
+		boost::optional<uint32_t> iFrameRate;
+		boost::optional<uint32_t> iRefreshRate;
+		time_point iNextFrameTime;
+		time_point iFrameStarted;
+		uint64_t iFrames;
+		uint64_t iMissedDeadlines;
+		std::array<double, FrameTimeSamples> iFrameTimes;
+		double iRenderEstimate;
+	};
+}
@@ -21,6 +21,9 @@
 
 #include "neogfx.hpp"
 #include <type_traits>
+#include <vector>
+#include <algorithm>
+#include <limits>
 #include <boost/optional.hpp>
 #include "numerical.hpp"
 
@@ -495,6 +498,245 @@ namespace neogfx
 		return ret;
 	}
 
+	// A set of disjoint rectangles kept in y-x sorted bands: every rectangle in a band has the same top and bottom,
+	// rectangles within a band are sorted by x and never touch, and vertically adjacent bands with identical spans
+	// are coalesced.
+	template <typename CoordinateType>
+	class basic_region
+	{
+		// types
+	public:
+		typedef CoordinateType coordinate_type;
+		typedef basic_point<coordinate_type> point_type;
+		typedef basic_rect<coordinate_type> rect_type;
+		typedef std::vector<rect_type> rect_list;
+		typedef typename rect_list::const_iterator const_iterator;
+	private:
+		typedef std::pair<coordinate_type, coordinate_type> span;
+		typedef std::vector<span> span_list;
+		// construction
+	public:
+		basic_region() {}
+		basic_region(const rect_type& aRect) { if (!aRect.empty()) iRects.push_back(aRect); }
+		// operations
+	public:
+		bool operator==(const basic_region& other) const { return iRects == other.iRects; }
+		bool operator!=(const basic_region& other) const { return !operator==(other); }
+		bool empty() const { return iRects.empty(); }
+		std::size_t size() const { return iRects.size(); }
+		const_iterator begin() const { return iRects.begin(); }
+		const_iterator end() const { return iRects.end(); }
+		const rect_list& rects() const { return iRects; }
+		void clear() { iRects.clear(); }
+		rect_type bounding_rect() const
+		{
+			if (empty())
+				return rect_type{};
+			coordinate_type left = iRects.front().left();
+			coordinate_type right = iRects.front().right();
+			for (const auto& r : iRects)
+			{
+				left = std::min(left, r.left());
+				right = std::max(right, r.right());
+			}
+			return rect_type{ point_type{ left, iRects.front().top() }, point_type{ right, iRects.back().bottom() } };
+		}
+		bool contains(const point_type& aPoint) const
+		{
+			for (const auto& r : iRects)
+			{
+				if (r.top() > aPoint.y)
+					break;
+				if (r.contains(aPoint))
+					return true;
+			}
+			return false;
+		}
+		bool contains(const rect_type& aRect) const
+		{
+			if (aRect.empty())
+				return true;
+			for (const auto& r : iRects)
+				if (r.contains(aRect))
+					return true;
+			return basic_region{ aRect }.subtract(*this).empty();
+		}
+		bool intersects(const rect_type& aRect) const
+		{
+			for (const auto& r : iRects)
+			{
+				if (r.top() >= aRect.bottom())
+					break;
+				if (r.left() < aRect.right() && aRect.left() < r.right() && r.top() < aRect.bottom() && aRect.top() < r.bottom())
+					return true;
+			}
+			return false;
+		}
+		basic_region& combine(const basic_region& aOther)
+		{
+			if (empty())
+				iRects = aOther.iRects;
+			else if (!aOther.empty())
+				*this = apply(*this, aOther, [](bool aInLeft, bool aInRight) { return aInLeft || aInRight; });
+			return *this;
+		}
+		basic_region& intersect(const basic_region& aOther)
+		{
+			if (!empty())
+				*this = apply(*this, aOther, [](bool aInLeft, bool aInRight) { return aInLeft && aInRight; });
+			return *this;
+		}
+		basic_region& subtract(const basic_region& aOther)
+		{
+			if (!empty() && !aOther.empty())
+				*this = apply(*this, aOther, [](bool aInLeft, bool aInRight) { return aInLeft && !aInRight; });
+			return *this;
+		}
+		basic_region intersection(const basic_region& aOther) const { return basic_region{ *this }.intersect(aOther); }
+		basic_region difference(const basic_region& aOther) const { return basic_region{ *this }.subtract(aOther); }
+		basic_region& offset(const point_type& aOffset)
+		{
+			for (auto& r : iRects)
+				r.position() += aOffset;
+			return *this;
+		}
+		rect_list coverage(std::size_t aMaxRects) const
+		{
+			// approximates the region with at most aMaxRects rectangles by repeatedly merging the pair whose
+			// bounding rectangle adds the least area
+			rect_list result = iRects;
+			while (result.size() > aMaxRects && result.size() > 1)
+			{
+				std::size_t bestLeft = 0;
+				std::size_t bestRight = 1;
+				coordinate_type bestWaste = std::numeric_limits<coordinate_type>::max();
+				for (std::size_t i = 0; i < result.size(); ++i)
+					for (std::size_t j = i + 1; j < result.size(); ++j)
+					{
+						rect_type combined = result[i].combine(result[j]);
+						coordinate_type waste = combined.cx * combined.cy - result[i].cx * result[i].cy - result[j].cx * result[j].cy;
+						if (waste < bestWaste)
+						{
+							bestLeft = i;
+							bestRight = j;
+							bestWaste = waste;
+						}
+					}
+				result[bestLeft] = result[bestLeft].combine(result[bestRight]);
+				result.erase(result.begin() + bestRight);
+			}
+			return result;
+		}
+		// implementation
+	private:
+		template <typename Operation>
+		static basic_region apply(const basic_region& aLeft, const basic_region& aRight, Operation aOperation)
+		{
+			std::vector<coordinate_type> edges;
+			edges.reserve((aLeft.size() + aRight.size()) * 2);
+			for (const auto& r : aLeft.iRects)
+			{
+				edges.push_back(r.top());
+				edges.push_back(r.bottom());
+			}
+			for (const auto& r : aRight.iRects)
+			{
+				edges.push_back(r.top());
+				edges.push_back(r.bottom());
+			}
+			std::sort(edges.begin(), edges.end());
+			edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+			basic_region result;
+			span_list leftSpans, rightSpans, spans, previousSpans;
+			coordinate_type previousBottom = coordinate_type{};
+			std::size_t previousBand = 0;
+			auto leftBand = aLeft.iRects.begin();
+			auto rightBand = aRight.iRects.begin();
+			for (std::size_t e = 0; e + 1 < edges.size(); ++e)
+			{
+				coordinate_type top = edges[e];
+				coordinate_type bottom = edges[e + 1];
+				band_spans(aLeft.iRects, leftBand, top, leftSpans);
+				band_spans(aRight.iRects, rightBand, top, rightSpans);
+				combine_spans(leftSpans, rightSpans, aOperation, spans);
+				if (spans.empty())
+					continue;
+				if (spans == previousSpans && previousBottom == top)
+				{
+					for (auto r = result.iRects.begin() + previousBand; r != result.iRects.end(); ++r)
+						r->cy = bottom - r->y;
+				}
+				else
+				{
+					previousBand = result.iRects.size();
+					for (const auto& s : spans)
+						result.iRects.push_back(rect_type{ point_type{ s.first, top }, point_type{ s.second, bottom } });
+					previousSpans.swap(spans);
+				}
+				previousBottom = bottom;
+			}
+			return result;
+		}
+		static void band_spans(const rect_list& aRects, const_iterator& aBand, coordinate_type aTop, span_list& aSpans)
+		{
+			aSpans.clear();
+			while (aBand != aRects.end() && aBand->bottom() <= aTop)
+			{
+				auto y = aBand->y;
+				while (aBand != aRects.end() && aBand->y == y)
+					++aBand;
+			}
+			if (aBand == aRects.end() || aBand->top() > aTop)
+				return;
+			for (auto r = aBand; r != aRects.end() && r->y == aBand->y; ++r)
+				aSpans.emplace_back(r->left(), r->right());
+		}
+		template <typename Operation>
+		static void combine_spans(const span_list& aLeft, const span_list& aRight, Operation aOperation, span_list& aResult)
+		{
+			aResult.clear();
+			const coordinate_type none = std::numeric_limits<coordinate_type>::max();
+			auto l = aLeft.begin();
+			auto r = aRight.begin();
+			coordinate_type position = std::min(l != aLeft.end() ? l->first : none, r != aRight.end() ? r->first : none);
+			while (l != aLeft.end() || r != aRight.end())
+			{
+				bool inLeft = l != aLeft.end() && l->first <= position;
+				bool inRight = r != aRight.end() && r->first <= position;
+				coordinate_type next = none;
+				if (l != aLeft.end())
+					next = std::min(next, inLeft ? l->second : l->first);
+				if (r != aRight.end())
+					next = std::min(next, inRight ? r->second : r->first);
+				if ((inLeft || inRight) && aOperation(inLeft, inRight))
+				{
+					if (!aResult.empty() && aResult.back().second == position)
+						aResult.back().second = next;
+					else
+						aResult.emplace_back(position, next);
+				}
+				if (inLeft && l->second == next)
+					++l;
+				if (inRight && r->second == next)
+					++r;
+				position = next;
+			}
+		}
+		// attributes
+	private:
+		rect_list iRects;
+	};
+
+	typedef basic_region<coordinate> region;
+
+	template <typename CoordinateType>
+	inline basic_region<CoordinateType> operator+(const basic_region<CoordinateType>& left, const basic_point<CoordinateType>& right)
+	{
+		basic_region<CoordinateType> ret = left;
+		ret.offset(right);
+		return ret;
+	}
+
 	template <typename CoordinateType>
 	class basic_line
 	{
@@ -875,10 +1117,12 @@ namespace std
 	{
 		size_t operator()(const neogfx::rect& aRect) const
 		{
-			return std::hash<neogfx::rect::coordinate_type>()(aRect.x) ^ 
-				std::hash<neogfx::rect::coordinate_type>()(aRect.y) ^
-				std::hash<neogfx::rect::coordinate_type>()(aRect.cx) ^
-				std::hash<neogfx::rect::coordinate_type>()(aRect.cy);
+			std::hash<neogfx::rect::coordinate_type> hasher;
+			size_t seed = hasher(aRect.x);
+			seed ^= hasher(aRect.y) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+			seed ^= hasher(aRect.cx) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+			seed ^= hasher(aRect.cy) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+			return seed;
 		}
 	};
 }
\ No newline at end of file
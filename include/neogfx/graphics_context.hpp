@@ -68,6 +68,16 @@ namespace neogfx
 	class i_widget;
 	class i_native_graphics_context;
 
+	struct glyph_run_item
+	{
+		point position;
+		const neogfx::glyph* glyph;
+		const neogfx::font* font;
+		neogfx::colour colour;
+		bool underline;
+	};
+	typedef std::vector<glyph_run_item> glyph_run;
+
 	class graphics_context : public i_device_metrics, public i_units_context
 	{
 		// types
@@ -111,6 +121,8 @@ namespace neogfx
 		void set_origin(const point& aOrigin) const;
 		point origin() const;
 		void flush() const;
+		void begin_recording() const;
+		void end_recording() const;
 		void scissor_on(const rect& aRect) const;
 		void scissor_off() const;
 		void clip_to(const rect& aRect) const;
@@ -160,6 +172,7 @@ namespace neogfx
 		void draw_glyph_text(const point& aPoint, glyph_text::const_iterator aTextBegin, glyph_text::const_iterator aTextEnd, const font& aFont, const colour& aColour) const;
 		void draw_glyph(const point& aPoint, const glyph& aGlyph, const font& aFont, const colour& aColour) const;
 		void draw_glyph_underline(const point& aPoint, const glyph& aGlyph, const font& aFont, const colour& aColour) const;
+		void draw_glyph_run(const glyph_run& aRun) const;
 		void set_glyph_text_cache(glyph_text& aGlyphTextCache) const;
 		void reset_glyph_text_cache() const;
 		void set_mnemonic(bool aShowMnemonics, char aMnemonicPrefix = '&') const;
@@ -171,6 +184,9 @@ namespace neogfx
 		void draw_texture(const point& aPoint, const i_texture& aTexture, const rect& aTextureRect, const optional_colour& aColour = optional_colour()) const;
 		void draw_texture(const rect& aRect, const i_texture& aTexture, const rect& aTextureRect, const optional_colour& aColour = optional_colour()) const;
 		void draw_texture(const texture_map& aMap, const i_texture& aTexture, const rect& aTextureRect, const optional_colour& aColour = optional_colour()) const;
+		void copy_to_texture(const rect& aSourceRect, const i_texture& aTexture) const;
+		void copy_from_texture(const i_texture& aTexture, const point& aDestination) const;
+		void copy_from_texture(const i_texture& aTexture, const rect& aDestinationRect) const;
 		// implementation
 		// from i_device_metrics
 	public:
@@ -195,27 +211,22 @@ namespace neogfx
 		mutable size iExtents;
 		mutable glyph_text* iGlyphTextCache;
 		mutable uint32_t iDrawingGlyphs;
+		mutable glyph_run iDeviceGlyphRun;
 	};
 
 	template <typename Iter>
 	inline void draw_glyph_text(const graphics_context& aGraphicsContext, const point& aPoint, Iter aTextBegin, Iter aTextEnd, const font& aFont, const colour& aColour)
 	{
-		{
-			graphics_context::glyph_drawing gd(aGraphicsContext);
-			point pos = aPoint;
-			for (Iter i = aTextBegin; i != aTextEnd; ++i)
-			{
-				aGraphicsContext.draw_glyph(pos + i->offset(), *i, aFont, aColour);
-				pos.x += i->extents().cx;
-			}
-		}
+		glyph_run run;
+		run.reserve(std::distance(aTextBegin, aTextEnd));
+		bool mnemonicsShown = aGraphicsContext.mnemonics_shown();
 		point pos = aPoint;
 		for (Iter i = aTextBegin; i != aTextEnd; ++i)
 		{
-			if (i->underline() || (aGraphicsContext.mnemonics_shown() && i->mnemonic()))
-				aGraphicsContext.draw_glyph_underline(pos, *i, aFont, aColour);
+			run.push_back(glyph_run_item{ pos, &*i, &aFont, aColour, i->underline() || (mnemonicsShown && i->mnemonic()) });
 			pos.x += i->extents().cx;
 		}
+		aGraphicsContext.draw_glyph_run(run);
 	}
 
 	class scoped_mnemonics
@@ -32,6 +32,7 @@ namespace neogfx
 		virtual const size& extents() const = 0;
 		virtual bool allocate_glyph_space(const size& aSize, rect& aResult) = 0;
 		virtual void* handle() const = 0;
+		virtual void update(const rect& aRect, const void* aPixels) = 0;
 	};
 
 	class i_glyph_texture
@@ -43,5 +44,6 @@ namespace neogfx
 		virtual const rect& font_texture_location() const = 0;
 		virtual const size& extents() const = 0;
 		virtual const point& placement() const = 0;
+		virtual const std::vector<uint8_t>& coverage() const = 0;
 	};
 }
\ No newline at end of file
@@ -29,8 +29,6 @@ namespace neogfx
 {
 	class i_native_graphics_context
 	{
-	public:
-		struct texture_not_resident : std::runtime_error { texture_not_resident() : std::runtime_error("neogfx::i_native_graphics_context::texture_not_resident") {} };
 	public:
 		virtual ~i_native_graphics_context() {}
 		virtual std::unique_ptr<i_native_graphics_context> clone() const = 0;
@@ -41,6 +39,8 @@ namespace neogfx
 		virtual const vector4& logical_coordinates() const = 0;
 		virtual void set_logical_coordinates(const vector4& aCoordinates) const = 0;
 		virtual void flush() = 0;
+		virtual void begin_recording() = 0;
+		virtual void end_recording() = 0;
 		virtual void scissor_on(const rect& aRect) = 0;
 		virtual void scissor_off() = 0;
 		virtual optional_rect scissor_rect() const = 0;
@@ -79,7 +79,10 @@ namespace neogfx
 		virtual bool mnemonics_shown() const = 0;
 		virtual void begin_drawing_glyphs() = 0;
 		virtual void draw_glyph(const point& aPoint, const glyph& aGlyph, const font& aFont, const colour& aColour) = 0;
+		virtual void draw_glyph_run(const glyph_run& aRun) = 0;
 		virtual void end_drawing_glyphs() = 0;
 		virtual void draw_texture(const texture_map& aTextureMap, const i_texture& aTexture, const rect& aTextureRect, const optional_colour& aColour) = 0;
+		virtual void copy_to_texture(const rect& aSourceRect, const i_texture& aTexture) = 0;
+		virtual void copy_from_texture(const i_texture& aTexture, const rect& aDestinationRect) = 0;
 	};
 }
\ No newline at end of file
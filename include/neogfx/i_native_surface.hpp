@@ -23,11 +23,13 @@
 #include "mouse.hpp"
 #include "event.hpp"
 #include "graphics_context.hpp"
+#include "frame_scheduler.hpp"
 
 namespace neogfx
 {
 	class i_native_graphics_context;
 	class i_widget;
+	class i_image;
 
 	class i_native_surface
 	{
@@ -64,10 +66,17 @@ namespace neogfx
 		virtual uint64_t frame_counter() const = 0;
 		virtual bool using_frame_buffer() const = 0;
 		virtual void limit_frame_rate(uint32_t aFps) = 0;
+		virtual neogfx::frame_pacing frame_pacing() const = 0;
+		virtual void set_frame_pacing(neogfx::frame_pacing aPacing) = 0;
+		virtual neogfx::frame_statistics frame_statistics() const = 0;
+		virtual boost::optional<frame_scheduler::time_point> next_frame_time() const = 0;
+		virtual bool threaded_presentation() const = 0;
+		virtual void set_threaded_presentation(bool aThreadedPresentation) = 0;
 	public:
 		virtual void invalidate(const rect& aInvalidatedRect) = 0;
 		virtual void render() = 0;
 		virtual bool is_rendering() const = 0;
+		virtual void read_pixels(i_image& aImage) const = 0;
 		virtual std::unique_ptr<i_native_graphics_context> create_graphics_context() const = 0;
 		virtual std::unique_ptr<i_native_graphics_context> create_graphics_context(const i_widget& aWidget) const = 0;
 	public:
@@ -34,6 +34,13 @@ namespace neogfx
 	public:
 		virtual void* handle() const = 0;
 		virtual bool is_resident() const = 0;
+		virtual bool is_evictable() const = 0;
+		virtual std::size_t memory_size() const = 0;
+		virtual void make_resident() = 0;
+		virtual void evict() = 0;
 		virtual const std::string& uri() const = 0;
+	public:
+		virtual const void* data() const = 0;
+		virtual void update(const rect& aRect, const void* aPixels) = 0;
 	};
 }
\ No newline at end of file
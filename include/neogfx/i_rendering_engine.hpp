@@ -31,6 +31,13 @@ namespace neogfx
 	class i_surface_manager;
 	class i_native_window_event_handler;
 
+	enum class renderer
+	{
+		OpenGL,
+		Offscreen,
+		Software
+	};
+
 	class i_screen_metrics : public i_device_metrics
 	{
 	public:
@@ -46,19 +53,42 @@ namespace neogfx
 		virtual subpixel_format_e subpixel_format() const = 0;
 	};
 
+	struct rendering_statistics
+	{
+		uint64_t frame;
+		uint64_t drawCalls;
+		uint64_t vertices;
+		uint64_t bufferBytesUploaded;
+		uint64_t textureBinds;
+		uint64_t shaderSwitches;
+		uint64_t stencilClears;
+		uint64_t glyphUploads;
+		uint64_t stateChanges;
+		uint64_t redundantStateChanges;
+		boost::optional<double> gpuTime;	// milliseconds, of the most recent frame whose timer query has completed
+	};
+
 	class i_rendering_engine
 	{
 	public:
 		class i_shader_program
 		{
+		public:
+			typedef uint32_t uniform_id;
 		public:
 			struct variable_not_found : std::logic_error { variable_not_found() : std::logic_error("neogfx::i_rendering_engine::i_shader_program::variable_not_found") {} };
 		public:
 			virtual void* handle() const = 0;
 			virtual void* variable(const std::string& aVariableName) const = 0;
+			virtual uniform_id uniform(const std::string& aName) const = 0;
 			virtual void set_uniform_variable(const std::string& aName, double aValue) = 0;
 			virtual void set_uniform_variable(const std::string& aName, int aValue) = 0;
 			virtual void set_uniform_variable(const std::string& aName, double aValue1, double aValue2) = 0;
+			virtual void set_uniform_matrix(const std::string& aName, const matrix44& aMatrix) = 0;
+			virtual void set_uniform_variable(uniform_id aUniform, double aValue) = 0;
+			virtual void set_uniform_variable(uniform_id aUniform, int aValue) = 0;
+			virtual void set_uniform_variable(uniform_id aUniform, double aValue1, double aValue2) = 0;
+			virtual void set_uniform_matrix(uniform_id aUniform, const matrix44& aMatrix) = 0;
 		};
 	public:
 		virtual ~i_rendering_engine() {}
@@ -88,12 +118,12 @@ namespace neogfx
 		virtual void deactivate_shader_program() = 0;
 		virtual const i_shader_program& active_shader_program() const = 0;
 		virtual i_shader_program& active_shader_program() = 0;
-		virtual const i_shader_program& monochrome_shader_program() const = 0;
-		virtual i_shader_program& monochrome_shader_program() = 0;
-		virtual const i_shader_program& subpixel_shader_program() const = 0;
-		virtual i_shader_program& subpixel_shader_program() = 0;
+		virtual const i_shader_program& default_shader_program() const = 0;
+		virtual i_shader_program& default_shader_program() = 0;
 		virtual void render_now() = 0;
+		virtual const rendering_statistics& statistics() const = 0;
 	public:
 		virtual bool process_events() = 0;
+		virtual void wait_for_events(frame_scheduler::duration aTimeout) = 0;
 	};
 }
\ No newline at end of file
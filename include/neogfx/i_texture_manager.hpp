@@ -23,6 +23,7 @@
 #include "i_native_texture.hpp"
 #include "i_image.hpp"
 #include "i_texture.hpp"
+#include "i_font_texture.hpp"
 
 namespace neogfx
 {
@@ -31,9 +32,18 @@ namespace neogfx
 	public:
 		struct texture_not_found : std::logic_error { texture_not_found() : std::logic_error("neogfx::i_texture_manager::texture_not_found") {} };
 	public:
+		virtual std::unique_ptr<i_native_texture> create_texture(const size& aExtents) = 0;
 		virtual std::unique_ptr<i_native_texture> create_texture(const i_image& aImage) = 0;
+		virtual std::unique_ptr<i_font_texture> create_font_texture(const size& aExtents, bool aSubPixelRendering) = 0;
 		virtual std::unique_ptr<i_native_texture> join_texture(const i_native_texture& aTexture) = 0;
 		virtual std::unique_ptr<i_native_texture> join_texture(const i_texture& aTexture) = 0;
 		virtual void clear_textures() = 0;
+	public:
+		virtual uint64_t texture_memory_budget() const = 0;
+		virtual void set_texture_memory_budget(uint64_t aBudget) = 0;
+		virtual uint64_t texture_memory_used() const = 0;
+		virtual uint64_t texture_uploads() const = 0;
+		virtual uint64_t texture_evictions() const = 0;
+		virtual void end_frame() = 0;
 	};
 }
\ No newline at end of file
@@ -44,6 +44,13 @@ namespace neogfx
 		ConsumeReturnKey	= 0x20000000
 	};
 
+	enum class layer_caching : uint32_t
+	{
+		Off,
+		On,
+		Automatic
+	};
+
 	class i_widget : public i_geometry, public i_units_context, public i_keyboard_handler
 	{
 	public:
@@ -119,12 +126,18 @@ namespace neogfx
 		virtual void update(const rect& aUpdateRect) = 0;
 		virtual bool requires_update() const = 0;
 		virtual rect update_rect() const = 0;
+		virtual void discard_update() = 0;
 		virtual rect default_clip_rect(bool aIncludeNonClient = false) const = 0;
 		virtual bool ready_to_render() const = 0;
 		virtual void render(graphics_context& aGraphicsContext) const = 0;
 		virtual bool transparent_background() const = 0;
 		virtual void paint_non_client(graphics_context& aGraphicsContext) const = 0;
 		virtual void paint(graphics_context& aGraphicsContext) const = 0;
+	public:
+		virtual neogfx::layer_caching layer_caching() const = 0;
+		virtual void set_layer_caching(neogfx::layer_caching aLayerCaching) = 0;
+		virtual bool layer_cached() const = 0;
+		virtual void invalidate_layer(bool aIncludeDescendants = false) = 0;
 	public:
 		virtual bool has_foreground_colour() const = 0;
 		virtual colour foreground_colour() const = 0;
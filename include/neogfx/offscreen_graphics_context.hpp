@@ -0,0 +1,43 @@
+// offscreen_graphics_context.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "neogfx.hpp"
+#include "opengl_graphics_context.hpp"
+
+namespace neogfx
+{
+	class i_rendering_engine;
+	class offscreen_window;
+
+	class offscreen_graphics_context : public opengl_graphics_context
+	{
+	public:
+		offscreen_graphics_context(i_rendering_engine& aRenderingEngine, const offscreen_window& aRenderTarget);
+		offscreen_graphics_context(i_rendering_engine& aRenderingEngine, const offscreen_window& aRenderTarget, const i_widget& aWidget);
+		offscreen_graphics_context(const offscreen_graphics_context& aOther);
+		virtual std::unique_ptr<i_native_graphics_context> clone() const;
+		~offscreen_graphics_context();
+	public:
+		virtual rect rendering_area(bool aConsiderScissor = true) const;
+	private:
+		const offscreen_window& iRenderTarget;
+	};
+}
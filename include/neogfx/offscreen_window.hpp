@@ -0,0 +1,89 @@
+// offscreen_window.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "neogfx.hpp"
+#include <deque>
+#include "offscreen_renderer.hpp"
+#include "opengl_window.hpp"
+
+namespace neogfx
+{
+	class offscreen_window : public opengl_window
+	{
+	public:
+		offscreen_window(offscreen_renderer& aRenderingEngine, i_surface_manager& aSurfaceManager, i_native_window_event_handler& aEventHandler, const point& aPosition, const size& aDimensions, window::style_e aStyle = window::Default);
+		~offscreen_window();
+	public:
+		virtual void* handle() const;
+		virtual void* native_handle() const;
+		virtual void* native_context() const;
+		virtual point surface_position() const;
+		virtual void move_surface(const point& aPosition);
+		virtual size surface_size() const;
+		virtual void resize_surface(const size& aSize);
+		virtual point mouse_position() const;
+		virtual bool is_mouse_button_pressed(mouse_button aButton) const;
+	public:
+		virtual void save_mouse_cursor();
+		virtual void set_mouse_cursor(mouse_system_cursor aSystemCursor);
+		virtual void restore_mouse_cursor();
+	public:
+		virtual void set_threaded_presentation(bool aThreadedPresentation);
+	public:
+		virtual std::unique_ptr<i_native_graphics_context> create_graphics_context() const;
+		virtual std::unique_ptr<i_native_graphics_context> create_graphics_context(const i_widget& aWidget) const;
+	public:
+		virtual dimension horizontal_dpi() const;
+		virtual dimension vertical_dpi() const;
+	public:
+		virtual void close();
+		virtual void show(bool aActivate = false);
+		virtual void hide();
+		virtual bool is_active() const;
+		virtual void activate();
+		virtual void enable(bool aEnable);
+		virtual void set_capture();
+		virtual void release_capture();
+		virtual bool is_destroyed() const;
+	public:
+		virtual void activate_context() const;
+		virtual void deactivate_context() const;
+	private:
+		void do_activate_context() const;
+		static std::deque<const offscreen_window*>& context_activation_stack();
+	private:
+		virtual bool partial_present() const;
+		virtual void display(const size& aFrameExtents, const std::vector<rect>& aDamagedRects);
+		virtual boost::optional<uint32_t> vertical_sync_rate() const;
+		virtual void* create_presentation_context();
+		virtual void make_presentation_context_current(void* aContext);
+		virtual void destroy_presentation_context(void* aContext);
+		virtual bool processing_event() const;
+	private:
+		offscreen_renderer& iRenderingEngine;
+		void* iContext;
+		point iPosition;
+		size iExtents;
+		bool iVisible;
+		bool iActive;
+		bool iDestroyed;
+	};
+}
@@ -0,0 +1,134 @@
+// opengl_command_buffer.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "neogfx.hpp"
+#include <GL/glew.h>
+#include <GL/GL.h>
+#include "geometry.hpp"
+#include "graphics_context.hpp"
+#include "opengl_renderer.hpp"
+
+namespace neogfx
+{
+	// Draw commands recorded by an opengl_graphics_context. Vertices are stored in arenas that are
+	// reused between frames; build_batches() reorders commands by render state (without moving a command
+	// past an overlapping command with different state) and merges their vertices so that each
+	// batch can be submitted with a single draw call. Fans, quads and lines are converted to independent
+	// triangles when added so that batches can be concatenated; lines are widened (and broken into dashes if
+	// stippled) in the geometry as wide and stippled lines are not available in a core profile. Analytic shapes
+	// (the Shape and Gradient kinds) are stored as one record per shape rather than as vertices and are
+	// drawn instanced; the first and count of their batches refer to shapes().
+	class opengl_command_buffer
+	{
+		// types
+	public:
+		enum kind_e : uint32_t
+		{
+			Primitive,
+			Texture,
+			Glyph,
+			Shape,
+			Gradient
+		};
+		typedef opengl_renderer::vertex vertex;
+		typedef std::vector<vertex> vertices_t;
+		typedef opengl_renderer::shape shape;
+		typedef std::vector<shape> shapes_t;
+		struct line_stipple
+		{
+			uint32_t factor;
+			uint16_t pattern;
+		};
+		struct render_state
+		{
+			kind_e kind;
+			GLenum mode;
+			GLuint texture;
+			bool monochrome;
+			smoothing_mode_e smoothingMode;
+			dimension lineWidth;
+			std::size_t scissor;
+			bool operator==(const render_state& aOther) const
+			{
+				return kind == aOther.kind && mode == aOther.mode && texture == aOther.texture && monochrome == aOther.monochrome &&
+					smoothingMode == aOther.smoothingMode && lineWidth == aOther.lineWidth && scissor == aOther.scissor;
+			}
+			bool operator!=(const render_state& aOther) const
+			{
+				return !(*this == aOther);
+			}
+		};
+		struct batch
+		{
+			render_state state;
+			std::size_t first;
+			std::size_t count;
+		};
+		typedef std::vector<batch> batch_list;
+		static const std::size_t NoScissor = 0;
+	private:
+		struct command
+		{
+			static const std::size_t npos = static_cast<std::size_t>(-1);
+			render_state state;
+			std::size_t first;
+			std::size_t count;
+			rect bounds;
+			std::size_t next;
+		};
+		struct pending_batch
+		{
+			render_state state;
+			rect bounds;
+			std::size_t firstCommand;
+			std::size_t lastCommand;
+		};
+		// construction
+	public:
+		opengl_command_buffer();
+		// operations
+	public:
+		bool empty() const;
+		void clear();
+		std::size_t add_scissor(const rect& aScissorRect);
+		const rect& scissor(std::size_t aScissor) const;
+		void add(const render_state& aState, const vertex* aFirst, const vertex* aLast, const boost::optional<line_stipple>& aStipple = boost::none);
+		void add(const render_state& aState, const shape& aShape);
+		const batch_list& build_batches();
+		const vertices_t& vertices() const;
+		const shapes_t& shapes() const;
+		static bool is_shape(const render_state& aState);
+		// implementation
+	private:
+		void add_command(const render_state& aState, std::size_t aFirst, std::size_t aCount, const rect& aBounds);
+		void add_line(const vertex& aFrom, const vertex& aTo, dimension aWidth, const boost::optional<line_stipple>& aStipple, coordinate& aStippleDistance);
+		// attributes
+	private:
+		std::vector<rect> iScissors;
+		std::vector<command> iCommands;
+		vertices_t iVertices;
+		shapes_t iShapes;
+		std::vector<pending_batch> iPendingBatches;
+		batch_list iBatches;
+		vertices_t iBatchedVertices;
+		shapes_t iBatchedShapes;
+	};
+}
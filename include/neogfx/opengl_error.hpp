@@ -26,10 +26,20 @@
 std::string glErrorString(GLenum aErrorCode);
 GLenum glCheckError(const char* file, unsigned int line);
 
+// OpenGL errors are checked after every call in debug builds; define NEOGFX_OPENGL_VALIDATION to also check them
+// in release builds or NEOGFX_NO_OPENGL_VALIDATION to stop checking them in debug builds
+#if !defined(NDEBUG) && !defined(NEOGFX_NO_OPENGL_VALIDATION) && !defined(NEOGFX_OPENGL_VALIDATION)
+#define NEOGFX_OPENGL_VALIDATION
+#endif
+
 #ifdef glCheck
 #undef glCheck 
 #endif
+#ifdef NEOGFX_OPENGL_VALIDATION
 #define glCheck(x) x; glCheckError(__FILE__, __LINE__);
+#else
+#define glCheck(x) x;
+#endif
 
 namespace neogfx
 {
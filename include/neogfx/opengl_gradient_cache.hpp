@@ -0,0 +1,77 @@
+// opengl_gradient_cache.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "neogfx.hpp"
+#include <list>
+#include <map>
+#include <GL/glew.h>
+#include <GL/GL.h>
+#include "colour.hpp"
+
+namespace neogfx
+{
+	// Gradient colour lookup tables stored as the rows of a single texture so that gradient fills are evaluated
+	// by the fragment shader and fills using different gradients can share a draw call. Rows are reused in least
+	// recently used order once every row is taken; a row must not be replaced while commands referencing it are
+	// still waiting to be drawn (see full() and contains()) which is why the renderer keeps a cache per context.
+	class opengl_gradient_cache
+	{
+		// types
+	private:
+		typedef std::vector<std::pair<double, colour::argb>> key_type;
+		typedef std::list<std::pair<key_type, uint32_t>> entry_list;
+		typedef std::map<key_type, entry_list::iterator> entry_map;
+		// constants
+	public:
+		static const uint32_t LookupTableWidth = 256;
+		static const uint32_t DefaultCapacity = 256;
+		// construction
+	public:
+		opengl_gradient_cache(uint32_t aCapacity = DefaultCapacity);
+		~opengl_gradient_cache();
+		// operations
+	public:
+		uint32_t row(const gradient& aGradient);
+		bool contains(const gradient& aGradient) const;
+		void clear();
+		// attributes
+	public:
+		GLuint texture() const;
+		uint32_t size() const;
+		uint32_t capacity() const;
+		bool full() const;
+		uint64_t hits() const;
+		uint64_t misses() const;
+		void reset_counters();
+		// implementation
+	private:
+		static key_type key(const gradient& aGradient);
+		void upload(uint32_t aRow, const gradient& aGradient);
+		// attributes
+	private:
+		uint32_t iCapacity;
+		GLuint iTexture;
+		entry_list iEntries;
+		entry_map iIndex;
+		uint64_t iHits;
+		uint64_t iMisses;
+	};
+}
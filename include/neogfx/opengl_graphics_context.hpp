@@ -22,28 +22,17 @@
 #include "neogfx.hpp"
 #include <GL/glew.h>
 #include <GL/GL.h>
-#ifdef u8
-#undef u8
-#include <hb.h>
-#include <hb-ft.h>
-#include <hb-ucdn\ucdn.h>
-#define u8
-#else
-#include <hb.h>
-#include <hb-ft.h>
-#include <hb-ucdn\ucdn.h>
-#endif
-#include <ft2build.h>
-#include FT_FREETYPE_H
-#include FT_GLYPH_H
-#include FT_OUTLINE_H
-#include FT_BITMAP_H
 #include "opengl_error.hpp"
+#include "opengl_renderer.hpp"
+#include "opengl_command_buffer.hpp"
 #include "i_native_graphics_context.hpp"
+#include "text_shaper.hpp"
 
 namespace neogfx
 {
 	class i_rendering_engine;
+	class i_font_texture;
+	class i_glyph_texture;
 
 	class opengl_graphics_context : public i_native_graphics_context
 	{
@@ -70,7 +59,6 @@ namespace neogfx
 			{
 			}
 		};
-		typedef std::array<double, 3> vertex;
 	public:
 		opengl_graphics_context(i_rendering_engine& aRenderingEngine, const i_native_surface& aSurface);
 		opengl_graphics_context(i_rendering_engine& aRenderingEngine, const i_native_surface& aSurface, const i_widget& aWidget);
@@ -85,6 +73,8 @@ namespace neogfx
 		virtual const vector4& logical_coordinates() const;
 		virtual void set_logical_coordinates(const vector4& aCoordinates) const;
 		virtual void flush();
+		virtual void begin_recording();
+		virtual void end_recording();
 		virtual void scissor_on(const rect& aRect);
 		virtual void scissor_off();
 		virtual optional_rect scissor_rect() const;
@@ -123,15 +113,35 @@ namespace neogfx
 		virtual bool mnemonics_shown() const;
 		virtual void begin_drawing_glyphs();
 		virtual void draw_glyph(const point& aPoint, const glyph& aGlyph, const font& aFont, const colour& aColour);
+		virtual void draw_glyph_run(const glyph_run& aRun);
 //		virtual void is_emoji(const std::u32string& aEmojiText) const;
 //		virtual void draw_emoji(const point& aPoint, const std::u32string& aEmojiText, const font& aFont);
 		virtual void end_drawing_glyphs();
 		virtual void draw_texture(const texture_map& aTextureMap, const i_texture& aTexture, const rect& aTextureRect, const optional_colour& aColour);
+		virtual void copy_to_texture(const rect& aSourceRect, const i_texture& aTexture);
+		virtual void copy_from_texture(const i_texture& aTexture, const rect& aDestinationRect);
 	private:
-		void apply_scissor();
+		void update_scissor();
+		void apply_scissor(std::size_t aScissor);
+		void apply_stencil_clip();
 		void apply_logical_operation();
-		vertex to_shader_vertex(const point& aPoint) const;
-		glyph_text::container to_glyph_text_impl(string::const_iterator aTextBegin, string::const_iterator aTextEnd, std::function<font(std::string::size_type)> aFontSelector, bool& aFallbackFontNeeded) const;
+		opengl_renderer& rendering_engine() const;
+		dimension pixel_size() const;
+		void draw_outline(const opengl_command_buffer::vertices_t& aVertices, std::size_t aFirst, bool aClosed, coordinate aInner, coordinate aOuter, bool aInnerFringe, const colour& aColour);
+		void draw_outline(const std::vector<point>& aOutline, bool aClosed, coordinate aInner, coordinate aOuter, bool aInnerFringe, const colour& aColour);
+		bool analytic_anti_alias() const;
+		void append_glyph(opengl_command_buffer::vertices_t& aVertices, const point& aPoint, const i_glyph_texture& aGlyphTexture, const font& aFont, const colour& aColour) const;
+		void append_glyph_underline(opengl_command_buffer::vertices_t& aVertices, const point& aPoint, const i_glyph_texture& aGlyphTexture, const font& aFont, const colour& aColour) const;
+		opengl_command_buffer::vertices_t& vertex_arena();
+		opengl_command_buffer::vertices_t& outline_arena();
+		void draw_vertices(GLenum aMode, const colour& aColour, dimension aLineWidth = 1.0, opengl_command_buffer::kind_e aKind = opengl_command_buffer::Primitive);
+		void draw_shape(const rect& aShape, dimension aRadius, dimension aOutlineWidth, const colour& aColour);
+		void draw_gradient_shape(const rect& aShape, dimension aRadius, const gradient& aGradient);
+		opengl_command_buffer::render_state glyph_state(const i_font_texture& aFontTexture) const;
+		void commit();
+		void replay();
+		int shader_mode(const opengl_command_buffer::render_state& aState) const;
+		matrix44 projection_matrix() const;
 	private:
 		i_rendering_engine& iRenderingEngine;
 		const i_native_surface& iSurface;
@@ -141,26 +151,21 @@ namespace neogfx
 		smoothing_mode_e iSmoothingMode; 
 		bool iMonochrome;
 		std::vector<logical_operation_e> iLogicalOperationStack;
-		uint32_t iClipCounter;
-		std::vector<rect> iScissorRects;
-		mutable std::vector<vertex> iVertices;
-		mutable std::vector<GLdouble> iTextureCoords;
-		mutable std::vector<GLshort> iIndices;
-		mutable std::vector<std::array<GLdouble, 4>> iColours;
-		mutable std::vector<std::array<GLdouble, 2>> iShifts;
-		struct cluster
+		struct clip
 		{
-			std::string::size_type from;
-			glyph::flags_e flags;
+			optional_rect scissor;
+			rect stencilBounds;
 		};
-		typedef std::vector<cluster> cluster_map_t;
-		mutable cluster_map_t iClusterMap;
-		mutable std::vector<text_direction> iTextDirections;
-		mutable std::u32string iCodePointsBuffer;
-		mutable std::vector<std::tuple<const char32_t*, const char32_t*, text_direction, hb_script_t>> iRuns;
-		GLint iPreviousTexture;
-		GLuint iActiveGlyphTexture;
-		bool iLineStippleActive;
-		boost::optional<std::pair<bool, char>> iMnemonic;
+		std::vector<clip> iClipStack;
+		uint32_t iStencilDepth;
+		std::vector<rect> iScissorRects;
+		std::size_t iScissor;
+		std::unique_ptr<opengl_command_buffer> iCommandBuffer;
+		uint32_t iRecording;
+		bool iDrawingGlyphs;
+		opengl_command_buffer::vertices_t iVertices;
+		opengl_command_buffer::vertices_t iOutlineVertices;
+		boost::optional<opengl_command_buffer::line_stipple> iLineStipple;
+		text_shaper iTextShaper;
 	};
 }
\ No newline at end of file
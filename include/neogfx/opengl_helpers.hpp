@@ -0,0 +1,94 @@
+// opengl_helpers.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "neogfx.hpp"
+#include <GL/glew.h>
+#include <GL/GL.h>
+#include "opengl_error.hpp"
+#include "opengl_state.hpp"
+
+namespace neogfx
+{
+	template <typename T>
+	class opengl_buffer
+	{
+		// types
+	public:
+		typedef T value_type;
+		// construction
+	public:
+		opengl_buffer(std::size_t aCapacity) :
+			iCapacity(aCapacity), iPosition(0), iHandle(0)
+		{
+			glCheck(glGenBuffers(1, &iHandle));
+			opengl_state::current().bind_array_buffer(iHandle);
+			glCheck(glBufferData(GL_ARRAY_BUFFER, iCapacity * sizeof(value_type), nullptr, GL_STREAM_DRAW));
+		}
+		opengl_buffer(const opengl_buffer&) = delete;
+		~opengl_buffer()
+		{
+			glDeleteBuffers(1, &iHandle);
+			opengl_state::buffer_deleted(iHandle);
+		}
+		// operations
+	public:
+		GLuint handle() const
+		{
+			return iHandle;
+		}
+		std::size_t capacity() const
+		{
+			return iCapacity;
+		}
+		// Streams aCount elements into the buffer (which must be bound to GL_ARRAY_BUFFER) returning the index of the first 
+		// element written. When the ring wraps the buffer storage is orphaned so the driver can hand us fresh memory 
+		// without waiting for draws still using the old contents.
+		std::size_t append(const value_type* aData, std::size_t aCount)
+		{
+			if (aCount > iCapacity)
+			{
+				while (iCapacity < aCount)
+					iCapacity *= 2;
+				orphan();
+			}
+			else if (iPosition + aCount > iCapacity)
+				orphan();
+			std::size_t first = iPosition;
+			void* destination = glCheck(glMapBufferRange(GL_ARRAY_BUFFER, first * sizeof(value_type), aCount * sizeof(value_type), 
+				GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+			std::copy(aData, aData + aCount, static_cast<value_type*>(destination));
+			glCheck(glUnmapBuffer(GL_ARRAY_BUFFER));
+			iPosition += aCount;
+			return first;
+		}
+	private:
+		void orphan()
+		{
+			glCheck(glBufferData(GL_ARRAY_BUFFER, iCapacity * sizeof(value_type), nullptr, GL_STREAM_DRAW));
+			iPosition = 0;
+		}
+		// attributes
+	private:
+		std::size_t iCapacity;
+		std::size_t iPosition;
+		GLuint iHandle;
+	};
+}
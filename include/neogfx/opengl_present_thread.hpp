@@ -0,0 +1,99 @@
+// opengl_present_thread.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include "neogfx.hpp"
+#include <array>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <GL/glew.h>
+#include <GL/GL.h>
+#include "geometry.hpp"
+
+namespace neogfx
+{
+	// Presents frames rendered on the GUI thread from a thread of its own so that a present that blocks (vertical sync,
+	// a stalling driver) does not hold up event processing. The GUI thread copies each finished frame into one of two
+	// textures and submits it; the presenting thread owns a second OpenGL context (sharing objects with the GUI one)
+	// with which it copies the damaged area of the frame to the window and presents it. If a submitted frame has not
+	// been picked up by the time the next one is ready it is replaced, its damaged area carried over, rather than
+	// waited for.
+	class opengl_present_thread
+	{
+		// types
+	public:
+		typedef std::function<void(void*)> make_current_function;
+		typedef std::function<void(const size&, const std::vector<rect>&)> display_function;
+	private:
+		enum class slot_state
+		{
+			Free,
+			Writing,
+			Pending,
+			Presenting
+		};
+		struct slot
+		{
+			slot_state state;
+			GLuint texture;
+			size textureExtents;
+			size frameExtents;
+			GLsync fence;
+			region damage;
+		};
+		// constants
+	public:
+		static const std::size_t MaxDamagedRects = 8;
+		// construction
+	public:
+		opengl_present_thread(void* aContext, make_current_function aMakeCurrent, display_function aDisplay);
+		~opengl_present_thread();
+		opengl_present_thread(const opengl_present_thread&) = delete;
+		// operations
+	public:
+		void submit(GLuint aFrameBuffer, const size& aExtents, const std::vector<rect>& aDamagedRects);
+		// attributes
+	public:
+		uint64_t frames_presented() const;
+		uint64_t frames_replaced() const;
+		// implementation
+	private:
+		void run();
+		void present(slot& aSlot, const std::vector<rect>& aDamagedRects, GLuint aReadFrameBuffer);
+	private:
+		void* iContext;
+		make_current_function iMakeCurrent;
+		display_function iDisplay;
+		mutable std::mutex iMutex;
+		std::condition_variable iCondition;
+		std::array<slot, 2> iSlots;
+		GLuint iCopyFrameBuffer;
+		uint64_t iFramesPresented;
+		uint64_t iFramesReplaced;
+		std::exception_ptr iError;
+		bool iStop;
+		std::thread iThread;
+	};
+}
@@ -28,12 +28,18 @@
 #include "i_rendering_engine.hpp"
 #include "font_manager.hpp"
 #include "opengl_texture_manager.hpp"
+#include "opengl_helpers.hpp"
+#include "tessellation_cache.hpp"
+#include "opengl_gradient_cache.hpp"
+#include "opengl_state.hpp"
 
 std::string glErrorString(GLenum aErrorCode);
 GLenum glCheckError(const char* file, unsigned int line);
 
 namespace neogfx
 {
+	class opengl_command_buffer;
+
 	namespace detail
 	{
 		class screen_metrics : public i_screen_metrics
@@ -66,29 +72,65 @@ namespace neogfx
 		{
 		public:
 			typedef std::map<std::string, GLuint> variable_map;
+			typedef std::map<std::string, uniform_id> uniform_map;
+			typedef std::vector<GLint> uniform_location_list;
 		public:
 			shader_program(GLuint aHandle);
 		public:
 			virtual void* handle() const;
 			virtual void* variable(const std::string& aVariableName) const;
+			virtual uniform_id uniform(const std::string& aName) const;
 			virtual void set_uniform_variable(const std::string& aName, double aValue);
 			virtual void set_uniform_variable(const std::string& aName, int aValue);
 			virtual void set_uniform_variable(const std::string& aName, double aValue1, double aValue2);
+			virtual void set_uniform_matrix(const std::string& aName, const matrix44& aMatrix);
+			virtual void set_uniform_variable(uniform_id aUniform, double aValue);
+			virtual void set_uniform_variable(uniform_id aUniform, int aValue);
+			virtual void set_uniform_variable(uniform_id aUniform, double aValue1, double aValue2);
+			virtual void set_uniform_matrix(uniform_id aUniform, const matrix44& aMatrix);
 		public:
 			GLuint register_variable(const std::string& aVariableName);
+			void resolve_uniforms();
 		public:
 			bool operator<(const shader_program& aRhs) const;
-		private:
-			GLint uniform_location(const std::string& aName);
 		private:
 			GLuint iHandle;
 			variable_map iVariables;
+			uniform_map iUniforms;
+			uniform_location_list iUniformLocations;
+		};
+		struct default_shader_uniforms
+		{
+			shader_program::uniform_id projection;
+			shader_program::uniform_id mode;
+			shader_program::uniform_id antiAlias;
+		};
+		struct default_shader_attributes
+		{
+			GLuint shapeRect;
+			GLuint shapeColor;
+			GLuint shapeParameters;
 		};
+		struct vertex
+		{
+			std::array<GLfloat, 2> xy;
+			std::array<uint8_t, 4> rgba;
+			std::array<GLfloat, 2> st;
+		};
+		typedef opengl_buffer<vertex> vertex_buffer_type;
+		struct shape
+		{
+			std::array<GLfloat, 4> rect; // centre and half extents
+			std::array<uint8_t, 4> rgba;
+			std::array<GLfloat, 2> parameters; // corner radius and outline width
+		};
+		typedef opengl_buffer<shape> shape_buffer_type;
 	private:
 		typedef std::vector<std::pair<std::string, GLenum>> shaders;
 		typedef std::list<shader_program> shader_programs;
 	public:
 		opengl_renderer();
+		~opengl_renderer();
 	public:
 		virtual void initialize();
 		virtual const i_screen_metrics& screen_metrics() const;
@@ -98,10 +140,26 @@ namespace neogfx
 		virtual void deactivate_shader_program();
 		virtual const i_shader_program& active_shader_program() const;
 		virtual i_shader_program& active_shader_program();
-		virtual const i_shader_program& monochrome_shader_program() const;
-		virtual i_shader_program& monochrome_shader_program();
-		virtual const i_shader_program& subpixel_shader_program() const;
-		virtual i_shader_program& subpixel_shader_program();
+		virtual const i_shader_program& default_shader_program() const;
+		virtual i_shader_program& default_shader_program();
+		virtual const rendering_statistics& statistics() const;
+	public:
+		vertex_buffer_type& vertex_buffer();
+		GLuint vertex_array();
+		shape_buffer_type& shape_buffer();
+		GLuint shape_vertex_array();
+		void set_shape_attributes(std::size_t aFirst);
+		GLuint copy_frame_buffer();
+		const default_shader_uniforms& default_shader_program_uniforms() const;
+		const default_shader_attributes& default_shader_program_attributes() const;
+		opengl_state& state();
+		void context_activated(void* aContext);
+		void context_destroyed(void* aContext);
+		neogfx::tessellation_cache& tessellation_cache();
+		opengl_gradient_cache& gradient_cache();
+		std::unique_ptr<opengl_command_buffer> allocate_command_buffer();
+		void free_command_buffer(std::unique_ptr<opengl_command_buffer> aCommandBuffer);
+		void frame_rendered(const rendering_statistics& aStatistics);
 	private:
 		shader_programs::iterator create_shader_program(const shaders& aShaders, const std::vector<std::string>& aVariables);
 	private:
@@ -110,7 +168,19 @@ namespace neogfx
 		opengl_texture_manager iTextureManager;
 		shader_programs iShaderPrograms;
 		shader_programs::iterator iActiveProgram;
-		shader_programs::iterator iMonochromeProgram;
-		shader_programs::iterator iSubpixelProgram;
+		shader_programs::iterator iDefaultProgram;
+		default_shader_uniforms iDefaultProgramUniforms;
+		default_shader_attributes iDefaultProgramAttributes;
+		std::unique_ptr<vertex_buffer_type> iVertexBuffer;
+		std::map<void*, GLuint> iVertexArrays;
+		std::unique_ptr<shape_buffer_type> iShapeBuffer;
+		std::map<void*, GLuint> iShapeVertexArrays;
+		std::map<void*, GLuint> iCopyFrameBuffers;
+		neogfx::tessellation_cache iTessellationCache;
+		std::map<void*, std::unique_ptr<opengl_gradient_cache>> iGradientCaches;
+		std::vector<std::unique_ptr<opengl_command_buffer>> iCommandBufferPool;
+		std::map<void*, std::unique_ptr<opengl_state>> iContextStates;
+		void* iActiveContext;
+		rendering_statistics iStatistics;
 	};
 }
\ No newline at end of file
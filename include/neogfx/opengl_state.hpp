@@ -0,0 +1,112 @@
+// opengl_state.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "neogfx.hpp"
+#include <map>
+#include <set>
+#include <tuple>
+#include <array>
+#include <boost/optional.hpp>
+#include <GL/glew.h>
+#include <GL/GL.h>
+#include "i_rendering_engine.hpp"
+
+namespace neogfx
+{
+	// Shadows the OpenGL state of one context so that redundant state changes are skipped and nothing needs to be
+	// queried with glGet* in order to restore it later. All code that changes tracked state must go through the
+	// tracker of the context it is using (see current()); invalidate() forgets the shadowed values if that is not
+	// possible. Trackers are owned by the renderer, one per context.
+	class opengl_state
+	{
+		// constants
+	public:
+		static const std::size_t TextureUnits = 8;
+		// construction
+	public:
+		opengl_state();
+		~opengl_state();
+		opengl_state(const opengl_state&) = delete;
+		// operations
+	public:
+		static opengl_state& current();
+		static void set_current(opengl_state* aState);
+		static void texture_deleted(GLuint aTexture);
+		static void buffer_deleted(GLuint aBuffer);
+		static void vertex_array_deleted(GLuint aVertexArray);
+		static void frame_buffer_deleted(GLuint aFrameBuffer);
+		void invalidate();
+		void active_texture(GLenum aUnit);
+		void bind_texture(GLuint aTexture);
+		void bind_texture(GLenum aUnit, GLuint aTexture);
+		void bind_vertex_array(GLuint aVertexArray);
+		void bind_array_buffer(GLuint aBuffer);
+		void use_program(GLuint aProgram);
+		void bind_frame_buffer(GLenum aTarget, GLuint aFrameBuffer);
+		GLuint read_frame_buffer() const;
+		GLuint draw_frame_buffer() const;
+		void enable(GLenum aCapability);
+		void disable(GLenum aCapability);
+		void set_capability(GLenum aCapability, bool aEnable);
+		void blend_func(GLenum aSourceFactor, GLenum aDestinationFactor);
+		void scissor(GLint aX, GLint aY, GLsizei aWidth, GLsizei aHeight);
+		void stencil_func(GLenum aFunc, GLint aRef, GLuint aMask);
+		void stencil_op(GLenum aStencilFail, GLenum aDepthFail, GLenum aDepthPass);
+		void stencil_mask(GLuint aMask);
+		void colour_mask(bool aWrite);
+		void depth_mask(bool aWrite);
+		void logic_op(GLenum aOperation);
+		// attributes
+	public:
+		uint64_t state_changes() const;
+		uint64_t redundant_state_changes() const;
+		const rendering_statistics& counters() const;
+		rendering_statistics& counters();
+		void reset_counters();
+		// implementation
+	private:
+		template <typename T>
+		bool change(boost::optional<T>& aShadow, const T& aValue);
+		// attributes
+	private:
+		boost::optional<GLenum> iActiveTexture;
+		std::array<boost::optional<GLuint>, TextureUnits> iTextures;
+		boost::optional<GLuint> iVertexArray;
+		boost::optional<GLuint> iArrayBuffer;
+		boost::optional<GLuint> iProgram;
+		boost::optional<GLuint> iReadFrameBuffer;
+		boost::optional<GLuint> iDrawFrameBuffer;
+		std::map<GLenum, bool> iCapabilities;
+		boost::optional<std::pair<GLenum, GLenum>> iBlendFunc;
+		boost::optional<std::tuple<GLint, GLint, GLsizei, GLsizei>> iScissor;
+		boost::optional<std::tuple<GLenum, GLint, GLuint>> iStencilFunc;
+		boost::optional<std::tuple<GLenum, GLenum, GLenum>> iStencilOp;
+		boost::optional<GLuint> iStencilMask;
+		boost::optional<bool> iColourMask;
+		boost::optional<bool> iDepthMask;
+		boost::optional<GLenum> iLogicOp;
+		uint64_t iStateChanges;
+		uint64_t iRedundantStateChanges;
+		rendering_statistics iCounters;
+		static std::set<opengl_state*> sInstances;
+		static opengl_state* sCurrent;
+	};
+}
@@ -33,6 +33,7 @@ namespace neogfx
 	public:
 		struct unsupported_colour_format : std::runtime_error { unsupported_colour_format() : std::runtime_error("neogfx::opengl_texture::unsupported_colour_format") {} };
 	public:
+		opengl_texture(const size& aExtents);
 		opengl_texture(const i_image& aImage);
 		~opengl_texture();
 	public:
@@ -41,11 +42,19 @@ namespace neogfx
 	public:
 		virtual void* handle() const;
 		virtual bool is_resident() const;
+		virtual bool is_evictable() const;
+		virtual std::size_t memory_size() const;
+		virtual void make_resident();
+		virtual void evict();
 		virtual const std::string& uri() const;
+	public:
+		virtual const void* data() const;
+		virtual void update(const rect& aRect, const void* aPixels);
 	private:
 		basic_size<uint32_t> iSize;
 		basic_size<uint32_t> iStorageSize;
 		GLuint iHandle;
 		std::string iUri;
+		std::vector<uint8_t> iData;
 	};
 }
\ No newline at end of file
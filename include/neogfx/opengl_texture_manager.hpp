@@ -27,6 +27,8 @@ namespace neogfx
 	class opengl_texture_manager : public texture_manager
 	{
 	public:
+		virtual std::unique_ptr<i_native_texture> create_texture(const size& aExtents);
 		virtual std::unique_ptr<i_native_texture> create_texture(const i_image& aImage);
+		virtual std::unique_ptr<i_font_texture> create_font_texture(const size& aExtents, bool aSubPixelRendering);
 	};
 }
\ No newline at end of file
@@ -20,7 +20,7 @@
 #pragma once
 
 #include "neogfx.hpp"
-#include <unordered_set>
+#include <vector>
 #include <boost/lexical_cast.hpp>
 #include <neolib/string_utils.hpp>
 #include "neogfx.hpp"
@@ -28,6 +28,8 @@
 #include <GL/GL.h>
 #include <neolib/timer.hpp>
 #include "opengl_error.hpp"
+#include "frame_scheduler.hpp"
+#include "opengl_present_thread.hpp"
 #include "native_window.hpp"
 #include "i_native_window_event_handler.hpp"
 #include "i_native_graphics_context.hpp"
@@ -41,6 +43,9 @@ namespace neogfx
 			failed_to_create_framebuffer(GLenum aErrorCode) : 
 				std::runtime_error("neogfx::opengl_window::failed_to_create_framebuffer: Failed to create frame buffer, reason: " + glErrorString(aErrorCode)) {} };
 		struct busy_rendering : std::logic_error { busy_rendering() : std::logic_error("neogfx::opengl_window::busy_rendering") {} };
+		struct unsupported_colour_format : std::logic_error { unsupported_colour_format() : std::logic_error("neogfx::opengl_window::unsupported_colour_format") {} };
+	public:
+		static const std::size_t MaxInvalidatedRects = 8;
 	public:
 		opengl_window(i_rendering_engine& aRenderingEngine, i_surface_manager& aSurfaceManager, i_native_window_event_handler& aEventHandler);
 		~opengl_window();
@@ -53,10 +58,17 @@ namespace neogfx
 		virtual uint64_t frame_counter() const;
 		virtual bool using_frame_buffer() const;
 		virtual void limit_frame_rate(uint32_t aFps);
+		virtual neogfx::frame_pacing frame_pacing() const;
+		virtual void set_frame_pacing(neogfx::frame_pacing aPacing);
+		virtual neogfx::frame_statistics frame_statistics() const;
+		virtual boost::optional<frame_scheduler::time_point> next_frame_time() const;
+		virtual bool threaded_presentation() const;
+		virtual void set_threaded_presentation(bool aThreadedPresentation);
 	public:
 		virtual void invalidate(const rect& aInvalidatedRect);
 		virtual void render();
 		virtual bool is_rendering() const;
+		virtual void read_pixels(i_image& aImage) const;
 	public:
 		virtual size extents() const;
 		virtual dimension horizontal_dpi() const;
@@ -66,8 +78,18 @@ namespace neogfx
 		i_native_window_event_handler& event_handler() const;
 		virtual void destroying();
 		virtual void destroyed();
+		void stop_present_thread();
+	private:
+		bool begin_gpu_timer();
+		void end_gpu_timer(bool aStarted);
+		void publish_statistics();
 	private:
-		virtual void display() = 0;
+		virtual bool partial_present() const = 0;
+		virtual void display(const size& aFrameExtents, const std::vector<rect>& aDamagedRects) = 0;
+		virtual boost::optional<uint32_t> vertical_sync_rate() const = 0;
+		virtual void* create_presentation_context() = 0;
+		virtual void make_presentation_context_current(void* aContext) = 0;
+		virtual void destroy_presentation_context(void* aContext) = 0;
 		virtual bool processing_event() const = 0;
 	private:
 		i_native_window_event_handler& iEventHandler;
@@ -78,10 +100,16 @@ namespace neogfx
 		GLuint iFrameBufferTexture;
 		GLuint iDepthStencilBuffer;
 		size iFrameBufferSize;
-		std::unordered_set<rect> iInvalidatedRects;
+		GLuint iGpuTimer;
+		bool iGpuTimerPending;
+		boost::optional<double> iGpuTime;
+		region iInvalidatedRegion;
+		size iPresentedExtents;
 		uint64_t iFrameCounter;
-		boost::optional<uint32_t> iFrameRate;
-		uint64_t iLastFrameTime;
+		frame_scheduler iFrameScheduler;
+		bool iThreadedPresentation;
+		void* iPresentationContext;
+		std::unique_ptr<opengl_present_thread> iPresentThread;
 		bool iRendering;
 	};
 }
\ No newline at end of file
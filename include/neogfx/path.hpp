@@ -21,6 +21,7 @@
 
 #include "neogfx.hpp"
 #include "primitives.hpp"
+#include "triangulation.hpp"
 
 namespace neogfx
 {
@@ -51,6 +52,7 @@ namespace neogfx
 		typedef std::vector<point_type> path_type;
 		typedef std::vector<path_type> paths_type;
 		typedef typename paths_type::size_type paths_size_type;
+		typedef basic_triangulation<point_type> triangulation_type;
 		struct clip_rect_list : std::vector < rect_type >
 		{
 			bool contains(const point_type& aPoint) const
@@ -84,11 +86,11 @@ namespace neogfx
 		typedef std::vector<intersect> intersect_list;
 		// construction
 	public:
-		basic_path(shape_type_e aShape = ConvexPolygon, paths_size_type aPathCountHint = 0) : iShape(aShape)
+		basic_path(shape_type_e aShape = ConvexPolygon, paths_size_type aPathCountHint = 0) : iShape(aShape), iFillRule(FillRuleNonZero)
 		{
 			iPaths.reserve(aPathCountHint);
 		}
-		basic_path(const rect_type& aRect, shape_type_e aShape = ConvexPolygon) : iShape(aShape)
+		basic_path(const rect_type& aRect, shape_type_e aShape = ConvexPolygon) : iShape(aShape), iFillRule(FillRuleNonZero)
 		{
 			iPaths.reserve(5);
 			move_to(aRect.top_left());
@@ -122,8 +124,44 @@ namespace neogfx
 		}
 		paths_type& paths() 
 		{ 
+			iTriangulation.reset();
 			return iPaths; 
 		}
+		fill_rule_e fill_rule() const
+		{
+			return iFillRule;
+		}
+		void set_fill_rule(fill_rule_e aFillRule)
+		{
+			if (iFillRule != aFillRule)
+			{
+				iFillRule = aFillRule;
+				iTriangulation.reset();
+			}
+		}
+		// Triangles covering the path's fill area (relative to position()), computed on first use and cached until the path changes.
+		const triangulation_type& triangulation() const
+		{
+			if (!iTriangulation)
+			{
+				iTriangulation = triangulation_type{};
+				triangulate(iPaths, iFillRule, *iTriangulation);
+			}
+			return *iTriangulation;
+		}
+		// Applies aFunction to every point; any cached triangulation is transformed rather than discarded so aFunction 
+		// must preserve orientation (e.g. translation or positive scaling).
+		template <typename Function>
+		void map_points(Function aFunction)
+		{
+			for (auto& p : iPaths)
+				for (auto& v : p)
+					v = aFunction(v);
+			if (iTriangulation)
+				for (auto& v : iTriangulation->vertices)
+					v = aFunction(v);
+			iBoundingRect.reset();
+		}
 		std::vector<coordinate_type> to_vertices(const typename paths_type::value_type& aPath, coordinate_type aPixelAdjust = 0.0) const
 		{
 			std::vector<coordinate_type> result;
@@ -201,6 +239,7 @@ namespace neogfx
 			}
 			iPaths.back().push_back(aPoint);
 			iBoundingRect.reset();
+			iTriangulation.reset();
 		}
 		void line_to(coordinate_type aX, coordinate_type aY)
 		{
@@ -223,6 +262,7 @@ namespace neogfx
 						j->y += aDelta.dy;
 				}
 			iBoundingRect.reset();
+			iTriangulation.reset();
 		}
 		void inflate(coordinate_delta_type aDeltaX, coordinate_delta_type aDeltaY)
 		{
@@ -246,6 +286,8 @@ namespace neogfx
 		paths_type iPaths;
 		paths_size_type iLineCountHint;
 		mutable boost::optional<rect_type> iBoundingRect;
+		fill_rule_e iFillRule;
+		mutable boost::optional<triangulation_type> iTriangulation;
 	};
 }
 
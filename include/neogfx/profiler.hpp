@@ -0,0 +1,140 @@
+// profiler.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "neogfx.hpp"
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace neogfx
+{
+	class i_widget;
+
+	// Records how long widgets take to render, paint and lay out (and which work caused them to be updated) into a
+	// fixed size ring of samples that the instrumented code writes to without taking a lock. When disabled an 
+	// instrumentation point costs one relaxed atomic load. Widgets are identified by address and dynamic type only so 
+	// samples remain valid after the widgets they describe are destroyed.
+	class profiler
+	{
+	public:
+		static const std::size_t DefaultCapacity = 65536;
+	public:
+		enum event_type_e : uint32_t
+		{
+			External,	// no instrumented work in progress, e.g. an input event or timer
+			Frame,
+			Render,
+			Paint,
+			Layout,
+			Update
+		};
+		struct sample
+		{
+			event_type_e type;
+			const i_widget* widget;
+			const char* widgetType;
+			// the innermost event in progress on the same thread when this one started (the cause of an update)
+			event_type_e sourceType;
+			const i_widget* source;
+			const char* sourceWidgetType;
+			uint64_t start;		// nanoseconds since the profiler was enabled
+			uint64_t duration;	// nanoseconds, zero for updates
+			uint32_t thread;
+		};
+		typedef std::vector<sample> sample_list;
+		struct widget_statistics
+		{
+			const i_widget* widget;
+			const char* widgetType;
+			uint64_t renderCount;
+			double renderTime;	// milliseconds, including children
+			uint64_t paintCount;
+			double paintTime;	// milliseconds
+			uint64_t layoutCount;
+			double layoutTime;	// milliseconds
+			uint64_t updateCount;
+			std::map<std::string, uint64_t> updateSources;
+		};
+		typedef std::vector<widget_statistics> widget_statistics_list;
+		class scope
+		{
+		public:
+			scope(event_type_e aType, const i_widget* aWidget = nullptr) : iProfiler(profiler::active())
+			{
+				if (iProfiler != nullptr)
+					iProfiler->begin(*this, aType, aWidget);
+			}
+			~scope()
+			{
+				if (iProfiler != nullptr)
+					iProfiler->end(*this);
+			}
+		private:
+			friend class profiler;
+			profiler* iProfiler;
+			event_type_e iType;
+			const i_widget* iWidget;
+			const scope* iParent;
+			uint64_t iStart;
+		};
+	private:
+		struct record;
+		typedef std::chrono::steady_clock clock;
+	public:
+		profiler();
+		~profiler();
+	public:
+		static profiler* active()
+		{
+			return sActive.load(std::memory_order_relaxed);
+		}
+		static void record_update(const i_widget& aWidget)
+		{
+			profiler* p = active();
+			if (p != nullptr)
+				p->update(aWidget);
+		}
+	public:
+		bool enabled() const;
+		void enable(std::size_t aCapacity = DefaultCapacity);
+		void disable();
+		void clear();
+		sample_list samples() const;
+		widget_statistics_list statistics() const;
+		void export_chrome_trace(std::ostream& aOutput) const;
+	private:
+		void begin(scope& aScope, event_type_e aType, const i_widget* aWidget);
+		void end(const scope& aScope);
+		void update(const i_widget& aWidget);
+		void write(const sample& aSample);
+		uint64_t now() const;
+	private:
+		static std::atomic<profiler*> sActive;
+		std::unique_ptr<record[]> iRecords;
+		std::size_t iCapacity;
+		std::atomic<uint64_t> iNext;
+		clock::time_point iEpoch;
+	};
+}
@@ -0,0 +1,60 @@
+// rendering_statistics_overlay.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include "neogfx.hpp"
+#include <neolib/timer.hpp>
+#include "widget.hpp"
+#include "i_rendering_engine.hpp"
+
+namespace neogfx
+{
+	// Shows the statistics of the most recently rendered frame (see i_rendering_engine::statistics()). The overlay 
+	// only refreshes (at most once per refresh interval) after a frame it did not cause itself so that it neither keeps 
+	// an on demand window rendering nor reports the cost of drawing itself.
+	class rendering_statistics_overlay : public widget
+	{
+	public:
+		static const uint32_t DefaultRefreshInterval = 500;
+	public:
+		rendering_statistics_overlay(uint32_t aRefreshInterval = DefaultRefreshInterval);
+		rendering_statistics_overlay(i_widget& aParent, uint32_t aRefreshInterval = DefaultRefreshInterval);
+		rendering_statistics_overlay(i_layout& aLayout, uint32_t aRefreshInterval = DefaultRefreshInterval);
+		~rendering_statistics_overlay();
+	public:
+		virtual neogfx::size_policy size_policy() const;
+		virtual size minimum_size(const optional_size& aAvailableSpace = optional_size()) const;
+	public:
+		virtual void paint(graphics_context& aGraphicsContext) const;
+	protected:
+		virtual void parent_changed();
+	private:
+		void init();
+		void subscribe();
+		void frame_finished();
+		std::string text() const;
+	private:
+		neolib::callback_timer iUpdater;
+		bool iRefreshDue;
+		bool iOwnFrame;
+		rendering_statistics iStatistics;
+	};
+}
@@ -22,6 +22,7 @@
 #include "neogfx.hpp"
 #include "framed_widget.hpp"
 #include "scrollbar.hpp"
+#include "texture.hpp"
 
 namespace neogfx
 {
@@ -57,6 +58,7 @@ namespace neogfx
 		virtual void resized();
 		virtual rect client_rect(bool aIncludeMargins = true) const;
 	public:
+		virtual void render(graphics_context& aGraphicsContext) const;
 		virtual void paint_non_client(graphics_context& aGraphicsContext) const;
 	public:
 		virtual void mouse_wheel_scrolled(mouse_wheel aWheel, delta aDelta);
@@ -86,10 +88,14 @@ namespace neogfx
 	protected:
 		void init();
 	private:
+		bool scroll_by_copy(const point& aDelta);
+	private:
 		scrollbar iVerticalScrollbar;
 		scrollbar iHorizontalScrollbar;
 		point iOldScrollPosition;
 		std::pair<i_scrollbar::value_type, i_scrollbar::value_type> iOldScrollbarValues;
 		uint32_t iIgnoreScrollbarUpdates;
+		mutable point iPendingScroll;
+		mutable optional_texture iScrollBuffer;
 	};
 }
\ No newline at end of file
@@ -48,6 +48,7 @@ namespace neogfx
 		virtual void render_now();
 	public:
 		virtual bool process_events();
+		virtual void wait_for_events(frame_scheduler::duration aTimeout);
 	private:
 		i_basic_services& iBasicServices;
 		i_keyboard& iKeyboard;
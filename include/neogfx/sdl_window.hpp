@@ -113,7 +113,12 @@ namespace neogfx
 		static LRESULT CALLBACK CustomWindowProc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam);
 #endif
 	private:
-		virtual void display();
+		virtual bool partial_present() const;
+		virtual void display(const size& aFrameExtents, const std::vector<rect>& aDamagedRects);
+		virtual boost::optional<uint32_t> vertical_sync_rate() const;
+		virtual void* create_presentation_context();
+		virtual void make_presentation_context_current(void* aContext);
+		virtual void destroy_presentation_context(void* aContext);
 		virtual bool processing_event() const;
 	private:
 		sdl_window* iParent;
@@ -131,5 +136,6 @@ namespace neogfx
 		std::vector<cursor_pointer> iSavedCursors;
 		bool iDestroyed;
 		std::deque<key_modifiers_e> iMouseButtonEventExtraInfo;
+		mutable boost::optional<bool> iPartialPresent;
 	};
 }
\ No newline at end of file
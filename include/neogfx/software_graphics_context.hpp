@@ -0,0 +1,162 @@
+// software_graphics_context.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "neogfx.hpp"
+#include "software_renderer.hpp"
+#include "software_rasterizer.hpp"
+#include "text_shaper.hpp"
+#include "i_native_graphics_context.hpp"
+
+namespace neogfx
+{
+	class i_rendering_engine;
+	class i_image;
+	class i_glyph_texture;
+	class software_window;
+
+	class software_graphics_context : public i_native_graphics_context
+	{
+	private:
+		class scoped_anti_alias
+		{
+		public:
+			scoped_anti_alias(software_graphics_context& aParent, smoothing_mode_e aNewSmoothingMode) : iParent(aParent), iOldSmoothingMode(aParent.smoothing_mode())
+			{
+				iParent.set_smoothing_mode(aNewSmoothingMode);
+			}
+			~scoped_anti_alias()
+			{
+				iParent.set_smoothing_mode(iOldSmoothingMode);
+			}
+		private:
+			software_graphics_context& iParent;
+			smoothing_mode_e iOldSmoothingMode;
+		};
+		class disable_anti_alias : public scoped_anti_alias
+		{
+		public:
+			disable_anti_alias(software_graphics_context& aParent) : scoped_anti_alias(aParent, SmoothingModeNone)
+			{
+			}
+		};
+	public:
+		software_graphics_context(i_rendering_engine& aRenderingEngine, const software_window& aSurface);
+		software_graphics_context(i_rendering_engine& aRenderingEngine, const software_window& aSurface, const i_widget& aWidget);
+		software_graphics_context(const software_graphics_context& aOther);
+		~software_graphics_context();
+	public:
+		virtual std::unique_ptr<i_native_graphics_context> clone() const;
+	public:
+		virtual const i_native_surface& surface() const;
+		rect rendering_area(bool aConsiderScissor = true) const;
+	public:
+		virtual neogfx::logical_coordinate_system logical_coordinate_system() const;
+		virtual void set_logical_coordinate_system(neogfx::logical_coordinate_system aSystem);
+		virtual const vector4& logical_coordinates() const;
+		virtual void set_logical_coordinates(const vector4& aCoordinates) const;
+		virtual void flush();
+		virtual void begin_recording();
+		virtual void end_recording();
+		virtual void scissor_on(const rect& aRect);
+		virtual void scissor_off();
+		virtual optional_rect scissor_rect() const;
+		virtual void clip_to(const rect& aRect);
+		virtual void clip_to(const path& aPath, dimension aPathOutline);
+		virtual void reset_clip();
+		virtual smoothing_mode_e smoothing_mode() const;
+		virtual smoothing_mode_e set_smoothing_mode(smoothing_mode_e aSmoothingMode);
+		virtual bool monochrome() const;
+		virtual void set_monochrome(bool aMonochrome);
+		virtual void push_logical_operation(logical_operation_e aLogicalOperation);
+		virtual void pop_logical_operation();
+		virtual void line_stipple_on(uint32_t aFactor, uint16_t aPattern);
+		virtual void line_stipple_off();
+		virtual void clear(const colour& aColour);
+		virtual void set_pixel(const point& aPoint, const colour& aColour);
+		virtual void draw_pixel(const point& aPoint, const colour& aColour);
+		virtual void draw_line(const point& aFrom, const point& aTo, const pen& aPen);
+		virtual void draw_rect(const rect& aRect, const pen& aPen);
+		virtual void draw_rounded_rect(const rect& aRect, dimension aRadius, const pen& aPen);
+		virtual void draw_circle(const point& aCentre, dimension aRadius, const pen& aPen);
+		virtual void draw_arc(const point& aCentre, dimension aRadius, angle aStartAngle, angle aEndAngle, const pen& aPen);
+		virtual void draw_path(const path& aPath, const pen& aPen);
+		virtual void fill_rect(const rect& aRect, const colour& aColour);
+		virtual void fill_rect(const rect& aRect, const gradient& aGradient);
+		virtual void fill_rounded_rect(const rect& aRect, dimension aRadius, const colour& aColour);
+		virtual void fill_rounded_rect(const rect& aRect, dimension aRadius, const gradient& aGradient);
+		virtual void fill_circle(const point& aCentre, dimension aRadius, const colour& aColour);
+		virtual void fill_arc(const point& aCentre, dimension aRadius, angle aStartAngle, angle aEndAngle, const colour& aColour);
+		virtual void fill_shape(const point& aCentre, const vertex_list2& aVertices, const colour& aColour);
+		virtual void fill_and_draw_path(const path& aPath, const colour& aFillColour, const pen& aPen);
+		virtual glyph_text to_glyph_text(string::const_iterator aTextBegin, string::const_iterator aTextEnd, const font& aFont) const;
+		virtual glyph_text to_glyph_text(string::const_iterator aTextBegin, string::const_iterator aTextEnd, std::function<font(std::string::size_type)> aFontSelector) const;
+		virtual void set_mnemonic(bool aShowMnemonics, char aMnemonicPrefix = '&');
+		virtual void unset_mnemonic();
+		virtual bool mnemonics_shown() const;
+		virtual void begin_drawing_glyphs();
+		virtual void draw_glyph(const point& aPoint, const glyph& aGlyph, const font& aFont, const colour& aColour);
+		virtual void draw_glyph_run(const glyph_run& aRun);
+		virtual void end_drawing_glyphs();
+		virtual void draw_texture(const texture_map& aTextureMap, const i_texture& aTexture, const rect& aTextureRect, const optional_colour& aColour);
+		virtual void copy_to_texture(const rect& aSourceRect, const i_texture& aTexture);
+		virtual void copy_from_texture(const i_texture& aTexture, const rect& aDestinationRect);
+	private:
+		i_image& target() const;
+		software_renderer& rendering_engine() const;
+		bool analytic_anti_alias() const;
+		point to_device(const point& aPoint) const;
+		software_rasterizer::area to_device(const rect& aRect) const;
+		dimension to_device(dimension aLength) const;
+		software_rasterizer::state render_state(bool aAntiAlias) const;
+		software_rasterizer::paint solid(const colour& aColour) const;
+		void update_scissor();
+		void add_edges(software_rasterizer::edge_list& aEdges, const std::vector<point>& aPolygon) const;
+		void add_stroke_edges(software_rasterizer::edge_list& aEdges, const point& aFrom, const point& aTo, dimension aWidth) const;
+		void stroke(const std::vector<point>& aPoints, bool aClosed, dimension aWidth, const colour& aColour);
+		void fill_polygon(const std::vector<point>& aPolygon, const colour& aColour);
+		void draw_shape(const rect& aShape, dimension aRadius, dimension aOutlineWidth, const software_rasterizer::paint& aPaint);
+		void draw_glyph_mask(const point& aPoint, const i_glyph_texture& aGlyphTexture, const font& aFont, const colour& aColour);
+		void draw_glyph_underline(const point& aPoint, const i_glyph_texture& aGlyphTexture, const font& aFont, const colour& aColour);
+		void commit();
+	private:
+		i_rendering_engine& iRenderingEngine;
+		const software_window& iSurface;
+		neogfx::logical_coordinate_system iSavedCoordinateSystem;
+		neogfx::logical_coordinate_system iLogicalCoordinateSystem;
+		mutable vector4 iLogicalCoordinates;
+		smoothing_mode_e iSmoothingMode;
+		bool iMonochrome;
+		std::vector<logical_operation_e> iLogicalOperationStack;
+		struct clip
+		{
+			optional_rect scissor;
+			software_rasterizer::mask_pointer mask;
+		};
+		std::vector<clip> iClipStack;
+		std::vector<rect> iScissorRects;
+		software_rasterizer::device_rect iScissor;
+		software_rasterizer iRasterizer;
+		uint32_t iRecording;
+		bool iDrawingGlyphs;
+		boost::optional<std::pair<uint32_t, uint16_t>> iLineStipple;
+		text_shaper iTextShaper;
+	};
+}
@@ -0,0 +1,188 @@
+// software_rasterizer.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "neogfx.hpp"
+#include <array>
+#include <vector>
+#include <memory>
+#include "geometry.hpp"
+#include "colour.hpp"
+
+namespace neogfx
+{
+	class i_image;
+	class i_native_texture;
+
+	// Renders a list of commands into an RGBA8 image without the GPU. Commands are binned into tiles and the tiles
+	// are shaded in parallel, each tile executing the commands that touch it in submission order. Coordinates are
+	// device pixels with y running down.
+	class software_rasterizer
+	{
+	public:
+		struct unsupported_colour_format : std::logic_error { unsupported_colour_format() : std::logic_error("neogfx::software_rasterizer::unsupported_colour_format") {} };
+	public:
+		static const int32_t TileSize = 64;
+		static const std::size_t GradientLookupSize = 256;
+	public:
+		typedef std::array<uint8_t, 4> rgba;
+		enum fill_rule_e
+		{
+			NonZero,
+			EvenOdd
+		};
+		enum blend_e
+		{
+			Blend,
+			Xor
+		};
+		struct device_rect
+		{
+			int32_t x0;
+			int32_t y0;
+			int32_t x1;
+			int32_t y1;
+			bool empty() const { return x0 >= x1 || y0 >= y1; }
+			device_rect intersection(const device_rect& aOther) const;
+		};
+		struct area
+		{
+			float x0;
+			float y0;
+			float x1;
+			float y1;
+		};
+		struct edge
+		{
+			float x0;
+			float y0;
+			float x1;
+			float y1;
+		};
+		typedef std::vector<edge> edge_list;
+		struct coverage_mask
+		{
+			device_rect bounds;
+			std::vector<uint8_t> coverage;
+		};
+		typedef std::shared_ptr<const coverage_mask> mask_pointer;
+		// analytic rounded rectangle (a circle when the radius is half the extents), optionally only its outline
+		struct shape
+		{
+			float cx;
+			float cy;
+			float halfWidth;
+			float halfHeight;
+			float radius;
+			float outline;
+		};
+		// one coverage value per pixel, rows running down
+		struct glyph_mask
+		{
+			const std::vector<uint8_t>* coverage;
+			int32_t x;
+			int32_t y;
+			int32_t cx;
+			int32_t cy;
+		};
+		struct gradient_paint
+		{
+			std::array<rgba, GradientLookupSize> lookup;
+			gradient::direction_e direction;
+			// the gradient runs across this box; negative half extents reverse its direction
+			float cx;
+			float cy;
+			float halfWidth;
+			float halfHeight;
+		};
+		// maps device pixel centres to texel coordinates of the texture's storage
+		struct texture_paint
+		{
+			std::shared_ptr<i_native_texture> texture;
+			const uint8_t* texels;
+			int32_t width;
+			int32_t height;
+			float s0;
+			float t0;
+			float dsdx;
+			float dtdx;
+			float dsdy;
+			float dtdy;
+			bool monochrome;
+		};
+		struct paint
+		{
+			rgba colour;
+			std::shared_ptr<const gradient_paint> gradient;
+			std::shared_ptr<const texture_paint> texture;
+		};
+		struct state
+		{
+			device_rect scissor;
+			mask_pointer clip;
+			blend_e blend;
+			bool antiAlias;
+		};
+	private:
+		enum coverage_e
+		{
+			AreaCoverage,
+			PolygonCoverage,
+			ShapeCoverage,
+			GlyphCoverage
+		};
+		struct command
+		{
+			coverage_e coverage;
+			neogfx::software_rasterizer::state state;
+			device_rect bounds;
+			neogfx::software_rasterizer::area area;
+			std::size_t firstEdge;
+			std::size_t edgeCount;
+			fill_rule_e fillRule;
+			neogfx::software_rasterizer::shape shape;
+			glyph_mask glyph;
+			neogfx::software_rasterizer::paint paint;
+		};
+		typedef std::vector<command> command_list;
+		typedef std::vector<std::vector<uint32_t>> bin_list;
+	public:
+		software_rasterizer();
+	public:
+		bool empty() const;
+		std::size_t size() const;
+		void fill_area(const state& aState, const area& aArea, const paint& aPaint);
+		void fill_polygon(const state& aState, const edge_list& aEdges, fill_rule_e aFillRule, const paint& aPaint);
+		void fill_shape(const state& aState, const shape& aShape, const paint& aPaint);
+		void fill_glyph(const state& aState, const glyph_mask& aGlyph, const paint& aPaint);
+		void execute(i_image& aTarget);
+		void clear();
+	public:
+		static mask_pointer rasterize_mask(const edge_list& aEdges, fill_rule_e aFillRule, bool aAntiAlias, const device_rect& aBounds, const mask_pointer& aEnclosingMask);
+	private:
+		void add(command& aCommand, const device_rect& aBounds);
+		void execute_tile(std::size_t aTile, uint8_t* aPixels, int32_t aWidth, int32_t aHeight) const;
+		void execute_command(const command& aCommand, const device_rect& aRegion, uint8_t* aPixels, int32_t aWidth) const;
+	private:
+		command_list iCommands;
+		edge_list iEdges;
+		bin_list iBins;
+	};
+}
@@ -0,0 +1,92 @@
+// software_renderer.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "neogfx.hpp"
+#include "i_rendering_engine.hpp"
+#include "i_basic_services.hpp"
+#include "keyboard.hpp"
+#include "font_manager.hpp"
+#include "software_texture_manager.hpp"
+#include "tessellation_cache.hpp"
+
+namespace neogfx
+{
+	class i_native_surface;
+
+	// Renders headless windows entirely on the CPU: no OpenGL (or EGL) context is ever created.
+	class software_renderer : public i_rendering_engine
+	{
+	public:
+		struct shaders_not_supported : std::logic_error { shaders_not_supported() : std::logic_error("neogfx::software_renderer::shaders_not_supported") {} };
+	private:
+		class screen_metrics : public i_screen_metrics
+		{
+		public:
+			struct unsupported_function : std::logic_error { unsupported_function() : std::logic_error("neogfx::software_renderer::screen_metrics::unsupported_function") {} };
+		public:
+			virtual dimension horizontal_dpi() const;
+			virtual dimension vertical_dpi() const;
+			virtual size extents() const;
+			virtual dimension em_size() const;
+			virtual subpixel_format_e subpixel_format() const;
+		};
+	public:
+		software_renderer(i_basic_services& aBasicServices, i_keyboard& aKeyboard);
+		~software_renderer();
+	public:
+		virtual void initialize();
+		virtual void* create_context(i_native_surface& aSurface);
+		virtual void destroy_context(i_native_surface& aSurface);
+		virtual const i_screen_metrics& screen_metrics() const;
+		virtual std::unique_ptr<i_native_window> create_window(i_surface_manager& aSurfaceManager, i_native_window_event_handler& aEventHandler, const video_mode& aVideoMode, const std::string& aWindowTitle, window::style_e aStyle);
+		virtual std::unique_ptr<i_native_window> create_window(i_surface_manager& aSurfaceManager, i_native_window_event_handler& aEventHandler, const size& aDimensions, const std::string& aWindowTitle, window::style_e aStyle);
+		virtual std::unique_ptr<i_native_window> create_window(i_surface_manager& aSurfaceManager, i_native_window_event_handler& aEventHandler, const point& aPosition, const size& aDimensions, const std::string& aWindowTitle, window::style_e aStyle);
+		virtual std::unique_ptr<i_native_window> create_window(i_surface_manager& aSurfaceManager, i_native_window_event_handler& aEventHandler, i_native_surface& aParent, const video_mode& aVideoMode, const std::string& aWindowTitle, window::style_e aStyle);
+		virtual std::unique_ptr<i_native_window> create_window(i_surface_manager& aSurfaceManager, i_native_window_event_handler& aEventHandler, i_native_surface& aParent, const size& aDimensions, const std::string& aWindowTitle, window::style_e aStyle);
+		virtual std::unique_ptr<i_native_window> create_window(i_surface_manager& aSurfaceManager, i_native_window_event_handler& aEventHandler, i_native_surface& aParent, const point& aPosition, const size& aDimensions, const std::string& aWindowTitle, window::style_e aStyle);
+		virtual bool creating_window() const;
+		virtual i_font_manager& font_manager();
+		virtual i_texture_manager& texture_manager();
+		virtual void activate_shader_program(i_shader_program& aProgram);
+		virtual void deactivate_shader_program();
+		virtual const i_shader_program& active_shader_program() const;
+		virtual i_shader_program& active_shader_program();
+		virtual const i_shader_program& default_shader_program() const;
+		virtual i_shader_program& default_shader_program();
+		virtual void render_now();
+		virtual const rendering_statistics& statistics() const;
+	public:
+		virtual bool process_events();
+		virtual void wait_for_events(frame_scheduler::duration aTimeout);
+	public:
+		neogfx::tessellation_cache& tessellation_cache();
+		void frame_rendered(const rendering_statistics& aStatistics);
+	private:
+		i_basic_services& iBasicServices;
+		i_keyboard& iKeyboard;
+		screen_metrics iScreenMetrics;
+		neogfx::font_manager iFontManager;
+		software_texture_manager iTextureManager;
+		neogfx::tessellation_cache iTessellationCache;
+		uint32_t iCreatingWindow;
+		rendering_statistics iStatistics;
+	};
+}
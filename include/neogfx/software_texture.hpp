@@ -0,0 +1,78 @@
+// software_texture.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "neogfx.hpp"
+#include <vector>
+#include "geometry.hpp"
+#include "i_native_texture.hpp"
+#include "i_font_texture.hpp"
+#include "i_image.hpp"
+#include "skyline_bin_pack.hpp"
+
+namespace neogfx
+{
+	// A texture that only ever lives in main memory; its pixels are the only copy so it can never be evicted.
+	class software_texture : public i_native_texture
+	{
+	public:
+		struct unsupported_colour_format : std::runtime_error { unsupported_colour_format() : std::runtime_error("neogfx::software_texture::unsupported_colour_format") {} };
+	public:
+		software_texture(const size& aExtents);
+		software_texture(const i_image& aImage);
+		~software_texture();
+	public:
+		virtual size extents() const;
+		virtual size storage_extents() const;
+	public:
+		virtual void* handle() const;
+		virtual bool is_resident() const;
+		virtual bool is_evictable() const;
+		virtual std::size_t memory_size() const;
+		virtual void make_resident();
+		virtual void evict();
+		virtual const std::string& uri() const;
+	public:
+		virtual const void* data() const;
+		virtual void update(const rect& aRect, const void* aPixels);
+	private:
+		basic_size<uint32_t> iSize;
+		basic_size<uint32_t> iStorageSize;
+		std::string iUri;
+		std::vector<uint8_t> iData;
+	};
+
+	// Glyphs are drawn from the coverage each glyph keeps so the atlas only hands out space.
+	class software_font_texture : public i_font_texture
+	{
+	public:
+		software_font_texture(const size& aExtents, bool aSubPixelRendering);
+		~software_font_texture();
+	public:
+		virtual const size& extents() const;
+		virtual bool allocate_glyph_space(const size& aSize, rect& aResult);
+		virtual void* handle() const;
+		virtual void update(const rect& aRect, const void* aPixels);
+	private:
+		size iExtents;
+		bool iSubPixelRendering;
+		skyline_bin_pack iBinPack;
+	};
+}
@@ -0,0 +1,114 @@
+// software_window.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "neogfx.hpp"
+#include "image.hpp"
+#include "frame_scheduler.hpp"
+#include "native_window.hpp"
+#include "i_native_window_event_handler.hpp"
+#include "software_renderer.hpp"
+
+namespace neogfx
+{
+	// A headless window whose widgets are painted by the CPU into a back buffer; the back buffer is the finished frame
+	// (read it with read_pixels) so nothing is presented and no OpenGL context is involved.
+	class software_window : public native_window
+	{
+	public:
+		struct unsupported_colour_format : std::logic_error { unsupported_colour_format() : std::logic_error("neogfx::software_window::unsupported_colour_format") {} };
+	public:
+		static const std::size_t MaxInvalidatedRects = 8;
+	public:
+		software_window(software_renderer& aRenderingEngine, i_surface_manager& aSurfaceManager, i_native_window_event_handler& aEventHandler, const point& aPosition, const size& aDimensions, window::style_e aStyle = window::Default);
+		~software_window();
+	public:
+		virtual neogfx::logical_coordinate_system logical_coordinate_system() const;
+		virtual void set_logical_coordinate_system(neogfx::logical_coordinate_system aSystem);
+		virtual const vector4& logical_coordinates() const;
+		virtual void set_logical_coordinates(const vector4& aCoordinates);
+	public:
+		virtual void* handle() const;
+		virtual void* native_handle() const;
+		virtual void* native_context() const;
+		virtual point surface_position() const;
+		virtual void move_surface(const point& aPosition);
+		virtual size surface_size() const;
+		virtual void resize_surface(const size& aSize);
+		virtual point mouse_position() const;
+		virtual bool is_mouse_button_pressed(mouse_button aButton) const;
+	public:
+		virtual void save_mouse_cursor();
+		virtual void set_mouse_cursor(mouse_system_cursor aSystemCursor);
+		virtual void restore_mouse_cursor();
+	public:
+		virtual uint64_t frame_counter() const;
+		virtual bool using_frame_buffer() const;
+		virtual void limit_frame_rate(uint32_t aFps);
+		virtual neogfx::frame_pacing frame_pacing() const;
+		virtual void set_frame_pacing(neogfx::frame_pacing aPacing);
+		virtual neogfx::frame_statistics frame_statistics() const;
+		virtual boost::optional<frame_scheduler::time_point> next_frame_time() const;
+		virtual bool threaded_presentation() const;
+		virtual void set_threaded_presentation(bool aThreadedPresentation);
+	public:
+		virtual void invalidate(const rect& aInvalidatedRect);
+		virtual void render();
+		virtual bool is_rendering() const;
+		virtual void read_pixels(i_image& aImage) const;
+		virtual std::unique_ptr<i_native_graphics_context> create_graphics_context() const;
+		virtual std::unique_ptr<i_native_graphics_context> create_graphics_context(const i_widget& aWidget) const;
+	public:
+		virtual void activate_context() const;
+		virtual void deactivate_context() const;
+	public:
+		virtual size extents() const;
+		virtual dimension horizontal_dpi() const;
+		virtual dimension vertical_dpi() const;
+		virtual dimension em_size() const;
+	public:
+		virtual void close();
+		virtual void show(bool aActivate = false);
+		virtual void hide();
+		virtual bool is_active() const;
+		virtual void activate();
+		virtual void enable(bool aEnable);
+		virtual void set_capture();
+		virtual void release_capture();
+		virtual bool is_destroyed() const;
+	public:
+		i_image& back_buffer() const;
+	private:
+		software_renderer& iRenderingEngine;
+		i_native_window_event_handler& iEventHandler;
+		neogfx::logical_coordinate_system iLogicalCoordinateSystem;
+		mutable vector4 iLogicalCoordinates;
+		point iPosition;
+		size iExtents;
+		bool iVisible;
+		bool iActive;
+		bool iDestroyed;
+		mutable image iBackBuffer;
+		region iInvalidatedRegion;
+		uint64_t iFrameCounter;
+		frame_scheduler iFrameScheduler;
+		bool iRendering;
+	};
+}
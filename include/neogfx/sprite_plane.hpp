@@ -94,7 +94,11 @@ namespace neogfx
 		buddy_list& buddies();
 	private:
 		bool update_objects();
+		void request_continuous_pacing();
+		void restore_pacing();
 	private:
+		i_native_surface* iPacedSurface;
+		frame_pacing iPreviousPacing;
 		bool iEnableZSorting;
 		scalar iG;
 		optional_vec3 iUniformGravity;
@@ -0,0 +1,72 @@
+// tessellation_cache.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "neogfx.hpp"
+#include <list>
+#include <map>
+#include <tuple>
+#include "geometry.hpp"
+
+namespace neogfx
+{
+	// Caches arc tessellations as vertex offsets relative to the arc's centre so that circles, arcs and
+	// rounded rectangles of a given radius only need translating when drawn. Least recently used entries
+	// are discarded once the cache reaches capacity.
+	class tessellation_cache
+	{
+		// types
+	public:
+		typedef std::vector<vec2> vertices_t;
+	private:
+		typedef std::tuple<dimension, angle, angle, bool> key_type;
+		typedef std::list<std::pair<key_type, vertices_t>> entry_list;
+		typedef std::map<key_type, entry_list::iterator> entry_map;
+		// constants
+	public:
+		static const std::size_t DefaultCapacity = 256;
+		// construction
+	public:
+		tessellation_cache(std::size_t aCapacity = DefaultCapacity);
+		// operations
+	public:
+		const vertices_t& arc(dimension aRadius, angle aStartAngle, angle aEndAngle, bool aIncludeCentre);
+		void clear();
+		// attributes
+	public:
+		std::size_t size() const;
+		std::size_t capacity() const;
+		void set_capacity(std::size_t aCapacity);
+		uint64_t hits() const;
+		uint64_t misses() const;
+		void reset_counters();
+		// implementation
+	private:
+		static vertices_t tessellate_arc(dimension aRadius, angle aStartAngle, angle aEndAngle, bool aIncludeCentre);
+		void trim();
+		// attributes
+	private:
+		std::size_t iCapacity;
+		entry_list iEntries;
+		entry_map iIndex;
+		uint64_t iHits;
+		uint64_t iMisses;
+	};
+}
@@ -0,0 +1,66 @@
+// text_shaper.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "neogfx.hpp"
+#ifdef u8
+#undef u8
+#include <hb.h>
+#include <hb-ft.h>
+#include <hb-ucdn\ucdn.h>
+#define u8
+#else
+#include <hb.h>
+#include <hb-ft.h>
+#include <hb-ucdn\ucdn.h>
+#endif
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_GLYPH_H
+#include FT_OUTLINE_H
+#include FT_BITMAP_H
+#include "glyph.hpp"
+#include "font.hpp"
+
+namespace neogfx
+{
+	class text_shaper
+	{
+	public:
+		glyph_text to_glyph_text(string::const_iterator aTextBegin, string::const_iterator aTextEnd, std::function<font(std::string::size_type)> aFontSelector) const;
+		void set_mnemonic(bool aShowMnemonics, char aMnemonicPrefix = '&');
+		void unset_mnemonic();
+		bool mnemonics_shown() const;
+	private:
+		glyph_text::container to_glyph_text_impl(string::const_iterator aTextBegin, string::const_iterator aTextEnd, std::function<font(std::string::size_type)> aFontSelector, bool& aFallbackFontNeeded) const;
+	private:
+		struct cluster
+		{
+			std::string::size_type from;
+			glyph::flags_e flags;
+		};
+		typedef std::vector<cluster> cluster_map_t;
+		mutable cluster_map_t iClusterMap;
+		mutable std::vector<text_direction> iTextDirections;
+		mutable std::u32string iCodePointsBuffer;
+		mutable std::vector<std::tuple<const char32_t*, const char32_t*, text_direction, hb_script_t>> iRuns;
+		boost::optional<std::pair<bool, char>> iMnemonic;
+	};
+}
@@ -33,6 +33,7 @@ namespace neogfx
 		// construction
 	public:
 		texture();
+		texture(const size& aExtents);
 		texture(const i_texture& aTexture);
 		texture(const i_image& aImage);
 		~texture();
@@ -29,11 +29,28 @@ namespace neogfx
 	{
 		friend class texture_wrapper;
 	protected:
-		typedef std::list<std::weak_ptr<i_native_texture>> texture_list;
+		struct texture_entry
+		{
+			std::weak_ptr<i_native_texture> texture;
+			std::size_t residentSize;
+			uint64_t lastUsed;
+		};
+		typedef std::list<texture_entry> texture_list;
+	public:
+		static const uint64_t DefaultTextureMemoryBudget = 256 * 1024 * 1024;
+	public:
+		texture_manager();
 	public:
 		virtual std::unique_ptr<i_native_texture> join_texture(const i_native_texture& aTexture);
 		virtual std::unique_ptr<i_native_texture> join_texture(const i_texture& aTexture);
 		virtual void clear_textures();
+	public:
+		virtual uint64_t texture_memory_budget() const;
+		virtual void set_texture_memory_budget(uint64_t aBudget);
+		virtual uint64_t texture_memory_used() const;
+		virtual uint64_t texture_uploads() const;
+		virtual uint64_t texture_evictions() const;
+		virtual void end_frame();
 	protected:
 		const texture_list& textures() const;
 		texture_list& textures();
@@ -41,8 +58,16 @@ namespace neogfx
 		texture_list::iterator find_texture(const i_image& aImage);
 		std::unique_ptr<i_native_texture> add_texture(std::shared_ptr<i_native_texture> aTexture);
 	private:
+		void make_resident(texture_list::iterator aTexture);
+		void evict(texture_list::iterator aTexture);
+		void evict_to_budget(uint64_t aRequired);
 		void cleanup(texture_list::iterator aTexture);
 	private:
 		texture_list iTextures;
+		uint64_t iMemoryBudget;
+		uint64_t iMemoryUsed;
+		uint64_t iFrame;
+		uint64_t iUploads;
+		uint64_t iEvictions;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,309 @@
+// triangulation.hpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "neogfx.hpp"
+#include <algorithm>
+#include <limits>
+#include "geometry.hpp"
+
+namespace neogfx
+{
+	enum fill_rule_e
+	{
+		FillRuleNonZero,
+		FillRuleEvenOdd
+	};
+
+	template <typename PointType>
+	struct basic_triangulation
+	{
+		typedef PointType point_type;
+		typedef std::vector<point_type> vertex_list;
+		typedef std::vector<uint32_t> index_list;
+		vertex_list vertices;
+		index_list indices;
+	};
+
+	namespace detail
+	{
+		namespace triangulation
+		{
+			template <typename PointType>
+			inline typename PointType::coordinate_type cross(const PointType& aOrigin, const PointType& aA, const PointType& aB)
+			{
+				return (aA.x - aOrigin.x) * (aB.y - aOrigin.y) - (aA.y - aOrigin.y) * (aB.x - aOrigin.x);
+			}
+
+			template <typename PointType>
+			inline typename PointType::coordinate_type signed_area(const std::vector<PointType>& aPolygon)
+			{
+				typename PointType::coordinate_type result = 0;
+				for (std::size_t i = 0, j = aPolygon.size() - 1; i < aPolygon.size(); j = i++)
+					result += aPolygon[j].x * aPolygon[i].y - aPolygon[i].x * aPolygon[j].y;
+				return result / 2;
+			}
+
+			template <typename PointType>
+			inline bool contains(const std::vector<PointType>& aPolygon, const PointType& aPoint)
+			{
+				bool result = false;
+				for (std::size_t i = 0, j = aPolygon.size() - 1; i < aPolygon.size(); j = i++)
+					if ((aPolygon[i].y > aPoint.y) != (aPolygon[j].y > aPoint.y) &&
+						aPoint.x < (aPolygon[j].x - aPolygon[i].x) * (aPoint.y - aPolygon[i].y) / (aPolygon[j].y - aPolygon[i].y) + aPolygon[i].x)
+						result = !result;
+				return result;
+			}
+
+			template <typename PointType>
+			inline bool in_triangle(const PointType& aPoint, const PointType& aA, const PointType& aB, const PointType& aC)
+			{
+				auto d1 = cross(aA, aB, aPoint);
+				auto d2 = cross(aB, aC, aPoint);
+				auto d3 = cross(aC, aA, aPoint);
+				bool hasNegative = d1 < 0 || d2 < 0 || d3 < 0;
+				bool hasPositive = d1 > 0 || d2 > 0 || d3 > 0;
+				return !(hasNegative && hasPositive);
+			}
+
+			// Appends the triangles of a simple polygon with positive signed area to aIndices (as indices offset by aBase).
+			template <typename PointType>
+			inline void ear_clip(const std::vector<PointType>& aPolygon, uint32_t aBase, std::vector<uint32_t>& aIndices)
+			{
+				std::size_t count = aPolygon.size();
+				if (count < 3)
+					return;
+				std::vector<std::size_t> previous(count);
+				std::vector<std::size_t> next(count);
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					previous[i] = (i + count - 1) % count;
+					next[i] = (i + 1) % count;
+				}
+				std::size_t remaining = count;
+				std::size_t current = 0;
+				std::size_t sinceLastEar = 0;
+				while (remaining > 3)
+				{
+					std::size_t p = previous[current];
+					std::size_t n = next[current];
+					const PointType& a = aPolygon[p];
+					const PointType& b = aPolygon[current];
+					const PointType& c = aPolygon[n];
+					bool ear = cross(a, b, c) > 0;
+					for (std::size_t v = next[n]; ear && v != p; v = next[v])
+					{
+						const PointType& pt = aPolygon[v];
+						if (pt != a && pt != b && pt != c && in_triangle(pt, a, b, c))
+							ear = false;
+					}
+					// if a whole lap finds no ear the polygon is degenerate or self-intersecting; clip anyway so we terminate
+					if (ear || sinceLastEar > remaining)
+					{
+						if (cross(a, b, c) != 0)
+						{
+							aIndices.push_back(aBase + static_cast<uint32_t>(p));
+							aIndices.push_back(aBase + static_cast<uint32_t>(current));
+							aIndices.push_back(aBase + static_cast<uint32_t>(n));
+						}
+						next[p] = n;
+						previous[n] = p;
+						--remaining;
+						sinceLastEar = 0;
+						current = p;
+					}
+					else
+					{
+						current = n;
+						++sinceLastEar;
+					}
+				}
+				if (cross(aPolygon[previous[current]], aPolygon[current], aPolygon[next[current]]) != 0)
+				{
+					aIndices.push_back(aBase + static_cast<uint32_t>(previous[current]));
+					aIndices.push_back(aBase + static_cast<uint32_t>(current));
+					aIndices.push_back(aBase + static_cast<uint32_t>(next[current]));
+				}
+			}
+
+			// Joins a hole (negative signed area) into an outer polygon (positive signed area) by a bridge from the hole's
+			// rightmost vertex to a visible vertex of the outer polygon, producing a single weakly simple polygon.
+			template <typename PointType>
+			inline void merge_hole(std::vector<PointType>& aOuter, const std::vector<PointType>& aHole)
+			{
+				typedef typename PointType::coordinate_type coordinate_type;
+				std::size_t m = 0;
+				for (std::size_t i = 1; i < aHole.size(); ++i)
+					if (aHole[i].x > aHole[m].x)
+						m = i;
+				const PointType holePoint = aHole[m];
+				const std::size_t npos = static_cast<std::size_t>(-1);
+				std::size_t edge = npos;
+				coordinate_type closestX = std::numeric_limits<coordinate_type>::max();
+				for (std::size_t i = 0; i < aOuter.size(); ++i)
+				{
+					const PointType& v1 = aOuter[i];
+					const PointType& v2 = aOuter[(i + 1) % aOuter.size()];
+					if (v1.y == v2.y || std::min(v1.y, v2.y) > holePoint.y || std::max(v1.y, v2.y) < holePoint.y)
+						continue;
+					coordinate_type x = v1.x + (holePoint.y - v1.y) * (v2.x - v1.x) / (v2.y - v1.y);
+					if (x >= holePoint.x && x < closestX)
+					{
+						closestX = x;
+						edge = i;
+					}
+				}
+				if (edge == npos)
+					return;
+				std::size_t bridge = aOuter[edge].x > aOuter[(edge + 1) % aOuter.size()].x ? edge : (edge + 1) % aOuter.size();
+				const PointType intersection{ closestX, holePoint.y };
+				if (intersection != aOuter[bridge])
+				{
+					// a reflex vertex inside the triangle formed by the ray would block the bridge; use the one closest in angle to the ray
+					const PointType candidate = aOuter[bridge];
+					coordinate_type bestTangent = std::numeric_limits<coordinate_type>::max();
+					for (std::size_t i = 0; i < aOuter.size(); ++i)
+					{
+						const PointType& v = aOuter[i];
+						if (i == bridge || v.x < holePoint.x)
+							continue;
+						const PointType& vp = aOuter[(i + aOuter.size() - 1) % aOuter.size()];
+						const PointType& vn = aOuter[(i + 1) % aOuter.size()];
+						if (cross(vp, v, vn) > 0 || !in_triangle(v, holePoint, intersection, candidate))
+							continue;
+						coordinate_type tangent = v.x != holePoint.x ? std::abs(v.y - holePoint.y) / (v.x - holePoint.x) : std::numeric_limits<coordinate_type>::max();
+						if (tangent < bestTangent || (tangent == bestTangent && v.x < aOuter[bridge].x))
+						{
+							bestTangent = tangent;
+							bridge = i;
+						}
+					}
+				}
+				std::vector<PointType> merged;
+				merged.reserve(aOuter.size() + aHole.size() + 2);
+				merged.insert(merged.end(), aOuter.begin(), aOuter.begin() + bridge + 1);
+				for (std::size_t i = 0; i <= aHole.size(); ++i)
+					merged.push_back(aHole[(m + i) % aHole.size()]);
+				merged.insert(merged.end(), aOuter.begin() + bridge, aOuter.end());
+				aOuter.swap(merged);
+			}
+		}
+	}
+
+	// Triangulates a set of closed contours according to a fill rule. Contours must not intersect each other or
+	// themselves; nesting (holes, islands within holes) is supported. Self-intersecting input still produces
+	// triangles but they may not match the fill rule exactly.
+	template <typename PointType>
+	inline void triangulate(const std::vector<std::vector<PointType>>& aContours, fill_rule_e aFillRule, basic_triangulation<PointType>& aResult)
+	{
+		using namespace detail::triangulation;
+		typedef typename PointType::coordinate_type coordinate_type;
+		const std::size_t npos = static_cast<std::size_t>(-1);
+		struct contour
+		{
+			std::vector<PointType> points;
+			coordinate_type area;
+			std::size_t parent;
+			int winding;
+			bool inside;
+			bool outside;
+		};
+		aResult.vertices.clear();
+		aResult.indices.clear();
+		std::vector<contour> contours;
+		contours.reserve(aContours.size());
+		for (const auto& c : aContours)
+		{
+			contour next{ {}, 0, npos, 0, false, false };
+			next.points.reserve(c.size());
+			for (const auto& pt : c)
+				if (next.points.empty() || next.points.back() != pt)
+					next.points.push_back(pt);
+			while (next.points.size() > 1 && next.points.back() == next.points.front())
+				next.points.pop_back();
+			if (next.points.size() < 3)
+				continue;
+			next.area = signed_area(next.points);
+			if (next.area != 0)
+				contours.push_back(std::move(next));
+		}
+		// a contour's parent is the smallest contour containing it
+		for (std::size_t i = 0; i < contours.size(); ++i)
+			for (std::size_t j = 0; j < contours.size(); ++j)
+				if (j != i && std::abs(contours[j].area) > std::abs(contours[i].area) && 
+					(contours[i].parent == npos || std::abs(contours[j].area) < std::abs(contours[contours[i].parent].area)) &&
+					contains(contours[j].points, contours[i].points[0]))
+					contours[i].parent = j;
+		std::vector<std::size_t> order(contours.size());
+		for (std::size_t i = 0; i < order.size(); ++i)
+			order[i] = i;
+		std::sort(order.begin(), order.end(), [&contours](std::size_t aLeft, std::size_t aRight) { return std::abs(contours[aLeft].area) > std::abs(contours[aRight].area); });
+		for (auto i : order)
+		{
+			auto& c = contours[i];
+			c.outside = c.parent != npos ? contours[c.parent].inside : false;
+			if (aFillRule == FillRuleNonZero)
+			{
+				c.winding = (c.parent != npos ? contours[c.parent].winding : 0) + (c.area > 0 ? 1 : -1);
+				c.inside = c.winding != 0;
+			}
+			else
+				c.inside = !c.outside;
+		}
+		// contours where the fill starts are outer polygons; contours where it stops are holes in the nearest enclosing outer polygon
+		for (auto i : order)
+		{
+			const auto& c = contours[i];
+			if (!c.inside || c.outside)
+				continue;
+			std::vector<PointType> polygon = c.points;
+			if (c.area < 0)
+				std::reverse(polygon.begin(), polygon.end());
+			std::vector<std::vector<PointType>> holes;
+			for (std::size_t j = 0; j < contours.size(); ++j)
+			{
+				const auto& h = contours[j];
+				if (h.inside || !h.outside)
+					continue;
+				std::size_t owner = h.parent;
+				while (owner != npos && !(contours[owner].inside && !contours[owner].outside))
+					owner = contours[owner].parent;
+				if (owner != i)
+					continue;
+				holes.push_back(h.points);
+				if (h.area > 0)
+					std::reverse(holes.back().begin(), holes.back().end());
+			}
+			std::sort(holes.begin(), holes.end(), [](const std::vector<PointType>& aLeft, const std::vector<PointType>& aRight)
+			{
+				auto maxX = [](const std::vector<PointType>& aPoints) 
+				{ 
+					return std::max_element(aPoints.begin(), aPoints.end(), [](const PointType& aLeft, const PointType& aRight) { return aLeft.x < aRight.x; })->x; 
+				};
+				return maxX(aLeft) > maxX(aRight);
+			});
+			for (const auto& h : holes)
+				merge_hole(polygon, h);
+			uint32_t base = static_cast<uint32_t>(aResult.vertices.size());
+			aResult.vertices.insert(aResult.vertices.end(), polygon.begin(), polygon.end());
+			ear_clip(polygon, base, aResult.indices);
+		}
+	}
+}
@@ -20,10 +20,10 @@
 #pragma once
 
 #include "neogfx.hpp"
-#include <unordered_set>
 #include <neolib/destroyable.hpp>
 #include <neolib/timer.hpp>
 #include "i_widget.hpp"
+#include "texture.hpp"
 
 namespace neogfx
 {
@@ -128,12 +128,18 @@ namespace neogfx
 		virtual void update(const rect& aUpdateRect);
 		virtual bool requires_update() const;
 		virtual rect update_rect() const;
+		virtual void discard_update();
 		virtual rect default_clip_rect(bool aIncludeNonClient = false) const;
 		virtual bool ready_to_render() const;
 		virtual void render(graphics_context& aGraphicsContext) const;
 		virtual bool transparent_background() const;
 		virtual void paint_non_client(graphics_context& aGraphicsContext) const;
 		virtual void paint(graphics_context& aGraphicsContext) const;
+	public:
+		virtual neogfx::layer_caching layer_caching() const;
+		virtual void set_layer_caching(neogfx::layer_caching aLayerCaching);
+		virtual bool layer_cached() const;
+		virtual void invalidate_layer(bool aIncludeDescendants = false);
 	public:
 		virtual bool has_foreground_colour() const;
 		virtual colour foreground_colour() const;
@@ -193,6 +199,12 @@ namespace neogfx
 		virtual graphics_context create_graphics_context() const;
 	protected:
 		virtual i_widget& widget_for_mouse_event(const point& aPosition);
+	private:
+		static const uint32_t AutomaticLayerCachingThreshold = 4;
+		bool layer_caching_active() const;
+		bool layer_cacheable() const;
+		static bool opaque(const i_widget& aWidget);
+		void compute_occlusion() const;
 		// helpers
 	public:
 		using i_widget::set_size_policy;
@@ -213,7 +225,15 @@ namespace neogfx
 		optional_size iMinimumSize;
 		optional_size iMaximumSize;
 		uint32_t iLayoutInProgress;
-		mutable std::unordered_set<rect> iUpdateRects;
+		mutable region iUpdateRegion;
+		mutable region iOccludedRegion;
+		mutable std::vector<bool> iOccludedChildren;
+		neogfx::layer_caching iLayerCaching;
+		mutable optional_texture iLayer;
+		mutable bool iLayerValid;
+		mutable bool iSelfUpdatePending;
+		mutable uint32_t iLayerReuse;
+		static uint32_t sUpdatePropagation;
 		bool iVisible;
 		bool iEnabled;
 		neogfx::focus_policy iFocusPolicy;
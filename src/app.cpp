@@ -23,6 +23,8 @@
 #include "app.hpp"
 #include "sdl_basic_services.hpp"
 #include "sdl_renderer.hpp"
+#include "offscreen_renderer.hpp"
+#include "software_renderer.hpp"
 #include "surface_manager.hpp"
 #include "sdl_keyboard.hpp"
 #include "i_native_window.hpp"
@@ -33,6 +35,22 @@ namespace neogfx
 	namespace
 	{
 		std::atomic<app*> sFirstInstance;
+
+		const frame_scheduler::duration MaximumEventWait = std::chrono::milliseconds(10);
+
+		i_rendering_engine* create_rendering_engine(renderer aRenderer, i_basic_services& aBasicServices, i_keyboard& aKeyboard)
+		{
+			switch (aRenderer)
+			{
+			case renderer::Offscreen:
+				return new offscreen_renderer(aBasicServices, aKeyboard);
+			case renderer::Software:
+				return new software_renderer(aBasicServices, aKeyboard);
+			case renderer::OpenGL:
+			default:
+				return new sdl_renderer(aBasicServices, aKeyboard);
+			}
+		}
 	}
 
 	app::event_processing_context::event_processing_context(app& aParent, const std::string& aName) :
@@ -46,7 +64,7 @@ namespace neogfx
 		return iName;
 	}
 
-	app::app(const std::string& aName)
+	app::app(const std::string& aName, neogfx::renderer aRenderer)
 		try :
 		iName(aName),
 		iQuitWhenLastWindowClosed(true),
@@ -54,7 +72,8 @@ namespace neogfx
 		iBasicServices(new neogfx::sdl_basic_services(*this)),
 		iKeyboard(new neogfx::sdl_keyboard()),
 		iClipboard(new neogfx::clipboard(basic_services().clipboard())),
-		iRenderingEngine(new neogfx::sdl_renderer(*iBasicServices, *iKeyboard)),
+		iRenderer(aRenderer),
+		iRenderingEngine(create_rendering_engine(aRenderer, *iBasicServices, *iKeyboard)),
 		iSurfaceManager(new neogfx::surface_manager(*iBasicServices, *iRenderingEngine)),
 		iCurrentStyle(iStyles.begin())
 	{
@@ -149,6 +168,11 @@ namespace neogfx
 			throw no_basic_services();
 	}
 
+	neogfx::renderer app::renderer() const
+	{
+		return iRenderer;
+	}
+
 	i_rendering_engine& app::rendering_engine() const
 	{
 		if (iRenderingEngine)
@@ -269,6 +293,16 @@ namespace neogfx
 			iMnemonics.erase(n);
 	}
 
+	const neogfx::profiler& app::profiler() const
+	{
+		return iProfiler;
+	}
+
+	neogfx::profiler& app::profiler()
+	{
+		return iProfiler;
+	}
+
 	bool app::process_events(i_event_processing_context&)
 	{
 		bool didSome = false;
@@ -299,6 +333,8 @@ namespace neogfx
 			}
 		}
 		rendering_engine().render_now();
+		if (!didSome)
+			wait_for_events();
 		return didSome;
 	}
 
@@ -314,6 +350,18 @@ namespace neogfx
 		return didSome;
 	}
 
+	void app::wait_for_events()
+	{
+		// sleep until a surface wants its next frame or input arrives; neolib does not tell us when its next timer 
+		// is due so never sleep for longer than a timer tick
+		auto timeout = MaximumEventWait;
+		auto nextFrameTime = surface_manager().next_frame_time();
+		if (nextFrameTime != boost::none)
+			timeout = std::min(timeout, std::max(frame_scheduler::duration::zero(), *nextFrameTime - frame_scheduler::clock::now()));
+		if (timeout > frame_scheduler::duration::zero())
+			rendering_engine().wait_for_events(timeout);
+	}
+
 	bool app::key_pressed(scan_code_e aScanCode, key_code_e aKeyCode, key_modifiers_e aKeyModifiers)
 	{
 		if (aScanCode == ScanCode_LALT || aScanCode == ScanCode_RALT)
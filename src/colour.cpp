@@ -266,83 +266,98 @@ namespace neogfx
 	}
 
 	gradient::gradient(const colour& aFrom, const colour& aTo, direction_e aDirection) : 
-		iFrom(aFrom), 
-		iTo(aTo), 
+		iColourStops{ colour_stop{ 0.0, aFrom }, colour_stop{ 1.0, aTo } }, 
 		iDirection(aDirection) 
 	{
 	}
 
 	gradient::gradient(const colour& aFromTo, direction_e aDirection) :
-		iFrom(aFromTo),
-		iTo(aFromTo),
+		iColourStops{ colour_stop{ 0.0, aFromTo }, colour_stop{ 1.0, aFromTo } },
 		iDirection(aDirection)
 	{
 	}
 
+	gradient::gradient(const colour_stop_list& aColourStops, direction_e aDirection) :
+		iColourStops(aColourStops),
+		iDirection(aDirection)
+	{
+		if (iColourStops.empty())
+			throw bad_colour_stops();
+		for (auto s = iColourStops.begin(); s != iColourStops.end(); ++s)
+			if (s->first < 0.0 || s->first > 1.0 || (s != iColourStops.begin() && s->first < std::prev(s)->first))
+				throw bad_colour_stops();
+		if (iColourStops.front().first != 0.0)
+			iColourStops.insert(iColourStops.begin(), colour_stop{ 0.0, iColourStops.front().second });
+		if (iColourStops.back().first != 1.0)
+			iColourStops.push_back(colour_stop{ 1.0, iColourStops.back().second });
+	}
+
 	colour gradient::at(coordinate aPos, coordinate aStart, coordinate aEnd) const
 	{
 		if (aEnd - aStart == 0)
-			return iFrom;
-		colour::component red, green, blue, alpha;
-		if (iFrom.red() < iTo.red())
-			red = static_cast<colour::component>(static_cast<uint32_t>(iFrom.red() + (iTo.red() - iFrom.red()) * (aPos - aStart) / (aEnd - aStart)));
-		else
-			red = static_cast<colour::component>(static_cast<uint32_t>(iFrom.red() - (iFrom.red() - iTo.red()) * (aPos - aStart) / (aEnd - aStart)));
-		if (iFrom.green() < iTo.green())
-			green = static_cast<colour::component>(static_cast<uint32_t>(iFrom.green() + (iTo.green() - iFrom.green()) * (aPos - aStart) / (aEnd - aStart)));
-		else
-			green = static_cast<colour::component>(static_cast<uint32_t>(iFrom.green() - (iFrom.green() - iTo.green()) * (aPos - aStart) / (aEnd - aStart)));
-		if (iFrom.blue() < iTo.blue())
-			blue = static_cast<colour::component>(static_cast<uint32_t>(iFrom.blue() + (iTo.blue() - iFrom.blue()) * (aPos - aStart) / (aEnd - aStart)));
-		else
-			blue = static_cast<colour::component>(static_cast<uint32_t>(iFrom.blue() - (iFrom.blue() - iTo.blue()) * (aPos - aStart) / (aEnd - aStart)));
-		if (iFrom.alpha() < iTo.alpha())
-			alpha = static_cast<colour::component>(static_cast<uint32_t>(iFrom.alpha() + (iTo.alpha() - iFrom.alpha()) * (aPos - aStart) / (aEnd - aStart)));
-		else
-			alpha = static_cast<colour::component>(static_cast<uint32_t>(iFrom.alpha() - (iFrom.alpha() - iTo.alpha()) * (aPos - aStart) / (aEnd - aStart)));
-		return colour(red, green, blue, alpha);
+			return from();
+		return at(std::max(0.0, std::min(1.0, static_cast<double>((aPos - aStart) / (aEnd - aStart)))));
 	}
 
 	colour gradient::at(double aPos) const
 	{
 		if (aPos < 0.0 || aPos > 1.0)
 			throw bad_position();
-		return at(static_cast<coordinate>(aPos * colour::MaxComponetValue), 0, colour::MaxComponetValue);
+		auto next = std::upper_bound(iColourStops.begin(), iColourStops.end(), aPos, 
+			[](double aValue, const colour_stop& aStop) { return aValue < aStop.first; });
+		if (next == iColourStops.begin())
+			return next->second;
+		if (next == iColourStops.end())
+			return iColourStops.back().second;
+		auto previous = std::prev(next);
+		double ratio = (aPos - previous->first) / (next->first - previous->first);
+		auto lerp = [ratio](colour::component aFrom, colour::component aTo)
+		{
+			return static_cast<colour::component>(aFrom + (aTo - aFrom) * ratio + 0.5);
+		};
+		const colour& c1 = previous->second;
+		const colour& c2 = next->second;
+		return colour(lerp(c1.red(), c2.red()), lerp(c1.green(), c2.green()), lerp(c1.blue(), c2.blue()), lerp(c1.alpha(), c2.alpha()));
 	}
 
 	const colour& gradient::from() const
 	{
-		return iFrom;
+		return iColourStops.front().second;
 	}
 
 	colour& gradient::from()
 	{
-		return iFrom;
+		return iColourStops.front().second;
 	}
 
 	const colour& gradient::to() const
 	{
-		return iTo;
+		return iColourStops.back().second;
 	}
 
 	colour& gradient::to()
 	{
-		return iTo;
+		return iColourStops.back().second;
+	}
+
+	const gradient::colour_stop_list& gradient::colour_stops() const
+	{
+		return iColourStops;
 	}
 
 	gradient gradient::with_alpha(colour::component aAlpha) const
 	{
 		gradient result = *this;
-		result.from() = result.from().with_alpha(aAlpha);
-		result.to() = result.to().with_alpha(aAlpha);
+		for (auto& s : result.iColourStops)
+			s.second = s.second.with_alpha(aAlpha);
 		return result;
 	}
 
 	gradient gradient::with_combined_alpha(colour::component aAlpha) const
 	{
 		gradient result = *this;
-		result.from() = result.from().with_combined_alpha(aAlpha);
-		result.to() = result.to().with_combined_alpha(aAlpha);
+		for (auto& s : result.iColourStops)
+			s.second = s.second.with_combined_alpha(aAlpha);
 		return result;
 	}
 
@@ -353,7 +368,7 @@ namespace neogfx
 
 	bool gradient::operator==(const gradient& aOther) const
 	{
-		return iFrom == aOther.iFrom && iTo == aOther.iTo && iDirection == aOther.iDirection;
+		return iColourStops == aOther.iColourStops && iDirection == aOther.iDirection;
 	}
 
 	bool gradient::operator!=(const gradient& aOther) const
@@ -363,7 +378,7 @@ namespace neogfx
 
 	bool gradient::operator<(const gradient& aOther) const
 	{
-		return std::tie(iFrom, iTo, iDirection) < std::tie(aOther.iFrom, aOther.iTo, aOther.iDirection);
+		return std::tie(iColourStops, iDirection) < std::tie(aOther.iColourStops, aOther.iDirection);
 	}
 
 	const colour colour::AliceBlue = colour(0xF0, 0xF8, 0xFF);
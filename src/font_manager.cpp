@@ -25,7 +25,6 @@
 #include FT_LCD_FILTER_H
 #include "app.hpp"
 #include "font_manager.hpp"
-#include "font_texture.hpp"
 
 namespace neogfx
 {
@@ -334,7 +333,7 @@ namespace neogfx
 		for (auto& ft : iFontTextures)
 			if (ft->allocate_glyph_space(aSize, aResult))
 				return *ft;
-		iFontTextures.push_back(std::make_unique<font_texture>(size(1024, 1024), iRenderingEngine.screen_metrics().subpixel_format() != i_screen_metrics::SubpixelFormatUnknown));
+		iFontTextures.push_back(iRenderingEngine.texture_manager().create_font_texture(size(1024, 1024), iRenderingEngine.screen_metrics().subpixel_format() != i_screen_metrics::SubpixelFormatUnknown));
 		if (!iFontTextures.back()->allocate_glyph_space(aSize, aResult))
 			throw failed_to_allocate_glyph_space();
 		return *iFontTextures.back();
@@ -18,6 +18,7 @@
 */
 
 #include "neogfx.hpp"
+#include "opengl_state.hpp"
 #include "font_texture.hpp"
 
 namespace neogfx
@@ -25,20 +26,19 @@ namespace neogfx
 	font_texture::font_texture(const size& aExtents, bool aSubPixelRendering) :
 		iExtents(aExtents), iSubPixelRendering(aSubPixelRendering), iBinPack(aExtents, false)
 	{
-		GLint previousTexture;
-		glCheck(glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture));
 		glCheck(glGenTextures(1, &iHandle));
-		glCheck(glBindTexture(GL_TEXTURE_2D, iHandle));
+		opengl_state::current().bind_texture(iHandle);
 		glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
 		glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
 		std::vector<std::array<uint8_t, 3>> data(static_cast<std::size_t>(iExtents.cx * iExtents.cy), std::array<uint8_t, 3>{{0xFF, 0xFF, 0xFF}});
-		glCheck(glTexImage2D(GL_TEXTURE_2D, 0, aSubPixelRendering ? GL_RGB : GL_ALPHA, static_cast<GLsizei>(iExtents.cx), static_cast<GLsizei>(iExtents.cy), 0, aSubPixelRendering ? GL_RGB : GL_ALPHA, GL_UNSIGNED_BYTE, &data[0]));
-		glCheck(glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(previousTexture)));
+		// coverage goes in the red channel as alpha textures are not available in a core profile
+		glCheck(glTexImage2D(GL_TEXTURE_2D, 0, aSubPixelRendering ? GL_RGB8 : GL_R8, static_cast<GLsizei>(iExtents.cx), static_cast<GLsizei>(iExtents.cy), 0, aSubPixelRendering ? GL_RGB : GL_RED, GL_UNSIGNED_BYTE, &data[0]));
 	}
 
 	font_texture::~font_texture()
 	{
 		glCheck(glDeleteTextures(1, &iHandle));
+		opengl_state::texture_deleted(iHandle);
 	}
 
 	const size& font_texture::extents() const
@@ -57,8 +57,17 @@ namespace neogfx
 		return reinterpret_cast<void*>(iHandle);
 	}
 
-	glyph_texture::glyph_texture(const i_font_texture& aFontTexture, const rect& aFontTextureLocation, const size& aExtents, const point& aPlacement) :
-		iFontTexture(aFontTexture), iFontTextureLocation(aFontTextureLocation), iExtents(aExtents), iPlacement(aPlacement)
+	void font_texture::update(const rect& aRect, const void* aPixels)
+	{
+		opengl_state::current().bind_texture(iHandle);
+		glCheck(glTexSubImage2D(GL_TEXTURE_2D, 0,
+			static_cast<GLint>(aRect.x), static_cast<GLint>(aRect.y), static_cast<GLsizei>(aRect.cx), static_cast<GLsizei>(aRect.cy), 
+			iSubPixelRendering ? GL_RGB : GL_RED, GL_UNSIGNED_BYTE, aPixels));
+		++opengl_state::current().counters().glyphUploads;
+	}
+
+	glyph_texture::glyph_texture(const i_font_texture& aFontTexture, const rect& aFontTextureLocation, const size& aExtents, const point& aPlacement, std::vector<uint8_t> aCoverage) :
+		iFontTexture(aFontTexture), iFontTextureLocation(aFontTextureLocation), iExtents(aExtents), iPlacement(aPlacement), iCoverage(std::move(aCoverage))
 	{
 	}
 
@@ -85,4 +94,9 @@ namespace neogfx
 	{
 		return iPlacement;
 	}
+
+	const std::vector<uint8_t>& glyph_texture::coverage() const
+	{
+		return iCoverage;
+	}
 }
\ No newline at end of file
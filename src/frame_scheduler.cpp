@@ -0,0 +1,187 @@
+// frame_scheduler.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "neogfx.hpp"
+#include <algorithm>
+#include <vector>
+#include <cmath>
+#include "frame_scheduler.hpp"
+
+namespace neogfx
+{
+	namespace
+	{
+		const frame_scheduler::duration PresentMargin = std::chrono::milliseconds(1);
+
+		double to_ms(frame_scheduler::duration aDuration)
+		{
+			return std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(aDuration).count();
+		}
+
+		frame_scheduler::duration from_ms(double aMilliseconds)
+		{
+			return std::chrono::duration_cast<frame_scheduler::duration>(std::chrono::duration<double, std::milli>(aMilliseconds));
+		}
+	}
+
+	frame_scheduler::frame_scheduler(neogfx::frame_pacing aPacing, const boost::optional<uint32_t>& aFrameRate) :
+		iPacing(aPacing),
+		iFrameRate(aFrameRate),
+		iFrames(0),
+		iMissedDeadlines(0),
+		iFrameTimes{},
+		iRenderEstimate(0.0)
+	{
+	}
+
+	neogfx::frame_pacing frame_scheduler::frame_pacing() const
+	{
+		return iPacing;
+	}
+
+	void frame_scheduler::set_frame_pacing(neogfx::frame_pacing aPacing)
+	{
+		if (iPacing != aPacing)
+		{
+			iPacing = aPacing;
+			iNextFrameTime = clock::now();
+		}
+	}
+
+	const boost::optional<uint32_t>& frame_scheduler::frame_rate() const
+	{
+		return iFrameRate;
+	}
+
+	void frame_scheduler::set_frame_rate(const boost::optional<uint32_t>& aFrameRate)
+	{
+		iFrameRate = aFrameRate != boost::none && *aFrameRate == 0 ? boost::none : aFrameRate;
+		iNextFrameTime = std::min(iNextFrameTime, clock::now() + frame_period());
+	}
+
+	void frame_scheduler::set_refresh_rate(const boost::optional<uint32_t>& aRefreshRate)
+	{
+		iRefreshRate = aRefreshRate != boost::none && *aRefreshRate == 0 ? boost::none : aRefreshRate;
+	}
+
+	frame_scheduler::time_point frame_scheduler::next_frame_time() const
+	{
+		return iNextFrameTime;
+	}
+
+	neogfx::frame_statistics frame_scheduler::frame_statistics() const
+	{
+		neogfx::frame_statistics result = {};
+		result.frames = iFrames;
+		result.missedDeadlines = iMissedDeadlines;
+		std::size_t samples = static_cast<std::size_t>(std::min<uint64_t>(iFrames, FrameTimeSamples));
+		if (samples == 0)
+			return result;
+		std::vector<double> frameTimes(iFrameTimes.begin(), iFrameTimes.begin() + samples);
+		result.minimumFrameTime = *std::min_element(frameTimes.begin(), frameTimes.end());
+		for (auto ft : frameTimes)
+			result.averageFrameTime += ft;
+		result.averageFrameTime /= samples;
+		auto p99 = frameTimes.begin() + (static_cast<std::size_t>(std::ceil(samples * 0.99)) - 1);
+		std::nth_element(frameTimes.begin(), p99, frameTimes.end());
+		result.p99FrameTime = *p99;
+		return result;
+	}
+
+	bool frame_scheduler::frame_due(time_point aNow) const
+	{
+		return aNow >= iNextFrameTime;
+	}
+
+	void frame_scheduler::frame_started(time_point aNow)
+	{
+		iFrameStarted = aNow;
+	}
+
+	void frame_scheduler::frame_skipped(time_point aNow)
+	{
+		// nothing was invalidated; an on demand surface can render as soon as something is, a continuous one waits for 
+		// its next tick
+		if (iPacing == neogfx::frame_pacing::Continuous)
+		{
+			duration period = frame_period();
+			if (period == duration::zero())
+				iNextFrameTime = aNow;
+			else if (iNextFrameTime <= aNow)
+				iNextFrameTime += period * ((aNow - iNextFrameTime) / period + 1);
+		}
+	}
+
+	void frame_scheduler::frame_presented(time_point aPresentStarted, time_point aPresentFinished)
+	{
+		duration frameTime = aPresentFinished - iFrameStarted;
+		record(frameTime);
+		iRenderEstimate = iRenderEstimate * 0.9 + to_ms(aPresentStarted - iFrameStarted) * 0.1;
+		duration period = frame_period();
+		if (iPacing == neogfx::frame_pacing::OnDemand)
+		{
+			iNextFrameTime = iFrameStarted + period;
+			return;
+		}
+		if (frameTime > period)
+			++iMissedDeadlines;
+		if (iRefreshRate != boost::none)
+		{
+			// the present returned at a vertical blank: start rendering so that the frame is ready just before the 
+			// blank we are aiming for
+			iNextFrameTime = aPresentFinished + period - refresh_period() + std::max(duration::zero(), refresh_period() - render_estimate() - PresentMargin);
+		}
+		else if (iFrames == 1 || period == duration::zero())
+			iNextFrameTime = iFrameStarted + period;
+		else
+		{
+			// stay on the cadence rather than drifting by however late this frame was; ticks already missed are dropped
+			iNextFrameTime += period;
+			if (iNextFrameTime <= aPresentFinished)
+				iNextFrameTime += period * ((aPresentFinished - iNextFrameTime) / period + 1);
+		}
+	}
+
+	frame_scheduler::duration frame_scheduler::frame_period() const
+	{
+		duration period = iFrameRate != boost::none ? from_ms(1000.0 / *iFrameRate) : duration::zero();
+		if (iRefreshRate == boost::none)
+			return period;
+		// a synchronized present can only happen on a vertical blank so round up to a whole number of refreshes
+		duration refresh = refresh_period();
+		return refresh * std::max<duration::rep>(1, (period + refresh - duration{ 1 }) / refresh);
+	}
+
+	frame_scheduler::duration frame_scheduler::refresh_period() const
+	{
+		return iRefreshRate != boost::none ? from_ms(1000.0 / *iRefreshRate) : duration::zero();
+	}
+
+	frame_scheduler::duration frame_scheduler::render_estimate() const
+	{
+		return from_ms(iRenderEstimate);
+	}
+
+	void frame_scheduler::record(duration aFrameTime)
+	{
+		iFrameTimes[iFrames % FrameTimeSamples] = to_ms(aFrameTime);
+		++iFrames;
+	}
+}
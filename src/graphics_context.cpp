@@ -121,9 +121,7 @@ namespace neogfx
 	{
 		path result = aValue;
 		result.set_position(to_device_units(result.position()));
-		for (std::size_t i = 0; i < result.paths().size(); ++i)
-			for (std::size_t j = 0; j < result.paths()[i].size(); ++j)
-				result.paths()[i][j] = to_device_units(result.paths()[i][j]);
+		result.map_points([this](const point& aPoint) { return to_device_units(aPoint); });
 		return result;
 	}
 
@@ -305,6 +303,7 @@ namespace neogfx
 
 	void graphics_context::fill_and_draw_path(const path& aPath, const colour& aFillColour, const pen& aOutlinePen) const
 	{
+		aPath.triangulation(); // triangulate (or reuse) on the caller's path so the device unit copy inherits the cached result
 		path path = to_device_units(aPath);
 		path.set_position(path.position() + iOrigin);
 		iNativeGraphicsContext->fill_and_draw_path(path, aFillColour, aOutlinePen);
@@ -557,6 +556,17 @@ namespace neogfx
 
 	void graphics_context::flush() const
 	{
+		iNativeGraphicsContext->flush();
+	}
+
+	void graphics_context::begin_recording() const
+	{
+		iNativeGraphicsContext->begin_recording();
+	}
+
+	void graphics_context::end_recording() const
+	{
+		iNativeGraphicsContext->end_recording();
 	}
 
 	void graphics_context::scissor_on(const rect& aRect) const
@@ -667,6 +677,17 @@ namespace neogfx
 			pen{ aColour, std::ceil(aFont.native_font_face().underline_thickness()) });
 	}
 
+	void graphics_context::draw_glyph_run(const glyph_run& aRun) const
+	{
+		if (aRun.empty())
+			return;
+		iDeviceGlyphRun.assign(aRun.begin(), aRun.end());
+		for (auto& item : iDeviceGlyphRun)
+			item.position = to_device_units(item.position) + iOrigin;
+		glyph_drawing gd(*this);
+		iNativeGraphicsContext->draw_glyph_run(iDeviceGlyphRun);
+	}
+
 	void graphics_context::set_glyph_text_cache(glyph_text& aGlyphTextCache) const
 	{
 		iGlyphTextCache = &aGlyphTextCache;
@@ -721,4 +742,19 @@ namespace neogfx
 	{
 		iNativeGraphicsContext->draw_texture(to_device_units(aTextureMap) + iOrigin.to_vector(), aTexture, aTextureRect, aColour);
 	}
+
+	void graphics_context::copy_to_texture(const rect& aSourceRect, const i_texture& aTexture) const
+	{
+		iNativeGraphicsContext->copy_to_texture(to_device_units(aSourceRect) + iOrigin, aTexture);
+	}
+
+	void graphics_context::copy_from_texture(const i_texture& aTexture, const point& aDestination) const
+	{
+		iNativeGraphicsContext->copy_from_texture(aTexture, rect{ to_device_units(aDestination) + iOrigin, aTexture.extents() });
+	}
+
+	void graphics_context::copy_from_texture(const i_texture& aTexture, const rect& aDestinationRect) const
+	{
+		iNativeGraphicsContext->copy_from_texture(aTexture, to_device_units(aDestinationRect) + iOrigin);
+	}
 }
\ No newline at end of file
@@ -227,6 +227,7 @@ namespace neogfx
 	{
 		scrollable_widget::paint(aGraphicsContext);
 		auto first = first_visible_item(aGraphicsContext);
+		rect updateRect = surface().native_surface().using_frame_buffer() ? update_rect() : client_rect();
 		bool finished = false;
 		for (item_model_index::value_type row = first.first; row < model().rows() && !finished; ++row)
 		{
@@ -242,6 +243,8 @@ namespace neogfx
 				if (cellRect.y > item_display_rect().bottom())
 					continue;
 				finished = false;
+				if (cellRect.intersection(updateRect).empty())
+					continue;
 				aGraphicsContext.scissor_on(default_clip_rect().intersection(cellRect));
 				aGraphicsContext.draw_glyph_text(cellRect.top_left() + point(cell_margins().left, cell_margins().top), presentation_model().cell_glyph_text(item_model_index(row, col), aGraphicsContext), f, *textColour);
 				if (selection_model().has_current_index() && selection_model().current_index() == item_model_index(row, col) && has_focus())
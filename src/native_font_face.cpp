@@ -23,7 +23,6 @@
 #include FT_GLYPH_H
 #include FT_OUTLINE_H
 #include FT_BITMAP_H
-#include "opengl_error.hpp"
 #include "native_font_face.hpp"
 #include "glyph.hpp"
 #include "i_rendering_engine.hpp"
@@ -158,6 +157,19 @@ namespace neogfx
 		FT_Glyph_To_Bitmap(&glyphDesc, lcdMode ? FT_RENDER_MODE_LCD : FT_RENDER_MODE_NORMAL, 0, 1);
 		FT_Bitmap& bitmap = reinterpret_cast<FT_BitmapGlyph>(glyphDesc)->bitmap;
 
+		// a copy of the coverage (one value per pixel, subpixels averaged) is kept for rendering without the GPU
+		std::vector<uint8_t> coverage;
+		uint32_t coverageWidth = bitmap.width / (lcdMode ? 3 : 1);
+		coverage.reserve(coverageWidth * bitmap.rows);
+		for (uint32_t y = 0; y < bitmap.rows; y++)
+			for (uint32_t x = 0; x < coverageWidth; x++)
+			{
+				if (lcdMode)
+					coverage.push_back(static_cast<uint8_t>((bitmap.buffer[x * 3 + bitmap.pitch * y] + bitmap.buffer[x * 3 + 1 + bitmap.pitch * y] + bitmap.buffer[x * 3 + 2 + bitmap.pitch * y]) / 3));
+				else
+					coverage.push_back(bitmap.buffer[x + bitmap.pitch * y]);
+			}
+
 		rect glyphRect;
 		i_font_texture& fontTexture = iRenderingEngine.font_manager().allocate_glyph_space(neogfx::size(static_cast<dimension>(bitmap.width), static_cast<dimension>(bitmap.rows)), glyphRect);
 		i_glyph_texture& glyphTexture = iGlyphs.insert(std::make_pair(aGlyph.value(),
@@ -167,14 +179,15 @@ namespace neogfx
 				neogfx::size(static_cast<dimension>(bitmap.width / (lcdMode ? 3.0 : 1.0)), static_cast<dimension>(bitmap.rows)),
 				neogfx::point(
 					iHandle->glyph->metrics.horiBearingX / 64.0,
-					(iHandle->glyph->metrics.horiBearingY - iHandle->glyph->metrics.height) / 64.0)))).first->second;
+					(iHandle->glyph->metrics.horiBearingY - iHandle->glyph->metrics.height) / 64.0),
+				std::move(coverage)))).first->second;
 
 		iGlyphTextureData.clear();
 		iGlyphTextureData.resize(static_cast<std::size_t>(glyphRect.cx * glyphRect.cy));
 		iSubpixelGlyphTextureData.clear();
 		iSubpixelGlyphTextureData.resize(static_cast<std::size_t>(glyphRect.cx * glyphRect.cy));
 
-		const GLubyte* textureData = 0;
+		const uint8_t* textureData = 0;
 
 		if (lcdMode)
 		{
@@ -193,15 +206,7 @@ namespace neogfx
 			textureData = &iGlyphTextureData[0];
 		}
 
-		GLint previousTexture;
-		glCheck(glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture));
-		glCheck(glBindTexture(GL_TEXTURE_2D, reinterpret_cast<GLuint>(glyphTexture.font_texture().handle())));
-
-		glCheck(glTexSubImage2D(GL_TEXTURE_2D, 0,
-			static_cast<GLint>(glyphRect.x), static_cast<GLint>(glyphRect.y), static_cast<GLsizei>(glyphRect.cx), static_cast<GLsizei>(glyphRect.cy), 
-			lcdMode ? GL_RGB : GL_ALPHA, GL_UNSIGNED_BYTE, &textureData[0]));
-
-		glCheck(glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(previousTexture)));
+		fontTexture.update(glyphRect, textureData);
 
 		return glyphTexture;
 	}
@@ -0,0 +1,229 @@
+// offscreen_renderer.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "neogfx.hpp"
+#include <sstream>
+#include <thread>
+#ifdef WIN32
+#include <SDL.h>
+#else
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+#include <neolib/raii.hpp>
+#include "app.hpp"
+#include "surface_manager.hpp"
+#include "offscreen_window.hpp"
+#include "offscreen_renderer.hpp"
+
+namespace neogfx
+{
+#ifndef WIN32
+	namespace
+	{
+		std::string egl_error()
+		{
+			std::ostringstream result;
+			result << "EGL error 0x" << std::hex << eglGetError();
+			return result.str();
+		}
+	}
+#endif
+
+	offscreen_renderer::offscreen_renderer(i_basic_services& aBasicServices, i_keyboard& aKeyboard) : 
+		iBasicServices(aBasicServices), iKeyboard(aKeyboard), iDisplay(0), iConfig(0), iCreatingWindow(0)
+	{
+#ifdef WIN32
+		// there is no display-less OpenGL on Windows so each context lives in a hidden window; we only ever render to frame buffers
+		SDL_Init(SDL_INIT_VIDEO);
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 2);
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+#else
+		EGLDisplay display = EGL_NO_DISPLAY;
+#ifdef EGL_PLATFORM_SURFACELESS_MESA
+		auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+		if (getPlatformDisplay != 0)
+			display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, 0);
+#endif
+		if (display == EGL_NO_DISPLAY)
+			display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+		if (display == EGL_NO_DISPLAY || !eglInitialize(display, 0, 0))
+			throw failed_to_initialize();
+		const EGLint configAttributes[] = 
+		{
+			EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+			EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+			EGL_RED_SIZE, 8,
+			EGL_GREEN_SIZE, 8,
+			EGL_BLUE_SIZE, 8,
+			EGL_ALPHA_SIZE, 8,
+			EGL_NONE
+		};
+		EGLConfig config = 0;
+		EGLint configCount = 0;
+		if (!eglBindAPI(EGL_OPENGL_API) || !eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0)
+		{
+			eglTerminate(display);
+			throw failed_to_initialize();
+		}
+		iDisplay = display;
+		iConfig = config;
+#endif
+	}
+
+	offscreen_renderer::~offscreen_renderer()
+	{
+#ifdef WIN32
+		SDL_Quit();
+#else
+		eglMakeCurrent(iDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		eglTerminate(iDisplay);
+#endif
+	}
+
+	void* offscreen_renderer::create_context(i_native_surface& aSurface)
+	{
+		if (iContexts.find(&aSurface) != iContexts.end())
+			throw context_exists();
+#ifdef WIN32
+		SDL_Window* surface = SDL_CreateWindow("neogfx::offscreen_renderer", 0, 0, 1, 1, SDL_WINDOW_HIDDEN | SDL_WINDOW_OPENGL);
+		if (surface == 0)
+			throw failed_to_create_opengl_context(SDL_GetError());
+		SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 1);
+		SDL_GLContext handle = SDL_GL_CreateContext(surface);
+		if (handle == 0)
+		{
+			std::string reason = SDL_GetError();
+			SDL_DestroyWindow(surface);
+			throw failed_to_create_opengl_context(reason);
+		}
+#else
+		// the pbuffer is only there to make the context current; everything is rendered to the window's frame buffer
+		const EGLint surfaceAttributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+		EGLSurface surface = eglCreatePbufferSurface(iDisplay, iConfig, surfaceAttributes);
+		if (surface == EGL_NO_SURFACE)
+			throw failed_to_create_opengl_context(egl_error());
+		EGLContext shareWith = iContexts.empty() ? EGL_NO_CONTEXT : iContexts.begin()->second.handle;
+		// the default shader program is GLSL 1.50 so a 3.2 core profile context is needed (Mesa's default is 3.0)
+		const EGLint contextAttributes[] =
+		{
+			EGL_CONTEXT_MAJOR_VERSION_KHR, 3,
+			EGL_CONTEXT_MINOR_VERSION_KHR, 2,
+			EGL_CONTEXT_OPENGL_PROFILE_MASK_KHR, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT_KHR,
+			EGL_NONE
+		};
+		EGLContext handle = eglCreateContext(iDisplay, iConfig, shareWith, contextAttributes);
+		if (handle == EGL_NO_CONTEXT)
+		{
+			std::string reason = egl_error();
+			eglDestroySurface(iDisplay, surface);
+			throw failed_to_create_opengl_context(reason);
+		}
+#endif
+		return (iContexts[&aSurface] = context{ surface, handle }).handle;
+	}
+
+	void offscreen_renderer::destroy_context(i_native_surface& aSurface)
+	{
+		auto c = iContexts.find(&aSurface);
+		if (c == iContexts.end())
+			throw context_not_found();
+		context_destroyed(c->second.handle);
+#ifdef WIN32
+		SDL_GL_DeleteContext(static_cast<SDL_GLContext>(c->second.handle));
+		SDL_DestroyWindow(static_cast<SDL_Window*>(c->second.surface));
+#else
+		if (eglGetCurrentContext() == c->second.handle)
+			eglMakeCurrent(iDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		eglDestroyContext(iDisplay, c->second.handle);
+		eglDestroySurface(iDisplay, c->second.surface);
+#endif
+		iContexts.erase(c);
+	}
+
+	std::unique_ptr<i_native_window> offscreen_renderer::create_window(i_surface_manager& aSurfaceManager, i_native_window_event_handler& aEventHandler, const video_mode& aVideoMode, const std::string&, window::style_e aStyle)
+	{
+		neolib::scoped_counter sc(iCreatingWindow);
+		return std::unique_ptr<i_native_window>(new offscreen_window(*this, aSurfaceManager, aEventHandler, point{}, size{ static_cast<dimension>(aVideoMode.width()), static_cast<dimension>(aVideoMode.height()) }, aStyle));
+	}
+
+	std::unique_ptr<i_native_window> offscreen_renderer::create_window(i_surface_manager& aSurfaceManager, i_native_window_event_handler& aEventHandler, const size& aDimensions, const std::string&, window::style_e aStyle)
+	{
+		neolib::scoped_counter sc(iCreatingWindow);
+		return std::unique_ptr<i_native_window>(new offscreen_window(*this, aSurfaceManager, aEventHandler, point{}, aDimensions, aStyle));
+	}
+
+	std::unique_ptr<i_native_window> offscreen_renderer::create_window(i_surface_manager& aSurfaceManager, i_native_window_event_handler& aEventHandler, const point& aPosition, const size& aDimensions, const std::string&, window::style_e aStyle)
+	{
+		neolib::scoped_counter sc(iCreatingWindow);
+		return std::unique_ptr<i_native_window>(new offscreen_window(*this, aSurfaceManager, aEventHandler, aPosition, aDimensions, aStyle));
+	}
+
+	std::unique_ptr<i_native_window> offscreen_renderer::create_window(i_surface_manager& aSurfaceManager, i_native_window_event_handler& aEventHandler, i_native_surface&, const video_mode& aVideoMode, const std::string& aWindowTitle, window::style_e aStyle)
+	{
+		return create_window(aSurfaceManager, aEventHandler, aVideoMode, aWindowTitle, aStyle);
+	}
+
+	std::unique_ptr<i_native_window> offscreen_renderer::create_window(i_surface_manager& aSurfaceManager, i_native_window_event_handler& aEventHandler, i_native_surface&, const size& aDimensions, const std::string& aWindowTitle, window::style_e aStyle)
+	{
+		return create_window(aSurfaceManager, aEventHandler, aDimensions, aWindowTitle, aStyle);
+	}
+
+	std::unique_ptr<i_native_window> offscreen_renderer::create_window(i_surface_manager& aSurfaceManager, i_native_window_event_handler& aEventHandler, i_native_surface&, const point& aPosition, const size& aDimensions, const std::string& aWindowTitle, window::style_e aStyle)
+	{
+		return create_window(aSurfaceManager, aEventHandler, aPosition, aDimensions, aWindowTitle, aStyle);
+	}
+
+	bool offscreen_renderer::creating_window() const
+	{
+		return iCreatingWindow != 0;
+	}
+
+	void offscreen_renderer::render_now()
+	{
+		app::instance().surface_manager().render_surfaces();
+	}
+
+	bool offscreen_renderer::process_events()
+	{
+		return false;
+	}
+
+	void offscreen_renderer::wait_for_events(frame_scheduler::duration aTimeout)
+	{
+		// there is no event source when headless so there is nothing to wake us early
+		std::this_thread::sleep_for(aTimeout);
+	}
+
+	void offscreen_renderer::activate_context(i_native_surface& aSurface)
+	{
+		auto c = iContexts.find(&aSurface);
+		if (c == iContexts.end())
+			throw context_not_found();
+#ifdef WIN32
+		if (SDL_GL_MakeCurrent(static_cast<SDL_Window*>(c->second.surface), static_cast<SDL_GLContext>(c->second.handle)) != 0)
+			throw failed_to_activate_opengl_context(SDL_GetError());
+#else
+		if (!eglMakeCurrent(iDisplay, c->second.surface, c->second.surface, c->second.handle))
+			throw failed_to_activate_opengl_context(egl_error());
+#endif
+		context_activated(c->second.handle);
+	}
+}
@@ -0,0 +1,242 @@
+// offscreen_window.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "neogfx.hpp"
+#include "offscreen_graphics_context.hpp"
+#include "offscreen_window.hpp"
+
+namespace neogfx
+{
+	offscreen_window::offscreen_window(offscreen_renderer& aRenderingEngine, i_surface_manager& aSurfaceManager, i_native_window_event_handler& aEventHandler, const point& aPosition, const size& aDimensions, window::style_e aStyle) :
+		opengl_window(aRenderingEngine, aSurfaceManager, aEventHandler),
+		iRenderingEngine(aRenderingEngine),
+		iContext(0),
+		iPosition(aPosition),
+		iExtents(aDimensions),
+		iVisible(false),
+		iActive(false),
+		iDestroyed(false)
+	{
+		iContext = aRenderingEngine.create_context(*this);
+
+		do_activate_context();
+
+		if ((aStyle & window::InitiallyHidden) != window::InitiallyHidden)
+			show((aStyle & window::NoActivate) != window::NoActivate);
+	}
+
+	offscreen_window::~offscreen_window()
+	{
+		close();
+		rendering_engine().destroy_context(*this);
+	}
+
+	void* offscreen_window::handle() const
+	{
+		return const_cast<offscreen_window*>(this);
+	}
+
+	void* offscreen_window::native_handle() const
+	{
+		return const_cast<offscreen_window*>(this);
+	}
+
+	void* offscreen_window::native_context() const
+	{
+		return iContext;
+	}
+
+	point offscreen_window::surface_position() const
+	{
+		return iPosition;
+	}
+
+	void offscreen_window::move_surface(const point& aPosition)
+	{
+		iPosition = aPosition;
+	}
+
+	size offscreen_window::surface_size() const
+	{
+		return iExtents;
+	}
+
+	void offscreen_window::resize_surface(const size& aSize)
+	{
+		iExtents = aSize;
+	}
+
+	point offscreen_window::mouse_position() const
+	{
+		return point{};
+	}
+
+	bool offscreen_window::is_mouse_button_pressed(mouse_button) const
+	{
+		return false;
+	}
+
+	void offscreen_window::save_mouse_cursor()
+	{
+	}
+
+	void offscreen_window::set_mouse_cursor(mouse_system_cursor)
+	{
+	}
+
+	void offscreen_window::restore_mouse_cursor()
+	{
+	}
+
+	void offscreen_window::set_threaded_presentation(bool)
+	{
+		// nothing is presented so there is nothing to hand over to another thread
+	}
+
+	std::unique_ptr<i_native_graphics_context> offscreen_window::create_graphics_context() const
+	{
+		return std::unique_ptr<i_native_graphics_context>(new offscreen_graphics_context(rendering_engine(), *this));
+	}
+
+	std::unique_ptr<i_native_graphics_context> offscreen_window::create_graphics_context(const i_widget& aWidget) const
+	{
+		return std::unique_ptr<i_native_graphics_context>(new offscreen_graphics_context(rendering_engine(), *this, aWidget));
+	}
+
+	dimension offscreen_window::horizontal_dpi() const
+	{
+		return 96.0;
+	}
+
+	dimension offscreen_window::vertical_dpi() const
+	{
+		return 96.0;
+	}
+
+	void offscreen_window::close()
+	{
+		if (!iDestroyed)
+		{
+			event_handler().native_window_closing();
+			destroying();
+			iDestroyed = true;
+			destroyed();
+			event_handler().native_window_closed();
+		}
+	}
+
+	void offscreen_window::show(bool aActivate)
+	{
+		iVisible = true;
+		if (aActivate)
+			activate();
+	}
+
+	void offscreen_window::hide()
+	{
+		iVisible = false;
+		iActive = false;
+	}
+
+	bool offscreen_window::is_active() const
+	{
+		return iActive;
+	}
+
+	void offscreen_window::activate()
+	{
+		iActive = true;
+	}
+
+	void offscreen_window::enable(bool)
+	{
+	}
+
+	void offscreen_window::set_capture()
+	{
+	}
+
+	void offscreen_window::release_capture()
+	{
+	}
+
+	bool offscreen_window::is_destroyed() const
+	{
+		return iDestroyed;
+	}
+
+	void offscreen_window::activate_context() const
+	{
+		if (context_activation_stack().empty() || context_activation_stack().back() != this)
+			do_activate_context();
+		context_activation_stack().push_back(this);
+	}
+
+	void offscreen_window::deactivate_context() const
+	{
+		if (context_activation_stack().empty() || context_activation_stack().back() != this)
+			throw context_mismatch();
+		context_activation_stack().pop_back();
+		if (!context_activation_stack().empty() && context_activation_stack().back() != this)
+			context_activation_stack().back()->do_activate_context();
+	}
+
+	void offscreen_window::do_activate_context() const
+	{
+		iRenderingEngine.activate_context(const_cast<offscreen_window&>(*this));
+	}
+
+	std::deque<const offscreen_window*>& offscreen_window::context_activation_stack()
+	{
+		static std::deque<const offscreen_window*> sStack;
+		return sStack;
+	}
+
+	bool offscreen_window::partial_present() const
+	{
+		return false;
+	}
+
+	void offscreen_window::display(const size&, const std::vector<rect>&)
+	{
+	}
+
+	boost::optional<uint32_t> offscreen_window::vertical_sync_rate() const
+	{
+		return boost::none;
+	}
+
+	void* offscreen_window::create_presentation_context()
+	{
+		return 0;
+	}
+
+	void offscreen_window::make_presentation_context_current(void*)
+	{
+	}
+
+	void offscreen_window::destroy_presentation_context(void*)
+	{
+	}
+
+	bool offscreen_window::processing_event() const
+	{
+		return false;
+	}
+}
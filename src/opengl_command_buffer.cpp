@@ -0,0 +1,288 @@
+// opengl_command_buffer.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "neogfx.hpp"
+#include "opengl_command_buffer.hpp"
+
+namespace neogfx
+{
+	namespace
+	{
+		// how many batches to look back through when searching for one with matching state
+		const std::size_t MAX_BATCH_LOOKBACK = 32;
+
+		inline bool overlaps(const rect& aLeft, const rect& aRight)
+		{
+			return aLeft.left() < aRight.right() && aRight.left() < aLeft.right() &&
+				aLeft.top() < aRight.bottom() && aRight.top() < aLeft.bottom();
+		}
+
+		template <typename Iter>
+		inline rect vertex_bounds(Iter aFirst, Iter aLast)
+		{
+			point topLeft{ aFirst->xy[0], aFirst->xy[1] };
+			point bottomRight = topLeft;
+			for (Iter v = aFirst; v != aLast; ++v)
+			{
+				topLeft.x = std::min<coordinate>(topLeft.x, v->xy[0]);
+				topLeft.y = std::min<coordinate>(topLeft.y, v->xy[1]);
+				bottomRight.x = std::max<coordinate>(bottomRight.x, v->xy[0]);
+				bottomRight.y = std::max<coordinate>(bottomRight.y, v->xy[1]);
+			}
+			return rect{ topLeft, bottomRight };
+		}
+
+		template <typename Commands, typename Vertices>
+		inline void gather(const Commands& aCommands, std::size_t aFirstCommand, const Vertices& aSource, Vertices& aDestination)
+		{
+			for (std::size_t c = aFirstCommand; c != static_cast<std::size_t>(-1); c = aCommands[c].next)
+				aDestination.insert(aDestination.end(), aSource.begin() + aCommands[c].first, aSource.begin() + aCommands[c].first + aCommands[c].count);
+		}
+	}
+
+	opengl_command_buffer::opengl_command_buffer() :
+		iScissors(1)
+	{
+	}
+
+	bool opengl_command_buffer::empty() const
+	{
+		return iCommands.empty();
+	}
+
+	void opengl_command_buffer::clear()
+	{
+		iScissors.resize(1);
+		iCommands.clear();
+		iVertices.clear();
+		iShapes.clear();
+	}
+
+	std::size_t opengl_command_buffer::add_scissor(const rect& aScissorRect)
+	{
+		if (iScissors.size() == 1 || iScissors.back() != aScissorRect)
+			iScissors.push_back(aScissorRect);
+		return iScissors.size() - 1;
+	}
+
+	const rect& opengl_command_buffer::scissor(std::size_t aScissor) const
+	{
+		return iScissors[aScissor];
+	}
+
+	void opengl_command_buffer::add(const render_state& aState, const vertex* aFirst, const vertex* aLast, const boost::optional<line_stipple>& aStipple)
+	{
+		std::size_t count = aLast - aFirst;
+		if (count == 0)
+			return;
+		render_state state = aState;
+		std::size_t first = iVertices.size();
+		switch (aState.mode)
+		{
+		case GL_TRIANGLE_FAN:
+			state.mode = GL_TRIANGLES;
+			for (std::size_t i = 1; i + 1 < count; ++i)
+			{
+				iVertices.push_back(aFirst[0]);
+				iVertices.push_back(aFirst[i]);
+				iVertices.push_back(aFirst[i + 1]);
+			}
+			break;
+		case GL_QUADS:
+			state.mode = GL_TRIANGLES;
+			for (std::size_t i = 0; i + 3 < count; i += 4)
+			{
+				iVertices.push_back(aFirst[i]);
+				iVertices.push_back(aFirst[i + 1]);
+				iVertices.push_back(aFirst[i + 2]);
+				iVertices.push_back(aFirst[i]);
+				iVertices.push_back(aFirst[i + 2]);
+				iVertices.push_back(aFirst[i + 3]);
+			}
+			break;
+		case GL_LINES:
+		case GL_LINE_LOOP:
+		case GL_LINE_STRIP:
+			{
+				state.mode = GL_TRIANGLES;
+				dimension width = std::max<dimension>(aState.lineWidth, 1.0);
+				// the stipple pattern restarts with each independent line but carries on along a strip or loop
+				coordinate stippleDistance = 0.0;
+				if (aState.mode == GL_LINES)
+				{
+					for (std::size_t i = 0; i + 1 < count; i += 2)
+					{
+						stippleDistance = 0.0;
+						add_line(aFirst[i], aFirst[i + 1], width, aStipple, stippleDistance);
+					}
+				}
+				else
+				{
+					for (std::size_t i = 0; i + 1 < count; ++i)
+						add_line(aFirst[i], aFirst[i + 1], width, aStipple, stippleDistance);
+					if (aState.mode == GL_LINE_LOOP && count > 2)
+						add_line(aFirst[count - 1], aFirst[0], width, aStipple, stippleDistance);
+				}
+			}
+			break;
+		default:
+			iVertices.insert(iVertices.end(), aFirst, aLast);
+			break;
+		}
+		if (iVertices.size() == first)
+			return;
+		// lines have been turned into triangles that cover their width
+		state.lineWidth = 0.0;
+		rect bounds = vertex_bounds(iVertices.begin() + first, iVertices.end());
+		bounds.inflate(1.0, 1.0);
+		add_command(state, first, iVertices.size() - first, bounds);
+	}
+
+	void opengl_command_buffer::add(const render_state& aState, const shape& aShape)
+	{
+		render_state state = aState;
+		state.mode = GL_TRIANGLES;
+		state.lineWidth = 0.0;
+		coordinate margin = aShape.parameters[1] / 2.0 + 2.0;
+		rect bounds{ 
+			point{ aShape.rect[0] - aShape.rect[2] - margin, aShape.rect[1] - aShape.rect[3] - margin }, 
+			size{ (aShape.rect[2] + margin) * 2.0, (aShape.rect[3] + margin) * 2.0 } };
+		iShapes.push_back(aShape);
+		add_command(state, iShapes.size() - 1, 1, bounds);
+	}
+
+	const opengl_command_buffer::batch_list& opengl_command_buffer::build_batches()
+	{
+		iPendingBatches.clear();
+		for (std::size_t i = 0; i < iCommands.size(); ++i)
+		{
+			auto& c = iCommands[i];
+			pending_batch* target = nullptr;
+			std::size_t lookback = 0;
+			for (auto b = iPendingBatches.rbegin(); b != iPendingBatches.rend() && lookback < MAX_BATCH_LOOKBACK; ++b, ++lookback)
+			{
+				if (b->state == c.state)
+				{
+					target = &*b;
+					break;
+				}
+				if (overlaps(b->bounds, c.bounds))
+					break;
+			}
+			if (target != nullptr)
+			{
+				iCommands[target->lastCommand].next = i;
+				target->lastCommand = i;
+				target->bounds = target->bounds.combine(c.bounds);
+			}
+			else
+				iPendingBatches.push_back(pending_batch{ c.state, c.bounds, i, i });
+		}
+		iBatches.clear();
+		iBatchedVertices.clear();
+		iBatchedShapes.clear();
+		for (const auto& pb : iPendingBatches)
+		{
+			if (is_shape(pb.state))
+			{
+				std::size_t first = iBatchedShapes.size();
+				gather(iCommands, pb.firstCommand, iShapes, iBatchedShapes);
+				iBatches.push_back(batch{ pb.state, first, iBatchedShapes.size() - first });
+			}
+			else
+			{
+				std::size_t first = iBatchedVertices.size();
+				gather(iCommands, pb.firstCommand, iVertices, iBatchedVertices);
+				iBatches.push_back(batch{ pb.state, first, iBatchedVertices.size() - first });
+			}
+		}
+		return iBatches;
+	}
+
+	const opengl_command_buffer::vertices_t& opengl_command_buffer::vertices() const
+	{
+		return iBatchedVertices;
+	}
+
+	const opengl_command_buffer::shapes_t& opengl_command_buffer::shapes() const
+	{
+		return iBatchedShapes;
+	}
+
+	bool opengl_command_buffer::is_shape(const render_state& aState)
+	{
+		return aState.kind == Shape || aState.kind == Gradient;
+	}
+
+	void opengl_command_buffer::add_command(const render_state& aState, std::size_t aFirst, std::size_t aCount, const rect& aBounds)
+	{
+		iCommands.push_back(command{ aState, aFirst, aCount, aBounds, command::npos });
+	}
+
+	void opengl_command_buffer::add_line(const vertex& aFrom, const vertex& aTo, dimension aWidth, const boost::optional<line_stipple>& aStipple, coordinate& aStippleDistance)
+	{
+		coordinate dx = aTo.xy[0] - aFrom.xy[0];
+		coordinate dy = aTo.xy[1] - aFrom.xy[1];
+		coordinate length = std::sqrt(dx * dx + dy * dy);
+		if (length == 0.0)
+			return;
+		point direction{ dx / length, dy / length };
+		point normal{ -direction.y * aWidth / 2.0, direction.x * aWidth / 2.0 };
+		auto dash = [&](coordinate aStart, coordinate aEnd)
+		{
+			point start{ aFrom.xy[0] + direction.x * aStart, aFrom.xy[1] + direction.y * aStart };
+			point end{ aFrom.xy[0] + direction.x * aEnd, aFrom.xy[1] + direction.y * aEnd };
+			auto corner = [&aFrom, &normal](const point& aPoint, coordinate aSide)
+			{
+				vertex result = aFrom;
+				result.xy = {{ static_cast<GLfloat>(aPoint.x + normal.x * aSide), static_cast<GLfloat>(aPoint.y + normal.y * aSide) }};
+				return result;
+			};
+			vertex a = corner(start, 1.0);
+			vertex b = corner(end, 1.0);
+			vertex c = corner(end, -1.0);
+			vertex d = corner(start, -1.0);
+			iVertices.insert(iVertices.end(), { a, b, c, a, c, d });
+		};
+		if (aStipple == boost::none)
+		{
+			dash(0.0, length);
+			return;
+		}
+		// each bit of the pattern, least significant first, covers factor pixels along the line
+		coordinate factor = static_cast<coordinate>(std::max<uint32_t>(aStipple->factor, 1));
+		boost::optional<coordinate> dashStart;
+		for (coordinate position = 0.0; position < length;)
+		{
+			coordinate bit = std::floor((aStippleDistance + position) / factor);
+			bool on = (aStipple->pattern & (1u << (static_cast<uint32_t>(bit) % 16u))) != 0;
+			if (on && dashStart == boost::none)
+				dashStart = position;
+			else if (!on && dashStart != boost::none)
+			{
+				dash(*dashStart, position);
+				dashStart = boost::none;
+			}
+			position = std::max(std::min((bit + 1.0) * factor - aStippleDistance, length), position + 0.0001);
+		}
+		if (dashStart != boost::none)
+			dash(*dashStart, length);
+		aStippleDistance += length;
+	}
+}
@@ -0,0 +1,146 @@
+// opengl_gradient_cache.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "neogfx.hpp"
+#include "opengl_error.hpp"
+#include "opengl_state.hpp"
+#include "opengl_gradient_cache.hpp"
+
+namespace neogfx
+{
+	opengl_gradient_cache::opengl_gradient_cache(uint32_t aCapacity) :
+		iCapacity(aCapacity), iTexture(0), iHits(0), iMisses(0)
+	{
+	}
+
+	opengl_gradient_cache::~opengl_gradient_cache()
+	{
+		if (iTexture != 0)
+		{
+			glDeleteTextures(1, &iTexture);
+			opengl_state::texture_deleted(iTexture);
+		}
+	}
+
+	uint32_t opengl_gradient_cache::row(const gradient& aGradient)
+	{
+		key_type gradientKey = key(aGradient);
+		auto existing = iIndex.find(gradientKey);
+		if (existing != iIndex.end())
+		{
+			++iHits;
+			iEntries.splice(iEntries.begin(), iEntries, existing->second);
+			return existing->second->second;
+		}
+		++iMisses;
+		uint32_t newRow = static_cast<uint32_t>(iEntries.size());
+		if (full())
+		{
+			newRow = iEntries.back().second;
+			iIndex.erase(iEntries.back().first);
+			iEntries.pop_back();
+		}
+		upload(newRow, aGradient);
+		iEntries.emplace_front(gradientKey, newRow);
+		iIndex[gradientKey] = iEntries.begin();
+		return newRow;
+	}
+
+	bool opengl_gradient_cache::contains(const gradient& aGradient) const
+	{
+		return iIndex.find(key(aGradient)) != iIndex.end();
+	}
+
+	void opengl_gradient_cache::clear()
+	{
+		iEntries.clear();
+		iIndex.clear();
+	}
+
+	GLuint opengl_gradient_cache::texture() const
+	{
+		return iTexture;
+	}
+
+	uint32_t opengl_gradient_cache::size() const
+	{
+		return static_cast<uint32_t>(iEntries.size());
+	}
+
+	uint32_t opengl_gradient_cache::capacity() const
+	{
+		return iCapacity;
+	}
+
+	bool opengl_gradient_cache::full() const
+	{
+		return size() >= capacity();
+	}
+
+	uint64_t opengl_gradient_cache::hits() const
+	{
+		return iHits;
+	}
+
+	uint64_t opengl_gradient_cache::misses() const
+	{
+		return iMisses;
+	}
+
+	void opengl_gradient_cache::reset_counters()
+	{
+		iHits = 0;
+		iMisses = 0;
+	}
+
+	opengl_gradient_cache::key_type opengl_gradient_cache::key(const gradient& aGradient)
+	{
+		key_type result;
+		result.reserve(aGradient.colour_stops().size());
+		for (const auto& s : aGradient.colour_stops())
+			result.emplace_back(s.first, s.second.value());
+		return result;
+	}
+
+	void opengl_gradient_cache::upload(uint32_t aRow, const gradient& aGradient)
+	{
+		if (iTexture == 0)
+		{
+			glCheck(glGenTextures(1, &iTexture));
+			opengl_state::current().bind_texture(iTexture);
+			glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+			glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+			glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+			glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+			glCheck(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, static_cast<GLsizei>(LookupTableWidth), static_cast<GLsizei>(iCapacity), 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL));
+		}
+		else
+			opengl_state::current().bind_texture(iTexture);
+		std::array<uint8_t, LookupTableWidth * 4> texels;
+		for (uint32_t i = 0; i < LookupTableWidth; ++i)
+		{
+			colour c = aGradient.at(static_cast<double>(i) / (LookupTableWidth - 1));
+			texels[i * 4 + 0] = c.red();
+			texels[i * 4 + 1] = c.green();
+			texels[i * 4 + 2] = c.blue();
+			texels[i * 4 + 3] = c.alpha();
+		}
+		glCheck(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, static_cast<GLint>(aRow), static_cast<GLsizei>(LookupTableWidth), 1, GL_RGBA, GL_UNSIGNED_BYTE, &texels[0]));
+	}
+}
@@ -22,7 +22,7 @@
 #include "glyph.hpp"
 #include "i_rendering_engine.hpp"
 #include "opengl_graphics_context.hpp"
-#include "text_direction_map.hpp"
+#include "opengl_command_buffer.hpp"
 #include "i_native_font_face.hpp"
 #include "native_font_face.hpp"
 #include "i_font_texture.hpp"
@@ -55,82 +55,110 @@ namespace neogfx
 			return path_shape_to_gl_mode(aPath.shape());
 		}
 
-		inline std::vector<GLdouble> arc_vertices(const point& aCentre, dimension aRadius, angle aStartAngle, angle aEndAngle, bool aIncludeCentre)
+		typedef opengl_command_buffer::vertex vertex;
+		typedef opengl_command_buffer::vertices_t vertices_t;
+
+		inline vertex make_vertex(coordinate aX, coordinate aY, const std::array<uint8_t, 4>& aRgba = std::array<uint8_t, 4>{}, GLfloat aS = 0.0f, GLfloat aT = 0.0f)
 		{
-			std::vector<GLdouble> result;
-			uint32_t segments = static_cast<uint32_t>(20 * std::sqrt(aRadius));
-			result.reserve((segments + (aIncludeCentre ? 2 : 1)) * 2);
-			if (aIncludeCentre)
-			{
-				result.push_back(aCentre.x);
-				result.push_back(aCentre.y);
-			}
-			coordinate theta = (aEndAngle - aStartAngle) / static_cast<coordinate>(segments);
-			coordinate c = std::cos(theta);
-			coordinate s = std::sin(theta);
-			auto startCoordinate = mat22{ { std::cos(aStartAngle), std::sin(aStartAngle) },{ -std::sin(aStartAngle), std::cos(aStartAngle) } } *
-				vec2{ aRadius, 0.0 };
-			coordinate x = startCoordinate.x;
-			coordinate y = startCoordinate.y;
-			for (uint32_t i = 0; i < segments; ++i)
-			{
-				result.push_back(x + aCentre.x);
-				result.push_back(y + aCentre.y);
-				coordinate t = x;
-				x = c * x - s * y;
-				y = s * t + c * y;
-			}
-			return result;
+			return vertex{ {{static_cast<GLfloat>(aX), static_cast<GLfloat>(aY)}}, aRgba, {{aS, aT}} };
 		}
 
-		inline std::vector<GLdouble> circle_vertices(const point& aCentre, dimension aRadius, bool aIncludeCentre)
+		inline vertex make_vertex(const point& aPoint, const std::array<uint8_t, 4>& aRgba = std::array<uint8_t, 4>{}, GLfloat aS = 0.0f, GLfloat aT = 0.0f)
 		{
-			auto result = arc_vertices(aCentre, aRadius, 0, boost::math::constants::two_pi<coordinate>(), aIncludeCentre);
-			result.push_back(result[aIncludeCentre ? 2 : 0]);
-			result.push_back(result[aIncludeCentre ? 3 : 1]);
-			return result;
+			return make_vertex(aPoint.x, aPoint.y, aRgba, aS, aT);
+		}
+
+		inline std::array<uint8_t, 4> to_rgba(const colour& aColour)
+		{
+			return std::array<uint8_t, 4>{{aColour.red(), aColour.green(), aColour.blue(), aColour.alpha()}};
+		}
+
+		inline void close_loop(vertices_t& aVertices, std::size_t aFirst)
+		{
+			vertex first = aVertices[aFirst];
+			aVertices.push_back(first);
+		}
+
+		inline void arc_vertices(vertices_t& aResult, tessellation_cache& aCache, const point& aCentre, dimension aRadius, angle aStartAngle, angle aEndAngle, bool aIncludeCentre)
+		{
+			const auto& arc = aCache.arc(aRadius, aStartAngle, aEndAngle, aIncludeCentre);
+			aResult.reserve(aResult.size() + arc.size() + 1);
+			for (const auto& v : arc)
+				aResult.push_back(make_vertex(v.x + aCentre.x, v.y + aCentre.y));
+		}
+
+		inline void circle_vertices(vertices_t& aResult, tessellation_cache& aCache, const point& aCentre, dimension aRadius, bool aIncludeCentre)
+		{
+			std::size_t first = aResult.size();
+			arc_vertices(aResult, aCache, aCentre, aRadius, 0, boost::math::constants::two_pi<coordinate>(), aIncludeCentre);
+			close_loop(aResult, first + (aIncludeCentre ? 1 : 0));
 		}
 
-		inline std::vector<GLdouble> rounded_rect_vertices(const rect& aRect, dimension aRadius, bool aIncludeCentre)
+		inline void rounded_rect_vertices(vertices_t& aResult, tessellation_cache& aCache, const rect& aRect, dimension aRadius, bool aIncludeCentre)
 		{
-			std::vector<GLdouble> result;
-			auto topLeft = arc_vertices(
+			std::size_t first = aResult.size();
+			if (aIncludeCentre)
+				aResult.push_back(make_vertex(aRect.centre()));
+			arc_vertices(aResult, aCache,
 				aRect.top_left() + point{ aRadius, aRadius },
 				aRadius,
 				boost::math::constants::pi<coordinate>(),
 				boost::math::constants::pi<coordinate>() * 1.5,
 				false);
-			auto topRight = arc_vertices(
+			arc_vertices(aResult, aCache,
 				aRect.top_right() + point{ -aRadius, aRadius },
 				aRadius,
 				boost::math::constants::pi<coordinate>() * 1.5,
 				boost::math::constants::pi<coordinate>() * 2.0,
 				false);
-			auto bottomRight = arc_vertices(
+			arc_vertices(aResult, aCache,
 				aRect.bottom_right() + point{ -aRadius, -aRadius },
 				aRadius,
 				0.0,
 				boost::math::constants::pi<coordinate>() * 0.5,
 				false);
-			auto bottomLeft = arc_vertices(
+			arc_vertices(aResult, aCache,
 				aRect.bottom_left() + point{ aRadius, -aRadius },
 				aRadius,
 				boost::math::constants::pi<coordinate>() * 0.5,
 				boost::math::constants::pi<coordinate>(),
 				false);
-			result.reserve(topLeft.size() + topRight.size() + bottomRight.size() + bottomLeft.size() + (aIncludeCentre ? 2 : 1));
+			close_loop(aResult, first + (aIncludeCentre ? 1 : 0));
+		}
+
+		inline void rect_vertices(vertices_t& aResult, const rect& aRect, bool aIncludeCentre)
+		{
 			if (aIncludeCentre)
-			{
-				result.push_back(aRect.centre().x);
-				result.push_back(aRect.centre().y);
-			}
-			result.insert(result.end(), topLeft.begin(), topLeft.end());
-			result.insert(result.end(), topRight.begin(), topRight.end());
-			result.insert(result.end(), bottomRight.begin(), bottomRight.end());
-			result.insert(result.end(), bottomLeft.begin(), bottomLeft.end());
-			result.push_back(result[aIncludeCentre ? 2 : 0]);
-			result.push_back(result[aIncludeCentre ? 3 : 1]);
-			return result;
+				aResult.push_back(make_vertex(aRect.centre()));
+			aResult.push_back(make_vertex(aRect.top_left()));
+			aResult.push_back(make_vertex(aRect.top_right()));
+			aResult.push_back(make_vertex(aRect.bottom_right()));
+			aResult.push_back(make_vertex(aRect.bottom_left()));
+			if (aIncludeCentre)
+				aResult.push_back(make_vertex(aRect.top_left()));
+		}
+
+		inline void path_vertices(vertices_t& aResult, const std::vector<coordinate>& aCoordinates)
+		{
+			aResult.reserve(aResult.size() + aCoordinates.size() / 2);
+			for (std::size_t i = 0; i + 1 < aCoordinates.size(); i += 2)
+				aResult.push_back(make_vertex(aCoordinates[i], aCoordinates[i + 1]));
+		}
+
+		// an analytic shape is drawn as a quad around it, grown to cover its outline and anti-aliased edge, for which the 
+		// fragment shader computes edge coverage from the shape's signed distance function
+		inline opengl_command_buffer::shape make_shape(const rect& aShape, dimension aRadius, dimension aOutlineWidth, const std::array<uint8_t, 4>& aRgba)
+		{
+			point centre = aShape.centre();
+			return opengl_command_buffer::shape{
+				{{ static_cast<GLfloat>(centre.x), static_cast<GLfloat>(centre.y), static_cast<GLfloat>(aShape.cx / 2.0), static_cast<GLfloat>(aShape.cy / 2.0) }},
+				aRgba,
+				{{ static_cast<GLfloat>(std::min(aRadius, std::min(aShape.cx, aShape.cy) / 2.0)), static_cast<GLfloat>(aOutlineWidth) }} };
+		}
+
+		inline rect circle_bounds(const point& aCentre, dimension aRadius)
+		{
+			return rect{ aCentre - point{ aRadius, aRadius }, size{ aRadius * 2.0, aRadius * 2.0 } };
 		}
 
 		inline double pixel_adjust(const dimension aWidth)
@@ -143,22 +171,92 @@ namespace neogfx
 			return pixel_adjust(aPen.width());
 		}
 
-		inline std::vector<GLdouble> line_loop_to_lines(const std::vector<GLdouble>& aLineLoop)
+		typedef std::vector<point> polyline;
+
+		inline polyline to_polyline(const vertices_t& aVertices, std::size_t aFirst, bool aClosed)
+		{
+			polyline result;
+			for (auto v = aVertices.begin() + aFirst; v != aVertices.end(); ++v)
+			{
+				point p{ v->xy[0], v->xy[1] };
+				if (result.empty() || result.back() != p)
+					result.push_back(p);
+			}
+			if (aClosed && result.size() > 1 && result.front() == result.back())
+				result.pop_back();
+			return result;
+		}
+
+		inline coordinate signed_area(const polyline& aPolygon)
+		{
+			coordinate result = 0.0;
+			for (std::size_t i = 0; i < aPolygon.size(); ++i)
+			{
+				const point& p = aPolygon[i];
+				const point& q = aPolygon[(i + 1) % aPolygon.size()];
+				result += p.x * q.y - q.x * p.y;
+			}
+			return result / 2.0;
+		}
+
+		// mitred vertex normals; for a closed polyline they point out of the polygon it encloses
+		inline polyline vertex_normals(const polyline& aPolyline, bool aClosed)
 		{
-			std::vector<GLdouble> result;
-			result.reserve(aLineLoop.size() * 2);
-			for (auto v = aLineLoop.begin(); v != aLineLoop.end(); v += 2)
+			std::size_t n = aPolyline.size();
+			auto edge_normal = [&aPolyline](std::size_t aFrom, std::size_t aTo)
 			{
-				result.push_back(*v);
-				result.push_back(*(v + 1));
-				if (v != aLineLoop.begin() && v != aLineLoop.end() - 2)
+				point d = aPolyline[aTo] - aPolyline[aFrom];
+				coordinate length = std::sqrt(d.x * d.x + d.y * d.y);
+				return point{ d.y / length, -d.x / length };
+			};
+			coordinate orientation = aClosed && signed_area(aPolyline) < 0.0 ? -1.0 : 1.0;
+			polyline result(n);
+			for (std::size_t i = 0; i < n; ++i)
+			{
+				bool hasPrevious = aClosed || i > 0;
+				bool hasNext = aClosed || i + 1 < n;
+				point normal;
+				if (!hasPrevious)
+					normal = edge_normal(i, i + 1);
+				else if (!hasNext)
+					normal = edge_normal(i - 1, i);
+				else
 				{
-					result.push_back(*v);
-					result.push_back(*(v + 1));
+					point previous = edge_normal((i + n - 1) % n, i);
+					point next = edge_normal(i, (i + 1) % n);
+					point miter = previous + next;
+					coordinate length = std::sqrt(miter.x * miter.x + miter.y * miter.y);
+					if (length < 0.0001)
+						normal = next;
+					else
+					{
+						// limit the miter to twice the offset
+						coordinate cosine = std::max<coordinate>((miter.x * next.x + miter.y * next.y) / length, 0.5);
+						normal = point{ miter.x / length / cosine, miter.y / length / cosine };
+					}
 				}
+				result[i] = point{ normal.x * orientation, normal.y * orientation };
 			}
 			return result;
 		}
+
+		// triangles covering the band between two offsets along the vertex normals of a polyline, the vertex colours 
+		// of each side of the band being given separately
+		inline void band_vertices(vertices_t& aResult, const polyline& aPolyline, const polyline& aNormals, bool aClosed, 
+			coordinate aFrom, const std::array<uint8_t, 4>& aFromRgba, coordinate aTo, const std::array<uint8_t, 4>& aToRgba)
+		{
+			std::size_t n = aPolyline.size();
+			std::size_t edges = aClosed ? n : n - 1;
+			for (std::size_t i = 0; i < edges; ++i)
+			{
+				std::size_t j = (i + 1) % n;
+				vertex a = make_vertex(aPolyline[i].x + aNormals[i].x * aFrom, aPolyline[i].y + aNormals[i].y * aFrom, aFromRgba);
+				vertex b = make_vertex(aPolyline[j].x + aNormals[j].x * aFrom, aPolyline[j].y + aNormals[j].y * aFrom, aFromRgba);
+				vertex c = make_vertex(aPolyline[j].x + aNormals[j].x * aTo, aPolyline[j].y + aNormals[j].y * aTo, aToRgba);
+				vertex d = make_vertex(aPolyline[i].x + aNormals[i].x * aTo, aPolyline[i].y + aNormals[i].y * aTo, aToRgba);
+				aResult.insert(aResult.end(), { a, b, c, a, c, d });
+			}
+		}
 	}
 
 	opengl_graphics_context::opengl_graphics_context(i_rendering_engine& aRenderingEngine, const i_native_surface& aSurface) :
@@ -169,10 +267,13 @@ namespace neogfx
 		iLogicalCoordinates(aSurface.logical_coordinates()), 
 		iSmoothingMode(SmoothingModeNone), 
 		iMonochrome(false), 
-		iClipCounter(0),
-		iLineStippleActive(false)
+		iStencilDepth(0),
+		iScissor(opengl_command_buffer::NoScissor),
+		iRecording(0),
+		iDrawingGlyphs(false)
 	{
 		iSurface.activate_context();
+		iCommandBuffer = rendering_engine().allocate_command_buffer();
 		set_smoothing_mode(SmoothingModeAntiAlias);
 	}
 
@@ -184,10 +285,13 @@ namespace neogfx
 		iLogicalCoordinates(aSurface.logical_coordinates()),
 		iSmoothingMode(SmoothingModeNone), 
 		iMonochrome(false),
-		iClipCounter(0), 
-		iLineStippleActive(false)
+		iStencilDepth(0), 
+		iScissor(opengl_command_buffer::NoScissor),
+		iRecording(0),
+		iDrawingGlyphs(false)
 	{
 		iSurface.activate_context();
+		iCommandBuffer = rendering_engine().allocate_command_buffer();
 		set_smoothing_mode(SmoothingModeAntiAlias);
 	}
 
@@ -199,16 +303,21 @@ namespace neogfx
 		iLogicalCoordinates(aOther.iLogicalCoordinates),
 		iSmoothingMode(aOther.iSmoothingMode), 
 		iMonochrome(false),
-		iClipCounter(0),
-		iLineStippleActive(false)
+		iStencilDepth(0),
+		iScissor(opengl_command_buffer::NoScissor),
+		iRecording(0),
+		iDrawingGlyphs(false)
 	{
 		iSurface.activate_context();
+		iCommandBuffer = rendering_engine().allocate_command_buffer();
 		set_smoothing_mode(iSmoothingMode);
 	}
 
 	opengl_graphics_context::~opengl_graphics_context()
 	{
+		flush();
 		set_logical_coordinate_system(iSavedCoordinateSystem);
+		rendering_engine().free_command_buffer(std::move(iCommandBuffer));
 		iSurface.deactivate_context();
 	}
 
@@ -226,10 +335,8 @@ namespace neogfx
 	{
 		if (iLogicalCoordinateSystem != aSystem)
 		{
+			flush();
 			iLogicalCoordinateSystem = aSystem;
-			const auto& logicalCoordinates = logical_coordinates();
-			glCheck(glLoadIdentity());
-			glCheck(glOrtho(logicalCoordinates[0], logicalCoordinates[2], logicalCoordinates[1], logicalCoordinates[3], -1.0, 1.0));
 		}
 	}
 
@@ -251,36 +358,41 @@ namespace neogfx
 	{
 		if (iLogicalCoordinates != aCoordinates)
 		{
+			const_cast<opengl_graphics_context&>(*this).flush();
 			iLogicalCoordinates = aCoordinates;
-			const auto& logicalCoordinates = logical_coordinates();
-			glCheck(glLoadIdentity());
-			glCheck(glOrtho(logicalCoordinates[0], logicalCoordinates[2], logicalCoordinates[1], logicalCoordinates[3], -1.0, 1.0));
 		}
 	}
 
 	void opengl_graphics_context::flush()
 	{
+		if (iCommandBuffer->empty())
+			return;
+		replay();
+		iCommandBuffer->clear();
+		update_scissor();
+	}
+
+	void opengl_graphics_context::begin_recording()
+	{
+		++iRecording;
+	}
+
+	void opengl_graphics_context::end_recording()
+	{
+		if (--iRecording == 0)
+			flush();
 	}
 
 	void opengl_graphics_context::scissor_on(const rect& aRect)
 	{
-		if (iScissorRects.empty())
-		{
-			glCheck(glEnable(GL_SCISSOR_TEST));
-		}
 		iScissorRects.push_back(aRect);
-		apply_scissor();
+		update_scissor();
 	}
 
 	void opengl_graphics_context::scissor_off()
 	{
 		iScissorRects.pop_back();
-		if (iScissorRects.empty())
-		{
-			glCheck(glDisable(GL_SCISSOR_TEST));
-		}
-		else
-			apply_scissor();
+		update_scissor();
 	}
 
 	optional_rect opengl_graphics_context::scissor_rect() const
@@ -293,97 +405,137 @@ namespace neogfx
 		return result;
 	}
 
-	void opengl_graphics_context::apply_scissor()
+	void opengl_graphics_context::update_scissor()
 	{
-		GLint x = static_cast<GLint>(std::ceil(scissor_rect()->x));
-		GLint y = static_cast<GLint>(std::ceil(rendering_area(false).cy - scissor_rect()->cy - scissor_rect()->y));
-		GLsizei cx = static_cast<GLsizei>(std::ceil(scissor_rect()->cx));
-		GLsizei cy = static_cast<GLsizei>(std::ceil(scissor_rect()->cy));
-		glCheck(glScissor(x, y, cx, cy));
+		auto scissorRect = scissor_rect();
+		for (const auto& c : iClipStack)
+			if (c.scissor != boost::none)
+				scissorRect = scissorRect != boost::none ? scissorRect->intersection(*c.scissor) : *c.scissor;
+		iScissor = scissorRect != boost::none ? iCommandBuffer->add_scissor(*scissorRect) : opengl_command_buffer::NoScissor;
+	}
+
+	void opengl_graphics_context::apply_scissor(std::size_t aScissor)
+	{
+		if (aScissor == opengl_command_buffer::NoScissor)
+		{
+			rendering_engine().state().disable(GL_SCISSOR_TEST);
+			return;
+		}
+		const rect& scissorRect = iCommandBuffer->scissor(aScissor);
+		GLint x = static_cast<GLint>(std::ceil(scissorRect.x));
+		GLint y = static_cast<GLint>(std::ceil(surface().surface_size().cy - scissorRect.cy - scissorRect.y));
+		GLsizei cx = static_cast<GLsizei>(std::ceil(scissorRect.cx));
+		GLsizei cy = static_cast<GLsizei>(std::ceil(scissorRect.cy));
+		rendering_engine().state().enable(GL_SCISSOR_TEST);
+		rendering_engine().state().scissor(x, y, cx, cy);
 	}
 
 	void opengl_graphics_context::clip_to(const rect& aRect)
 	{
-		if (iClipCounter++ == 0)
+		// in GUI coordinates a rectangular clip is just another scissor rectangle
+		if (iLogicalCoordinateSystem == neogfx::logical_coordinate_system::AutomaticGui)
 		{
-			glCheck(glClear(GL_STENCIL_BUFFER_BIT));
-			glCheck(glEnable(GL_STENCIL_TEST));
+			iClipStack.push_back(clip{ aRect, rect{} });
+			update_scissor();
+			return;
 		}
-		glCheck(glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE));
-		glCheck(glDepthMask(GL_FALSE));
-		glCheck(glStencilOp(GL_REPLACE, GL_KEEP, GL_KEEP));  // draw 1s on test fail (always)
-		glCheck(glStencilMask(static_cast<GLuint>(-1)));
-		glCheck(glStencilFunc(GL_NEVER, 0, static_cast<GLuint>(-1)));
-		fill_rect(rendering_area(), colour::White);
-		glCheck(glStencilFunc(GL_NEVER, 1, static_cast<GLuint>(-1)));
-		fill_rect(aRect, colour::White);
-		glCheck(glStencilFunc(GL_NEVER, 1, static_cast<GLuint>(-1)));
-		glCheck(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
-		glCheck(glDepthMask(GL_TRUE));
-		glCheck(glStencilMask(0x00));
-		// draw only where stencil's value is 1
-		glCheck(glStencilFunc(GL_EQUAL, 1, static_cast<GLuint>(-1)));
+		clip_to(path{ aRect }, 0.0);
 	}
 
 	void opengl_graphics_context::clip_to(const path& aPath, dimension aPathOutline)
 	{
-		if (iClipCounter++ == 0)
+		flush();
+		auto& state = rendering_engine().state();
+		// each nested stencil clip increments the stencil value inside its path (and inside the enclosing clip) so
+		// the stencil buffer only needs clearing when the outermost clip is established
+		if (iStencilDepth++ == 0)
 		{
+			state.disable(GL_SCISSOR_TEST);
+			state.stencil_mask(static_cast<GLuint>(-1));
+			glCheck(glClearStencil(0));
 			glCheck(glClear(GL_STENCIL_BUFFER_BIT));
-			glCheck(glEnable(GL_STENCIL_TEST));
+			++state.counters().stencilClears;
+			state.enable(GL_STENCIL_TEST);
 		}
-		glCheck(glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE));
-		glCheck(glDepthMask(GL_FALSE));
-		glCheck(glStencilOp(GL_REPLACE, GL_KEEP, GL_KEEP));  // draw 1s on test fail (always)
-		glCheck(glStencilMask(static_cast<GLuint>(-1)));
-		glCheck(glStencilFunc(GL_NEVER, 0, static_cast<GLuint>(-1)));
-		fill_rect(rendering_area(), colour::White);
-		glCheck(glStencilFunc(GL_EQUAL, 1, static_cast<GLuint>(-1)));
+		state.colour_mask(false);
+		state.depth_mask(false);
+		state.stencil_mask(static_cast<GLuint>(-1));
+		state.stencil_func(GL_EQUAL, static_cast<GLint>(iStencilDepth - 1), static_cast<GLuint>(-1));
+		state.stencil_op(GL_KEEP, GL_KEEP, GL_INCR);
 		for (std::size_t i = 0; i < aPath.paths().size(); ++i)
 		{
 			if (aPath.paths()[i].size() > 2)
 			{
-				auto vertices = aPath.to_vertices(aPath.paths()[i]);
-				std::vector<std::array<uint8_t, 4>> colours(vertices.size() / 2, std::array <uint8_t, 4>{{0xFF, 0xFF, 0xFF, 0xFF}});
-				glCheck(glColorPointer(4, GL_UNSIGNED_BYTE, 0, &colours[0]));
-				glCheck(glVertexPointer(2, GL_DOUBLE, 0, &vertices[0]));
-				std::vector<double> texCoords(vertices.size(), 0.0);
-				glCheck(glTexCoordPointer(2, GL_DOUBLE, 0, &texCoords[0]));
-				glCheck(glDrawArrays(path_shape_to_gl_mode(aPath), 0, vertices.size() / 2));
+				path_vertices(vertex_arena(), aPath.to_vertices(aPath.paths()[i]));
+				draw_vertices(path_shape_to_gl_mode(aPath), colour::White);
 			}
 		}
+		flush();
 		if (aPathOutline != 0)
 		{
-			glCheck(glStencilFunc(GL_NEVER, 0, static_cast<GLuint>(-1)));
+			state.stencil_func(GL_EQUAL, static_cast<GLint>(iStencilDepth), static_cast<GLuint>(-1));
+			state.stencil_op(GL_KEEP, GL_KEEP, GL_DECR);
 			path innerPath = aPath;
 			innerPath.deflate(aPathOutline);
 			for (std::size_t i = 0; i < innerPath.paths().size(); ++i)
 			{
 				if (innerPath.paths()[i].size() > 2)
 				{
-					auto vertices = aPath.to_vertices(innerPath.paths()[i]);
-					std::vector<std::array<uint8_t, 4>> colours(vertices.size() / 2, std::array <uint8_t, 4>{{0xFF, 0xFF, 0xFF, 0xFF}});
-					glCheck(glColorPointer(4, GL_UNSIGNED_BYTE, 0, &colours[0]));
-					glCheck(glVertexPointer(2, GL_DOUBLE, 0, &vertices[0]));
-					std::vector<double> texCoords(vertices.size(), 0.0);
-					glCheck(glTexCoordPointer(2, GL_DOUBLE, 0, &texCoords[0]));
-					glCheck(glDrawArrays(path_shape_to_gl_mode(innerPath), 0, vertices.size() / 2));
+					path_vertices(vertex_arena(), aPath.to_vertices(innerPath.paths()[i]));
+					draw_vertices(path_shape_to_gl_mode(innerPath), colour::White);
 				}
 			}
+			flush();
 		} 
-		glCheck(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
-		glCheck(glDepthMask(GL_TRUE));
-		glCheck(glStencilMask(0x00));
-		// draw only where stencil's value is 1
-		glCheck(glStencilFunc(GL_EQUAL, 1, static_cast<GLuint>(-1)));
+		iClipStack.push_back(clip{ boost::none, aPath.bounding_rect() });
+		apply_stencil_clip();
 	}
 
 	void opengl_graphics_context::reset_clip()
 	{
-		if (--iClipCounter == 0)
+		flush();
+		if (iClipStack.empty())
+			return;
+		clip c = iClipStack.back();
+		iClipStack.pop_back();
+		if (c.scissor != boost::none)
 		{
-			glCheck(glDisable(GL_STENCIL_TEST));
+			update_scissor();
+			return;
+		}
+		auto& state = rendering_engine().state();
+		if (--iStencilDepth == 0)
+		{
+			state.disable(GL_STENCIL_TEST);
+			return;
 		}
+		// return the area marked by the clip being removed to the enclosing clip's stencil value; only pixels marked by
+		// that clip are above the enclosing value so no scissor is needed (the scissor may have narrowed since the clip 
+		// was established and would leave some of them marked)
+		state.colour_mask(false);
+		state.depth_mask(false);
+		state.stencil_mask(static_cast<GLuint>(-1));
+		state.stencil_func(GL_LESS, static_cast<GLint>(iStencilDepth), static_cast<GLuint>(-1));
+		state.stencil_op(GL_KEEP, GL_KEEP, GL_REPLACE);
+		iScissor = opengl_command_buffer::NoScissor;
+		{
+			disable_anti_alias daa(*this);
+			fill_rect(c.stencilBounds.inflate(1.0, 1.0), colour::White);
+		}
+		flush();
+		update_scissor();
+		apply_stencil_clip();
+	}
+
+	void opengl_graphics_context::apply_stencil_clip()
+	{
+		auto& state = rendering_engine().state();
+		state.colour_mask(true);
+		state.depth_mask(true);
+		state.stencil_mask(0x00);
+		state.stencil_op(GL_KEEP, GL_KEEP, GL_KEEP);
+		// draw only where the stencil value matches the current clip depth
+		state.stencil_func(GL_EQUAL, static_cast<GLint>(iStencilDepth), static_cast<GLuint>(-1));
 	}
 
 	bool opengl_graphics_context::monochrome() const
@@ -403,30 +555,21 @@ namespace neogfx
 
 	smoothing_mode_e opengl_graphics_context::set_smoothing_mode(smoothing_mode_e aSmoothingMode)
 	{
-		glCheck((void)0);
 		smoothing_mode_e oldSmoothingMode = iSmoothingMode;
 		iSmoothingMode = aSmoothingMode;
-		if (iSmoothingMode == SmoothingModeAntiAlias)
-		{
-			glCheck(glEnable(GL_LINE_SMOOTH));
-			glCheck(glEnable(GL_POLYGON_SMOOTH));
-		}
-		else
-		{
-			glCheck(glDisable(GL_LINE_SMOOTH));
-			glCheck(glDisable(GL_POLYGON_SMOOTH));
-		}
 		return oldSmoothingMode;
 	}
 
 	void opengl_graphics_context::push_logical_operation(logical_operation_e aLogicalOperation)
 	{
+		flush();
 		iLogicalOperationStack.push_back(aLogicalOperation);
 		apply_logical_operation();
 	}
 
 	void opengl_graphics_context::pop_logical_operation()
 	{
+		flush();
 		if (!iLogicalOperationStack.empty())
 			iLogicalOperationStack.pop_back();
 		apply_logical_operation();
@@ -434,17 +577,16 @@ namespace neogfx
 
 	void opengl_graphics_context::apply_logical_operation()
 	{
+		auto& state = rendering_engine().state();
 		if (iLogicalOperationStack.empty() || iLogicalOperationStack.back() == LogicalNone)
-		{
-			glCheck(glDisable(GL_COLOR_LOGIC_OP));
-		}
+			state.disable(GL_COLOR_LOGIC_OP);
 		else
 		{
-			glCheck(glEnable(GL_COLOR_LOGIC_OP));
+			state.enable(GL_COLOR_LOGIC_OP);
 			switch (iLogicalOperationStack.back())
 			{
 			case LogicalXor:
-				glCheck(glLogicOp(GL_XOR));
+				state.logic_op(GL_XOR);
 				break;
 			}
 		}	
@@ -452,15 +594,13 @@ namespace neogfx
 
 	void opengl_graphics_context::line_stipple_on(uint32_t aFactor, uint16_t aPattern)
 	{
-		glCheck(glEnable(GL_LINE_STIPPLE));
-		glCheck(glLineStipple(static_cast<GLint>(aFactor), static_cast<GLushort>(aPattern)));
-		iLineStippleActive = true;
+		// the stipple is applied to the geometry of lines as they are recorded
+		iLineStipple = opengl_command_buffer::line_stipple{ aFactor, aPattern };
 	}
 
 	void opengl_graphics_context::line_stipple_off()
 	{
-		glCheck(glDisable(GL_LINE_STIPPLE));
-		iLineStippleActive = false;
+		iLineStipple = boost::none;
 	}
 
 	void opengl_graphics_context::clear(const colour& aColour)
@@ -486,75 +626,66 @@ namespace neogfx
 	void opengl_graphics_context::draw_line(const point& aFrom, const point& aTo, const pen& aPen)
 	{
 		double pixelAdjust = pixel_adjust(aPen);
-		std::vector<double> vertices{aFrom.x + pixelAdjust, aFrom.y + pixelAdjust, aTo.x + pixelAdjust, aTo.y + pixelAdjust };
-		std::vector<double> texCoords(vertices.size(), 0.0);
-		std::vector<std::array<uint8_t, 4>> colours(vertices.size() / 2, std::array <uint8_t, 4>{{aPen.colour().red(), aPen.colour().green(), aPen.colour().blue(), aPen.colour().alpha()}});
-		glCheck(glLineWidth(static_cast<GLfloat>(aPen.width())));
-		glCheck(glColorPointer(4, GL_UNSIGNED_BYTE, 0, &colours[0]));
-		glCheck(glVertexPointer(2, GL_DOUBLE, 0, &vertices[0]));
-		glCheck(glTexCoordPointer(2, GL_DOUBLE, 0, &texCoords[0]));
-		glCheck(glDrawArrays(GL_LINES, 0, vertices.size() / 2));
-		glCheck(glLineWidth(1.0f));
+		auto& vertices = vertex_arena();
+		vertices.push_back(make_vertex(aFrom.x + pixelAdjust, aFrom.y + pixelAdjust));
+		vertices.push_back(make_vertex(aTo.x + pixelAdjust, aTo.y + pixelAdjust));
+		draw_vertices(GL_LINES, aPen.colour(), aPen.width());
 	}
 
 	void opengl_graphics_context::draw_rect(const rect& aRect, const pen& aPen)
 	{
 		double pixelAdjust = pixel_adjust(aPen);
-		std::vector<double> vertices =
+		if (analytic_anti_alias() && iLineStipple == boost::none)
 		{
-			aRect.top_left().x, aRect.top_left().y + pixelAdjust, aRect.top_right().x, aRect.top_right().y + pixelAdjust,
-			aRect.top_right().x - pixelAdjust, aRect.top_right().y, aRect.bottom_right().x - pixelAdjust, aRect.bottom_right().y,
-			aRect.bottom_right().x, aRect.bottom_right().y - pixelAdjust, aRect.bottom_left().x, aRect.bottom_left().y - pixelAdjust,
-			aRect.bottom_left().x + pixelAdjust, aRect.bottom_left().y, aRect.top_left().x + pixelAdjust, aRect.top_left().y
-		};
-		std::vector<double> texCoords(vertices.size(), 0.0);
-		std::vector<std::array<uint8_t, 4>> colours(vertices.size() / 2, std::array <uint8_t, 4>{ {aPen.colour().red(), aPen.colour().green(), aPen.colour().blue(), aPen.colour().alpha()}});
-		glCheck(glLineWidth(static_cast<GLfloat>(aPen.width())));
-		glCheck(glVertexPointer(2, GL_DOUBLE, 0, &vertices[0]));
-		glCheck(glTexCoordPointer(2, GL_DOUBLE, 0, &texCoords[0]));
-		glCheck(glColorPointer(4, GL_UNSIGNED_BYTE, 0, &colours[0]));
-		glCheck(glDrawArrays(GL_LINES, 0, vertices.size() / 2));
-		glCheck(glLineWidth(1.0f));
+			draw_shape(rect{ aRect }.deflate(pixelAdjust, pixelAdjust), 0.0, aPen.width(), aPen.colour());
+			return;
+		}
+		auto& vertices = vertex_arena();
+		vertices.push_back(make_vertex(aRect.top_left().x, aRect.top_left().y + pixelAdjust));
+		vertices.push_back(make_vertex(aRect.top_right().x, aRect.top_right().y + pixelAdjust));
+		vertices.push_back(make_vertex(aRect.top_right().x - pixelAdjust, aRect.top_right().y));
+		vertices.push_back(make_vertex(aRect.bottom_right().x - pixelAdjust, aRect.bottom_right().y));
+		vertices.push_back(make_vertex(aRect.bottom_right().x, aRect.bottom_right().y - pixelAdjust));
+		vertices.push_back(make_vertex(aRect.bottom_left().x, aRect.bottom_left().y - pixelAdjust));
+		vertices.push_back(make_vertex(aRect.bottom_left().x + pixelAdjust, aRect.bottom_left().y));
+		vertices.push_back(make_vertex(aRect.top_left().x + pixelAdjust, aRect.top_left().y));
+		draw_vertices(GL_LINES, aPen.colour(), aPen.width());
 	}
 
 	void opengl_graphics_context::draw_rounded_rect(const rect& aRect, dimension aRadius, const pen& aPen)
 	{
 		double pixelAdjust = pixel_adjust(aPen);
-		auto vertices = rounded_rect_vertices(aRect + point{ pixelAdjust, pixelAdjust }, aRadius, false);
-		std::vector<double> texCoords(vertices.size(), 0.0);
-		std::vector<std::array<uint8_t, 4>> colours(vertices.size() / 2, std::array <uint8_t, 4>{ {aPen.colour().red(), aPen.colour().green(), aPen.colour().blue(), aPen.colour().alpha()}});
-		glCheck(glLineWidth(static_cast<GLfloat>(aPen.width())));
-		glCheck(glVertexPointer(2, GL_DOUBLE, 0, &vertices[0]));
-		glCheck(glTexCoordPointer(2, GL_DOUBLE, 0, &texCoords[0]));
-		glCheck(glColorPointer(4, GL_UNSIGNED_BYTE, 0, &colours[0]));
-		glCheck(glDrawArrays(GL_LINE_LOOP, 0, vertices.size() / 2));
-		glCheck(glLineWidth(1.0f));
+		if (analytic_anti_alias() && iLineStipple == boost::none)
+		{
+			draw_shape(rect{ aRect }.deflate(pixelAdjust, pixelAdjust), aRadius, aPen.width(), aPen.colour());
+			return;
+		}
+		rounded_rect_vertices(vertex_arena(), rendering_engine().tessellation_cache(), aRect + point{ pixelAdjust, pixelAdjust }, aRadius, false);
+		draw_vertices(GL_LINE_LOOP, aPen.colour(), aPen.width());
 	}
 
 	void opengl_graphics_context::draw_circle(const point& aCentre, dimension aRadius, const pen& aPen)
 	{
-		auto vertices = circle_vertices(aCentre, aRadius, false);
-		std::vector<double> texCoords(vertices.size(), 0.0);
-		std::vector<std::array<uint8_t, 4>> colours(vertices.size() / 2, std::array <uint8_t, 4>{{aPen.colour().red(), aPen.colour().green(), aPen.colour().blue(), aPen.colour().alpha()}});
-		glCheck(glLineWidth(static_cast<GLfloat>(aPen.width())));
-		glCheck(glColorPointer(4, GL_UNSIGNED_BYTE, 0, &colours[0]));
-		glCheck(glVertexPointer(2, GL_DOUBLE, 0, &vertices[0]));
-		glCheck(glTexCoordPointer(2, GL_DOUBLE, 0, &texCoords[0]));
-		glCheck(glDrawArrays(GL_LINE_LOOP, 0, vertices.size() / 2));
-		glCheck(glLineWidth(1.0f));
+		if (analytic_anti_alias() && iLineStipple == boost::none)
+		{
+			draw_shape(circle_bounds(aCentre, aRadius), aRadius, aPen.width(), aPen.colour());
+			return;
+		}
+		circle_vertices(vertex_arena(), rendering_engine().tessellation_cache(), aCentre, aRadius, false);
+		draw_vertices(GL_LINE_LOOP, aPen.colour(), aPen.width());
 	}
 
 	void opengl_graphics_context::draw_arc(const point& aCentre, dimension aRadius, angle aStartAngle, angle aEndAngle, const pen& aPen)
 	{
-		auto vertices = line_loop_to_lines(arc_vertices(aCentre, aRadius, aStartAngle, aEndAngle, false));
-		std::vector<double> texCoords(vertices.size(), 0.0);
-		std::vector<std::array<uint8_t, 4>> colours(vertices.size() / 2, std::array <uint8_t, 4>{ {aPen.colour().red(), aPen.colour().green(), aPen.colour().blue(), aPen.colour().alpha()}});
-		glCheck(glLineWidth(static_cast<GLfloat>(aPen.width())));
-		glCheck(glColorPointer(4, GL_UNSIGNED_BYTE, 0, &colours[0]));
-		glCheck(glVertexPointer(2, GL_DOUBLE, 0, &vertices[0]));
-		glCheck(glTexCoordPointer(2, GL_DOUBLE, 0, &texCoords[0]));
-		glCheck(glDrawArrays(GL_LINES, 0, vertices.size() / 2));
-		glCheck(glLineWidth(1.0f));
+		if (analytic_anti_alias() && iLineStipple == boost::none)
+		{
+			auto& arc = outline_arena();
+			arc_vertices(arc, rendering_engine().tessellation_cache(), aCentre, aRadius, aStartAngle, aEndAngle, false);
+			draw_outline(arc, 0, false, -aPen.width() / 2.0, aPen.width() / 2.0, true, aPen.colour());
+			return;
+		}
+		arc_vertices(vertex_arena(), rendering_engine().tessellation_cache(), aCentre, aRadius, aStartAngle, aEndAngle, false);
+		draw_vertices(GL_LINE_STRIP, aPen.colour(), aPen.width());
 	}
 
 	void opengl_graphics_context::draw_path(const path& aPath, const pen& aPen)
@@ -563,15 +694,20 @@ namespace neogfx
 		{
 			if (aPath.paths()[i].size() > 2)
 			{
+				if (analytic_anti_alias() && iLineStipple == boost::none && (aPath.shape() == path::ConvexPolygon || aPath.shape() == path::LineLoop || aPath.shape() == path::LineStrip))
+				{
+					auto& outline = outline_arena();
+					path_vertices(outline, aPath.to_vertices(aPath.paths()[i]));
+					if (aPath.shape() == path::ConvexPolygon)
+						draw_outline(outline, 0, true, -aPen.width(), 0.0, true, aPen.colour());
+					else
+						draw_outline(outline, 0, aPath.shape() == path::LineLoop, -aPen.width() / 2.0, aPen.width() / 2.0, true, aPen.colour());
+					continue;
+				}
 				if (aPath.shape() == path::ConvexPolygon)
 					clip_to(aPath, aPen.width());
-				auto vertices = aPath.to_vertices(aPath.paths()[i]);
-				std::vector<double> texCoords(vertices.size(), 0.0);
-				std::vector<std::array<uint8_t, 4>> colours(vertices.size() / 2, std::array <uint8_t, 4>{{aPen.colour().red(), aPen.colour().green(), aPen.colour().blue(), aPen.colour().alpha()}});
-				glCheck(glColorPointer(4, GL_UNSIGNED_BYTE, 0, &colours[0]));
-				glCheck(glVertexPointer(2, GL_DOUBLE, 0, &vertices[0]));
-				glCheck(glTexCoordPointer(2, GL_DOUBLE, 0, &texCoords[0]));
-				glCheck(glDrawArrays(path_shape_to_gl_mode(aPath.shape()), 0, vertices.size() / 2));
+				path_vertices(vertex_arena(), aPath.to_vertices(aPath.paths()[i]));
+				draw_vertices(path_shape_to_gl_mode(aPath.shape()), aPen.colour());
 				if (aPath.shape() == path::ConvexPolygon)
 					reset_clip();
 			}
@@ -580,161 +716,91 @@ namespace neogfx
 
 	void opengl_graphics_context::fill_rect(const rect& aRect, const colour& aColour)
 	{
-		path rectPath(aRect);
-		auto vertices = rectPath.to_vertices(rectPath.paths()[0]);
-		std::vector<double> texCoords(vertices.size(), 0.0);
-		std::vector<std::array<uint8_t, 4>> colours(vertices.size() / 2, std::array <uint8_t, 4>{{aColour.red(), aColour.green(), aColour.blue(), aColour.alpha()}});
-		glCheck(glColorPointer(4, GL_UNSIGNED_BYTE, 0, &colours[0]));
-		glCheck(glVertexPointer(2, GL_DOUBLE, 0, &vertices[0]));
-		glCheck(glTexCoordPointer(2, GL_DOUBLE, 0, &texCoords[0]));
-		glCheck(glDrawArrays(path_shape_to_gl_mode(rectPath.shape()), 0, vertices.size() / 2));
+		if (analytic_anti_alias())
+		{
+			draw_shape(aRect, 0.0, 0.0, aColour);
+			return;
+		}
+		rect_vertices(vertex_arena(), aRect, false);
+		draw_vertices(GL_QUADS, aColour);
 	}
 
 	void opengl_graphics_context::fill_rect(const rect& aRect, const gradient& aGradient)
 	{
 		if (aRect.empty())
 			return;
-		path rectPath(aRect);
-		auto vertices = rectPath.to_vertices(rectPath.paths()[0]);
-		std::vector<std::array<uint8_t, 4>> colours;
-		if (aGradient.direction() == gradient::Vertical)
-		{
-			for (auto& v : vertices)
-			{
-				if ((&v - &vertices[0]) % 2 == 1)
-				{
-					colour c = aGradient.at(v, aRect.top(), aRect.bottom());
-					colours.push_back(std::array < uint8_t, 4 > {{c.red(), c.green(), c.blue(), c.alpha()}});
-				}
-			}
-		}
-		else if (aGradient.direction() == gradient::Horizontal)
-		{
-			for (auto& v : vertices)
-			{
-				if ((&v - &vertices[0]) % 2 == 0)
-				{
-					colour c = aGradient.at(v, aRect.left(), aRect.right());
-					colours.push_back(std::array < uint8_t, 4 > {{c.red(), c.green(), c.blue(), c.alpha()}});
-				}
-			}
-		}
-		else if (aGradient.direction() == gradient::Radial)
-		{
-			colour e = aGradient.at(1.0);
-			colours = decltype(colours){ vertices.size() / 2, std::array < uint8_t, 4 > { {e.red(), e.green(), e.blue(), e.alpha()}} };
-			colour c = aGradient.at(0.0);
-			colours[0] = std::array < uint8_t, 4 > { {c.red(), c.green(), c.blue(), c.alpha()}};
-		}
-		std::vector<double> texCoords(vertices.size(), 0.0);
-		glCheck(glColorPointer(4, GL_UNSIGNED_BYTE, 0, &colours[0]));
-		glCheck(glVertexPointer(2, GL_DOUBLE, 0, &vertices[0]));
-		glCheck(glTexCoordPointer(2, GL_DOUBLE, 0, &texCoords[0]));
-		glCheck(glDrawArrays(path_shape_to_gl_mode(rectPath.shape()), 0, vertices.size() / 2));
+		draw_gradient_shape(aRect, 0.0, aGradient);
 	}
 
 	void opengl_graphics_context::fill_rounded_rect(const rect& aRect, dimension aRadius, const colour& aColour)
 	{
-		auto vertices = rounded_rect_vertices(aRect, aRadius, true);
-		std::vector<double> texCoords(vertices.size(), 0.0);
-		std::vector<std::array<uint8_t, 4>> colours(vertices.size() / 2, std::array <uint8_t, 4>{ {aColour.red(), aColour.green(), aColour.blue(), aColour.alpha()}});
-		glCheck(glColorPointer(4, GL_UNSIGNED_BYTE, 0, &colours[0]));
-		glCheck(glVertexPointer(2, GL_DOUBLE, 0, &vertices[0]));
-		glCheck(glTexCoordPointer(2, GL_DOUBLE, 0, &texCoords[0]));
-		glCheck(glDrawArrays(GL_TRIANGLE_FAN, 0, vertices.size() / 2));
+		if (analytic_anti_alias())
+		{
+			draw_shape(aRect, aRadius, 0.0, aColour);
+			return;
+		}
+		rounded_rect_vertices(vertex_arena(), rendering_engine().tessellation_cache(), aRect, aRadius, true);
+		draw_vertices(GL_TRIANGLE_FAN, aColour);
 	}
 
 	void opengl_graphics_context::fill_rounded_rect(const rect& aRect, dimension aRadius, const gradient& aGradient)
 	{
-		auto vertices = rounded_rect_vertices(aRect, aRadius, true);
-		std::vector<double> texCoords(vertices.size(), 0.0);
-		std::vector<std::array<uint8_t, 4>> colours;
-		if (aGradient.direction() == gradient::Vertical)
-		{
-			for (auto& v : vertices)
-			{
-				if ((&v - &vertices[0]) % 2 == 1)
-				{
-					colour c = aGradient.at(v, aRect.top(), aRect.bottom());
-					colours.push_back(std::array < uint8_t, 4 > { {c.red(), c.green(), c.blue(), c.alpha()}});
-				}
-			}
-		}
-		else if (aGradient.direction() == gradient::Horizontal)
-		{
-			for (auto& v : vertices)
-			{
-				if ((&v - &vertices[0]) % 2 == 0)
-				{
-					colour c = aGradient.at(v, aRect.left(), aRect.right());
-					colours.push_back(std::array < uint8_t, 4 > { {c.red(), c.green(), c.blue(), c.alpha()}});
-				}
-			}
-		}
-		else if (aGradient.direction() == gradient::Radial)
-		{
-			colour e = aGradient.at(1.0);
-			colours = decltype(colours){ vertices.size() / 2, std::array < uint8_t, 4 > { {e.red(), e.green(), e.blue(), e.alpha()}} };
-			colour c = aGradient.at(0.0);
-			colours[0] = std::array < uint8_t, 4 > { {c.red(), c.green(), c.blue(), c.alpha()}};
-		}
-		glCheck(glColorPointer(4, GL_UNSIGNED_BYTE, 0, &colours[0]));
-		glCheck(glVertexPointer(2, GL_DOUBLE, 0, &vertices[0]));
-		glCheck(glTexCoordPointer(2, GL_DOUBLE, 0, &texCoords[0]));
-		glCheck(glDrawArrays(GL_TRIANGLE_FAN, 0, vertices.size() / 2));
+		if (aRect.empty())
+			return;
+		draw_gradient_shape(aRect, aRadius, aGradient);
 	}
 
 	void opengl_graphics_context::fill_circle(const point& aCentre, dimension aRadius, const colour& aColour)
 	{
-		auto vertices = circle_vertices(aCentre, aRadius, true);
-		std::vector<double> texCoords(vertices.size(), 0.0);
-		std::vector<std::array<uint8_t, 4>> colours(vertices.size() / 2, std::array <uint8_t, 4>{{aColour.red(), aColour.green(), aColour.blue(), aColour.alpha()}});
-		glCheck(glColorPointer(4, GL_UNSIGNED_BYTE, 0, &colours[0]));
-		glCheck(glVertexPointer(2, GL_DOUBLE, 0, &vertices[0]));
-		glCheck(glTexCoordPointer(2, GL_DOUBLE, 0, &texCoords[0]));
-		glCheck(glDrawArrays(GL_TRIANGLE_FAN, 0, vertices.size() / 2));
+		if (analytic_anti_alias())
+		{
+			draw_shape(circle_bounds(aCentre, aRadius), aRadius, 0.0, aColour);
+			return;
+		}
+		circle_vertices(vertex_arena(), rendering_engine().tessellation_cache(), aCentre, aRadius, true);
+		draw_vertices(GL_TRIANGLE_FAN, aColour);
 	}
 
 	void opengl_graphics_context::fill_arc(const point& aCentre, dimension aRadius, angle aStartAngle, angle aEndAngle, const colour& aColour)
 	{
-		auto vertices = arc_vertices(aCentre, aRadius, aStartAngle, aEndAngle, true);
-		std::vector<double> texCoords(vertices.size(), 0.0);
-		std::vector<std::array<uint8_t, 4>> colours(vertices.size() / 2, std::array <uint8_t, 4>{ {aColour.red(), aColour.green(), aColour.blue(), aColour.alpha()}});
-		glCheck(glColorPointer(4, GL_UNSIGNED_BYTE, 0, &colours[0]));
-		glCheck(glVertexPointer(2, GL_DOUBLE, 0, &vertices[0]));
-		glCheck(glTexCoordPointer(2, GL_DOUBLE, 0, &texCoords[0]));
-		glCheck(glDrawArrays(GL_TRIANGLE_FAN, 0, vertices.size() / 2));
+		arc_vertices(vertex_arena(), rendering_engine().tessellation_cache(), aCentre, aRadius, aStartAngle, aEndAngle, true);
+		if (analytic_anti_alias())
+			outline_arena().assign(iVertices.begin(), iVertices.end());
+		draw_vertices(GL_TRIANGLE_FAN, aColour);
+		if (analytic_anti_alias())
+			draw_outline(iOutlineVertices, 0, true, 0.0, 0.0, false, aColour);
 	}
 
 	void opengl_graphics_context::fill_shape(const point& aCentre, const vertex_list2& aVertices, const colour& aColour)
 	{
-		vertex_list2 vertices;
+		auto& vertices = vertex_arena();
 		vertices.reserve(aVertices.size() + 2);
-		vertices.push_back(aCentre.to_vector());
-		vertices.insert(vertices.end(), aVertices.begin(), aVertices.end());
-		vertices.push_back(vertices[1]);
-		std::vector<double> texCoords(vertices.size() * 2, 0.0);
-		std::vector<std::array<uint8_t, 4>> colours(vertices.size(), std::array <uint8_t, 4>{ {aColour.red(), aColour.green(), aColour.blue(), aColour.alpha()}});
-		glCheck(glColorPointer(4, GL_UNSIGNED_BYTE, 0, &colours[0]));
-		glCheck(glVertexPointer(2, GL_DOUBLE, 0, &vertices[0]));
-		glCheck(glTexCoordPointer(2, GL_DOUBLE, 0, &texCoords[0]));
-		glCheck(glDrawArrays(GL_TRIANGLE_FAN, 0, vertices.size()));
+		vertices.push_back(make_vertex(aCentre));
+		for (const auto& v : aVertices)
+			vertices.push_back(make_vertex(v[0], v[1]));
+		close_loop(vertices, 1);
+		if (analytic_anti_alias())
+			outline_arena().assign(vertices.begin(), vertices.end());
+		draw_vertices(GL_TRIANGLE_FAN, aColour);
+		if (analytic_anti_alias())
+			draw_outline(iOutlineVertices, 1, true, 0.0, 0.0, false, aColour);
 	}
 
 	void opengl_graphics_context::fill_and_draw_path(const path& aPath, const colour& aFillColour, const pen& aPen)
 	{
-		for (std::size_t i = 0; i < aPath.paths().size(); ++i)
+		const auto& triangles = aPath.triangulation();
+		auto& vertices = vertex_arena();
+		vertices.reserve(triangles.indices.size());
+		for (auto i : triangles.indices)
+			vertices.push_back(make_vertex(triangles.vertices[i] + aPath.position()));
+		draw_vertices(GL_TRIANGLES, aFillColour);
+		if (analytic_anti_alias())
 		{
-			if (aPath.paths()[i].size() > 2)
+			for (std::size_t i = 0; i < aPath.paths().size(); ++i)
 			{
-				clip_to(aPath, 0.0);
-				auto vertices = aPath.to_vertices(aPath.paths()[i]);
-				std::vector<std::array<uint8_t, 4>> colours(vertices.size() / 2, std::array <uint8_t, 4>{{aFillColour.red(), aFillColour.green(), aFillColour.blue(), aFillColour.alpha()}});
-				glCheck(glColorPointer(4, GL_UNSIGNED_BYTE, 0, &colours[0]));
-				glCheck(glVertexPointer(2, GL_DOUBLE, 0, &vertices[0]));
-				std::vector<double> texCoords(vertices.size(), 0.0);
-				glCheck(glDrawArrays(path_shape_to_gl_mode(aPath.shape()), 0, vertices.size() / 2));
-				reset_clip();
+				auto& outline = outline_arena();
+				path_vertices(outline, aPath.to_vertices(aPath.paths()[i]));
+				draw_outline(outline, 0, true, 0.0, 0.0, false, aFillColour);
 			}
 		}
 		if (aPen.width() != 0.0)
@@ -748,66 +814,48 @@ namespace neogfx
 
 	glyph_text opengl_graphics_context::to_glyph_text(string::const_iterator aTextBegin, string::const_iterator aTextEnd, std::function<font(std::string::size_type)> aFontSelector) const
 	{
-		bool fallbackNeeded = false;
-		glyph_text::container result = to_glyph_text_impl(aTextBegin, aTextEnd, aFontSelector, fallbackNeeded);
-		if (fallbackNeeded)
-		{
-			glyph_text::container fallbackResult = 
-				to_glyph_text_impl(aTextBegin, aTextEnd, [&aFontSelector](std::string::size_type aSourceIndex) { return aFontSelector(aSourceIndex).fallback(); }, fallbackNeeded);
-			for (auto i = result.begin(), j = fallbackResult.begin(); i != result.end(); ++i, ++j)
-			{
-				if (i->use_fallback())
-				{
-					*i = *j;
-					i->set_use_fallback(true);
-				}
-			}
-		}
-		return glyph_text(aFontSelector(0), std::move(result));
+		return iTextShaper.to_glyph_text(aTextBegin, aTextEnd, aFontSelector);
 	}
 
 	void opengl_graphics_context::set_mnemonic(bool aShowMnemonics, char aMnemonicPrefix)
 	{
-		iMnemonic = std::make_pair(aShowMnemonics, aMnemonicPrefix);
+		iTextShaper.set_mnemonic(aShowMnemonics, aMnemonicPrefix);
 	}
 
 	void opengl_graphics_context::unset_mnemonic()
 	{
-		iMnemonic = boost::none;
+		iTextShaper.unset_mnemonic();
 	}
 
 	bool opengl_graphics_context::mnemonics_shown() const
 	{
-		return iMnemonic != boost::none && iMnemonic->first;
+		return iTextShaper.mnemonics_shown();
 	}
 
 	void opengl_graphics_context::begin_drawing_glyphs()
 	{
-		iRenderingEngine.activate_shader_program(iRenderingEngine.subpixel_shader_program());
-
-		glCheck(glActiveTexture(GL_TEXTURE1));
-		glCheck(glClientActiveTexture(GL_TEXTURE1));
-		glCheck(glEnable(GL_TEXTURE_2D));
-		glCheck(glGetIntegerv(GL_TEXTURE_BINDING_2D, &iPreviousTexture));
-		iActiveGlyphTexture = static_cast<GLuint>(iPreviousTexture);
+		iDrawingGlyphs = true;
 	}
 
 	namespace
 	{
-		std::vector<double> texture_vertices(const size& aTextureStorageSize, const rect& aTextureRect)
+		std::array<GLfloat, 8> texture_vertices(const size& aTextureStorageSize, const rect& aTextureRect)
 		{
-			std::vector<double> result;
 			rect actualRect = aTextureRect + point(1.0, 1.0);
 			rect normalizedRect = actualRect / aTextureStorageSize;
-			result.push_back(normalizedRect.top_left().x);
-			result.push_back(normalizedRect.top_left().y);
-			result.push_back(normalizedRect.top_right().x);
-			result.push_back(normalizedRect.top_right().y);
-			result.push_back(normalizedRect.bottom_right().x);
-			result.push_back(normalizedRect.bottom_right().y);
-			result.push_back(normalizedRect.bottom_left().x);
-			result.push_back(normalizedRect.bottom_left().y);
-			return result;
+			return std::array<GLfloat, 8>{{
+				static_cast<GLfloat>(normalizedRect.top_left().x), static_cast<GLfloat>(normalizedRect.top_left().y),
+				static_cast<GLfloat>(normalizedRect.top_right().x), static_cast<GLfloat>(normalizedRect.top_right().y),
+				static_cast<GLfloat>(normalizedRect.bottom_right().x), static_cast<GLfloat>(normalizedRect.bottom_right().y),
+				static_cast<GLfloat>(normalizedRect.bottom_left().x), static_cast<GLfloat>(normalizedRect.bottom_left().y) }};
+		}
+	}
+
+	namespace
+	{
+		const i_glyph_texture& glyph_texture(const glyph& aGlyph, const font& aFont)
+		{
+			return !aGlyph.use_fallback() ? aFont.native_font_face().glyph_texture(aGlyph) : aFont.fallback().native_font_face().glyph_texture(aGlyph);
 		}
 	}
 
@@ -816,356 +864,371 @@ namespace neogfx
 		if (aGlyph.is_whitespace())
 			return;
 
-		const i_glyph_texture& glyphTexture = !aGlyph.use_fallback() ? aFont.native_font_face().glyph_texture(aGlyph) : aFont.fallback().native_font_face().glyph_texture(aGlyph);
+		const i_glyph_texture& glyphTexture = glyph_texture(aGlyph, aFont);
 
-		auto& vertices = iVertices;
-		auto& colours = iColours;
-		auto& textureCoords = iTextureCoords;
-		textureCoords.resize(8);
-		auto& shifts = iShifts;
-		shifts.clear();
-		shifts.resize(4, std::array<GLdouble, 2>{{aPoint.x - std::floor(aPoint.x), aPoint.y - std::floor(aPoint.y)}});
+		auto& vertices = vertex_arena();
+		append_glyph(vertices, aPoint, glyphTexture, aFont, aColour);
+		iCommandBuffer->add(glyph_state(glyphTexture.font_texture()), vertices.data(), vertices.data() + vertices.size());
+		commit();
+	}
 
-		point glyphOrigin(aPoint.x + glyphTexture.placement().x, 
-			logical_coordinates()[1] < logical_coordinates()[3] ? 
-				aPoint.y + (glyphTexture.placement().y + -aFont.descender()) :
-				aPoint.y + aFont.height() - (glyphTexture.placement().y + -aFont.descender()) - glyphTexture.extents().cy);
-		vertices.clear();
-		vertices.insert(vertices.begin(),
+	void opengl_graphics_context::draw_glyph_run(const glyph_run& aRun)
+	{
+		for (const auto& item : aRun)
 		{
-			to_shader_vertex(glyphOrigin),
-			to_shader_vertex(glyphOrigin + point(0.0, glyphTexture.extents().cy)),
-			to_shader_vertex(glyphOrigin + point(glyphTexture.extents().cx, glyphTexture.extents().cy)),
-			to_shader_vertex(glyphOrigin + point(glyphTexture.extents().cx, 0.0))
-		});
-
-		colours.clear();
-		colours.resize(vertices.size(), std::array<double, 4>{{aColour.red<double>(), aColour.green<double>(), aColour.blue<double>(), aColour.alpha<double>()}});
-
-		bool lcdMode = iRenderingEngine.screen_metrics().subpixel_format() == i_screen_metrics::SubpixelFormatRGBHorizontal ||
-			iRenderingEngine.screen_metrics().subpixel_format() == i_screen_metrics::SubpixelFormatBGRHorizontal;
+			if (item.glyph->is_whitespace() && !item.underline)
+				continue;
+			const i_glyph_texture& glyphTexture = glyph_texture(*item.glyph, *item.font);
+			auto& vertices = vertex_arena();
+			if (!item.glyph->is_whitespace())
+				append_glyph(vertices, item.position + item.glyph->offset(), glyphTexture, *item.font, item.colour);
+			if (item.underline)
+				append_glyph_underline(vertices, item.position, glyphTexture, *item.font, item.colour);
+			iCommandBuffer->add(glyph_state(glyphTexture.font_texture()), vertices.data(), vertices.data() + vertices.size());
+		}
+		commit();
+	}
 
-		textureCoords[0] = glyphTexture.font_texture_location().x / glyphTexture.font_texture().extents().cx;
-		textureCoords[1] = glyphTexture.font_texture_location().y / glyphTexture.font_texture().extents().cy;
-		textureCoords[2] = glyphTexture.font_texture_location().x / glyphTexture.font_texture().extents().cx;
-		textureCoords[3] = (glyphTexture.font_texture_location().y + glyphTexture.extents().cy) / glyphTexture.font_texture().extents().cy;
-		textureCoords[4] = (glyphTexture.font_texture_location().x + glyphTexture.extents().cx * (lcdMode ? 3.0 : 1.0)) / glyphTexture.font_texture().extents().cx;
-		textureCoords[5] = (glyphTexture.font_texture_location().y + glyphTexture.extents().cy) / glyphTexture.font_texture().extents().cy;
-		textureCoords[6] = (glyphTexture.font_texture_location().x + glyphTexture.extents().cx * (lcdMode ? 3.0 : 1.0)) / glyphTexture.font_texture().extents().cx;
-		textureCoords[7] = glyphTexture.font_texture_location().y / glyphTexture.font_texture().extents().cy;
+	void opengl_graphics_context::end_drawing_glyphs()
+	{
+		iDrawingGlyphs = false;
+		commit();
+	}
 
+	void opengl_graphics_context::draw_texture(const texture_map& aTextureMap, const i_texture& aTexture, const rect& aTextureRect, const optional_colour& aColour)
+	{	
+		if (aTexture.is_empty())
+			return;
+		auto nativeTexture = aTexture.native_texture();
+		nativeTexture->make_resident();
+		auto texCoords = texture_vertices(aTexture.storage_extents(), aTextureRect);
 		if (logical_coordinates()[1] < logical_coordinates()[3])
 		{
-			std::swap(textureCoords[1], textureCoords[5]);
-			std::swap(textureCoords[3], textureCoords[7]);
+			std::swap(texCoords[1], texCoords[5]);
+			std::swap(texCoords[3], texCoords[7]);
 		}
+		colour c{0xFF, 0xFF, 0xFF, 0xFF};
+		if (aColour != boost::none)
+			c = *aColour;
+		auto rgba = to_rgba(c);
+		auto& vertices = vertex_arena();
+		for (uint32_t i = 0; i < 4; ++i)
+			vertices.push_back(make_vertex(aTextureMap[i][0], aTextureMap[i][1], rgba, texCoords[i * 2], texCoords[i * 2 + 1]));
+		opengl_command_buffer::render_state state{ opengl_command_buffer::Texture, GL_QUADS, reinterpret_cast<GLuint>(nativeTexture->handle()), 
+			iMonochrome, iSmoothingMode, 0.0, iScissor };
+		iCommandBuffer->add(state, vertices.data(), vertices.data() + vertices.size());
+		commit();
+	}
 
-		GLuint boHandles[3];
-		glCheck(glGenBuffers(3, boHandles));
-
-		GLuint positionBufferHandle = boHandles[0];
-		GLuint colourBufferHandle = boHandles[1];
-		GLuint textureCoordBufferHandle = boHandles[2];
-
-		GLint previousVertexArrayBinding;
-		glCheck(glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &previousVertexArrayBinding));
-
-		GLint previousArrayBufferBinding;
-		glCheck(glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &previousArrayBufferBinding));
-
-		glCheck(glBindBuffer(GL_ARRAY_BUFFER, positionBufferHandle));
-		glCheck(glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(vertices[0]), &vertices[0], GL_STATIC_DRAW));
-		glCheck(glBindBuffer(GL_ARRAY_BUFFER, colourBufferHandle));
-		glCheck(glBufferData(GL_ARRAY_BUFFER, colours.size() * sizeof(colours[0]), &colours[0], GL_STATIC_DRAW));
-		glCheck(glBindBuffer(GL_ARRAY_BUFFER, textureCoordBufferHandle));
-		glCheck(glBufferData(GL_ARRAY_BUFFER, textureCoords.size() * sizeof(textureCoords[0]), &textureCoords[0], GL_STATIC_DRAW));
+	void opengl_graphics_context::copy_to_texture(const rect& aSourceRect, const i_texture& aTexture)
+	{
+		flush();
+		auto nativeTexture = aTexture.native_texture();
+		nativeTexture->make_resident();
+		rendering_engine().state().bind_texture(reinterpret_cast<GLuint>(nativeTexture->handle()));
+		glCheck(glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 1, 1, 
+			static_cast<GLint>(aSourceRect.x), static_cast<GLint>(surface().surface_size().cy - aSourceRect.bottom()),
+			static_cast<GLsizei>(aSourceRect.cx), static_cast<GLsizei>(aSourceRect.cy)));
+	}
 
-		GLuint vaoHandle;
-		glCheck(glGenVertexArrays(1, &vaoHandle));
-		glCheck(glBindVertexArray(vaoHandle));
+	void opengl_graphics_context::copy_from_texture(const i_texture& aTexture, const rect& aDestinationRect)
+	{
+		flush();
+		auto nativeTexture = aTexture.native_texture();
+		nativeTexture->make_resident();
+		auto& state = rendering_engine().state();
+		GLuint previousReadFrameBuffer = state.read_frame_buffer();
+		state.bind_frame_buffer(GL_READ_FRAMEBUFFER, rendering_engine().copy_frame_buffer());
+		glCheck(glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, reinterpret_cast<GLuint>(nativeTexture->handle()), 0));
+		// blits are subject to the scissor test; the next replay applies the current scissor again
+		state.disable(GL_SCISSOR_TEST);
+		GLint x = static_cast<GLint>(aDestinationRect.x);
+		GLint y = static_cast<GLint>(surface().surface_size().cy - aDestinationRect.bottom());
+		GLint cx = static_cast<GLint>(aDestinationRect.cx);
+		GLint cy = static_cast<GLint>(aDestinationRect.cy);
+		glCheck(glBlitFramebuffer(1, 1, 1 + cx, 1 + cy, x, y, x + cx, y + cy, GL_COLOR_BUFFER_BIT, GL_NEAREST));
+		// detach the texture so that the frame buffer does not keep it alive after it is deleted
+		glCheck(glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0));
+		state.bind_frame_buffer(GL_READ_FRAMEBUFFER, previousReadFrameBuffer);
+	}
 
-		GLuint vertexPositionAttribArrayIndex = reinterpret_cast<GLuint>(iRenderingEngine.subpixel_shader_program().variable("VertexPosition"));
-		glCheck(glEnableVertexAttribArray(vertexPositionAttribArrayIndex));
-		GLuint vertexColorAttribArrayIndex = reinterpret_cast<GLuint>(iRenderingEngine.subpixel_shader_program().variable("VertexColor"));
-		glCheck(glEnableVertexAttribArray(vertexColorAttribArrayIndex));
-		GLuint vertexTextureCoordAttribArrayIndex = reinterpret_cast<GLuint>(iRenderingEngine.subpixel_shader_program().variable("VertexTextureCoord"));
-		glCheck(glEnableVertexAttribArray(vertexTextureCoordAttribArrayIndex));
+	opengl_renderer& opengl_graphics_context::rendering_engine() const
+	{
+		return static_cast<opengl_renderer&>(iRenderingEngine);
+	}
 
-		glCheck(glBindBuffer(GL_ARRAY_BUFFER, positionBufferHandle));
-		glCheck(glVertexAttribPointer(vertexPositionAttribArrayIndex, 3, GL_DOUBLE, GL_FALSE, 0, 0));
-		glCheck(glBindBuffer(GL_ARRAY_BUFFER, colourBufferHandle));
-		glCheck(glVertexAttribPointer(vertexColorAttribArrayIndex, 4, GL_DOUBLE, GL_FALSE, 0, 0));
-		glCheck(glBindBuffer(GL_ARRAY_BUFFER, textureCoordBufferHandle));
-		glCheck(glVertexAttribPointer(vertexTextureCoordAttribArrayIndex, 2, GL_DOUBLE, GL_FALSE, 0, 0));
+	dimension opengl_graphics_context::pixel_size() const
+	{
+		const auto& logicalCoordinates = logical_coordinates();
+		return std::abs(logicalCoordinates[2] - logicalCoordinates[0]) / std::max<dimension>(surface().surface_size().cx, 1.0);
+	}
 
-		glCheck(glBindVertexArray(vaoHandle));
+	void opengl_graphics_context::draw_outline(const vertices_t& aVertices, std::size_t aFirst, bool aClosed, coordinate aInner, coordinate aOuter, bool aInnerFringe, const colour& aColour)
+	{
+		draw_outline(to_polyline(aVertices, aFirst, aClosed), aClosed, aInner, aOuter, aInnerFringe, aColour);
+	}
 
-		if (iActiveGlyphTexture != reinterpret_cast<GLuint>(glyphTexture.font_texture().handle()))
+	void opengl_graphics_context::draw_outline(const std::vector<point>& aOutline, bool aClosed, coordinate aInner, coordinate aOuter, bool aInnerFringe, const colour& aColour)
+	{
+		// coverage anti-aliasing for geometry that the shape shader cannot describe: a band between the two offsets 
+		// along the outline's normals (outwards for a closed outline) plus a fringe one pixel wide beyond it that fades 
+		// to transparent
+		if (aOutline.size() < 2)
+			return;
+		polyline normals = vertex_normals(aOutline, aClosed);
+		dimension fringe = pixel_size();
+		colour ink = aColour;
+		if (aOuter - aInner < fringe && aOuter != aInner)
 		{
-			iActiveGlyphTexture = reinterpret_cast<GLuint>(glyphTexture.font_texture().handle());
-			glCheck(glBindTexture(GL_TEXTURE_2D, iActiveGlyphTexture));
+			// too thin to cover whole pixels so fade it instead
+			ink.set_alpha(static_cast<colour::component>(ink.alpha() * (aOuter - aInner) / fringe));
+			coordinate middle = (aInner + aOuter) / 2.0;
+			aInner = middle - fringe / 2.0;
+			aOuter = middle + fringe / 2.0;
 		}
-		
-		iRenderingEngine.subpixel_shader_program().set_uniform_variable("glyphTexture", 1);
-		iRenderingEngine.subpixel_shader_program().set_uniform_variable("glyphTextureExtents", glyphTexture.font_texture().extents().cx, glyphTexture.font_texture().extents().cy);
+		auto rgba = to_rgba(ink);
+		auto transparent = to_rgba(ink.with_alpha(0));
+		auto& vertices = vertex_arena();
+		if (aOuter != aInner)
+			band_vertices(vertices, aOutline, normals, aClosed, aInner, rgba, aOuter, rgba);
+		band_vertices(vertices, aOutline, normals, aClosed, aOuter, rgba, aOuter + fringe, transparent);
+		if (aInnerFringe)
+			band_vertices(vertices, aOutline, normals, aClosed, aInner, rgba, aInner - fringe, transparent);
+		opengl_command_buffer::render_state state{ opengl_command_buffer::Primitive, GL_TRIANGLES, 0, false, iSmoothingMode, 0.0, iScissor };
+		iCommandBuffer->add(state, vertices.data(), vertices.data() + vertices.size());
+		commit();
+	}
 
-		glCheck(glEnable(GL_BLEND));
-		glCheck(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+	bool opengl_graphics_context::analytic_anti_alias() const
+	{
+		return iSmoothingMode == SmoothingModeAntiAlias;
+	}
 
-		disable_anti_alias daa(*this);
-		glCheck(glDrawArrays(GL_QUADS, 0, vertices.size()));
+	void opengl_graphics_context::append_glyph(opengl_command_buffer::vertices_t& aVertices, const point& aPoint, const i_glyph_texture& aGlyphTexture, const font& aFont, const colour& aColour) const
+	{
+		point glyphOrigin(aPoint.x + aGlyphTexture.placement().x, 
+			logical_coordinates()[1] < logical_coordinates()[3] ? 
+				aPoint.y + (aGlyphTexture.placement().y + -aFont.descender()) :
+				aPoint.y + aFont.height() - (aGlyphTexture.placement().y + -aFont.descender()) - aGlyphTexture.extents().cy);
 
-		glCheck(glBindVertexArray(previousVertexArrayBinding));
+		bool lcdMode = iRenderingEngine.screen_metrics().subpixel_format() == i_screen_metrics::SubpixelFormatRGBHorizontal ||
+			iRenderingEngine.screen_metrics().subpixel_format() == i_screen_metrics::SubpixelFormatBGRHorizontal;
 
-		glCheck(glBindBuffer(GL_ARRAY_BUFFER, previousArrayBufferBinding));
+		const size& textureExtents = aGlyphTexture.font_texture().extents();
+		GLfloat s1 = static_cast<GLfloat>(aGlyphTexture.font_texture_location().x / textureExtents.cx);
+		GLfloat s2 = static_cast<GLfloat>((aGlyphTexture.font_texture_location().x + aGlyphTexture.extents().cx * (lcdMode ? 3.0 : 1.0)) / textureExtents.cx);
+		GLfloat t1 = static_cast<GLfloat>(aGlyphTexture.font_texture_location().y / textureExtents.cy);
+		GLfloat t2 = static_cast<GLfloat>((aGlyphTexture.font_texture_location().y + aGlyphTexture.extents().cy) / textureExtents.cy);
+		if (logical_coordinates()[1] < logical_coordinates()[3])
+			std::swap(t1, t2);
 
-		glCheck(glDeleteVertexArrays(1, &vaoHandle));
+		auto rgba = to_rgba(aColour);
+		aVertices.push_back(make_vertex(glyphOrigin, rgba, s1, t1));
+		aVertices.push_back(make_vertex(glyphOrigin + point(0.0, aGlyphTexture.extents().cy), rgba, s1, t2));
+		aVertices.push_back(make_vertex(glyphOrigin + point(aGlyphTexture.extents().cx, aGlyphTexture.extents().cy), rgba, s2, t2));
+		aVertices.push_back(make_vertex(glyphOrigin + point(aGlyphTexture.extents().cx, 0.0), rgba, s2, t1));
+	}
 
-		glCheck(glDeleteBuffers(3, boHandles));
+	void opengl_graphics_context::append_glyph_underline(opengl_command_buffer::vertices_t& aVertices, const point& aPoint, const i_glyph_texture& aGlyphTexture, const font& aFont, const colour& aColour) const
+	{
+		// a negative texture coordinate tells the glyph shader to output solid colour
+		auto yLine = logical_coordinates()[1] > logical_coordinates()[3] ?
+			(aFont.height() + aFont.descender()) - std::ceil(aFont.native_font_face().underline_position()) :
+			-aFont.descender() + std::ceil(aFont.native_font_face().underline_position());
+		auto thickness = std::ceil(aFont.native_font_face().underline_thickness());
+		rect underline{ 
+			aPoint + point{ aGlyphTexture.placement().x, yLine + pixel_adjust(thickness) - thickness / 2.0 }, 
+			size{ aGlyphTexture.extents().cx, thickness } };
+		auto rgba = to_rgba(aColour);
+		aVertices.push_back(make_vertex(underline.top_left(), rgba, -1.0f, -1.0f));
+		aVertices.push_back(make_vertex(underline.bottom_left(), rgba, -1.0f, -1.0f));
+		aVertices.push_back(make_vertex(underline.bottom_right(), rgba, -1.0f, -1.0f));
+		aVertices.push_back(make_vertex(underline.top_right(), rgba, -1.0f, -1.0f));
 	}
 
-	void opengl_graphics_context::end_drawing_glyphs()
+	opengl_command_buffer::vertices_t& opengl_graphics_context::vertex_arena()
 	{
-		glCheck(glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(iPreviousTexture)));
+		iVertices.clear();
+		return iVertices;
+	}
 
-		iRenderingEngine.deactivate_shader_program();
+	opengl_command_buffer::vertices_t& opengl_graphics_context::outline_arena()
+	{
+		// outlines that are anti-aliased after their geometry has been drawn are kept here as draw_outline() reuses 
+		// the vertex arena
+		iOutlineVertices.clear();
+		return iOutlineVertices;
 	}
 
-	void opengl_graphics_context::draw_texture(const texture_map& aTextureMap, const i_texture& aTexture, const rect& aTextureRect, const optional_colour& aColour)
-	{	
-		if (aTexture.is_empty())
-			return;
-		glCheck(glActiveTexture(GL_TEXTURE1));
-		glCheck(glClientActiveTexture(GL_TEXTURE1));
-		glCheck(glEnable(GL_TEXTURE_2D));
-		glCheck(glEnable(GL_BLEND));
-		glCheck(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
-		GLint previousTexture;
-		glCheck(glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture));
-		glCheck(glBindTexture(GL_TEXTURE_2D, reinterpret_cast<GLuint>(aTexture.native_texture()->handle())));
-		if (!aTexture.native_texture()->is_resident())
-			throw texture_not_resident();
-		auto texCoords = texture_vertices(aTexture.storage_extents(), aTextureRect);
-		if (logical_coordinates()[1] < logical_coordinates()[3])
-		{
-			std::swap(texCoords[1], texCoords[5]);
-			std::swap(texCoords[3], texCoords[7]);
-		}
-		glCheck(glVertexPointer(2, GL_DOUBLE, 0, &aTextureMap[0][0]));
-		glCheck(glTexCoordPointer(2, GL_DOUBLE, 0, &texCoords[0]));
-		colour c{0xFF, 0xFF, 0xFF, 0xFF};
-		if (aColour != boost::none)
-			c = *aColour;
-		std::vector<std::array<uint8_t, 4>> colours(4, std::array <uint8_t, 4>{{c.red(), c.green(), c.blue(), c.alpha()}});
-		glCheck(glColorPointer(4, GL_UNSIGNED_BYTE, 0, &colours[0]));
-		if (iMonochrome)
+	void opengl_graphics_context::draw_vertices(GLenum aMode, const colour& aColour, dimension aLineWidth, opengl_command_buffer::kind_e aKind)
+	{
+		bool lines = (aMode == GL_LINES || aMode == GL_LINE_LOOP || aMode == GL_LINE_STRIP);
+		if (lines && analytic_anti_alias() && iLineStipple == boost::none)
 		{
-			iRenderingEngine.activate_shader_program(iRenderingEngine.monochrome_shader_program());
-			iRenderingEngine.monochrome_shader_program().set_uniform_variable("tex", 1);
+			// anti-aliased lines get coverage fringes in place of GL_LINE_SMOOTH
+			auto& lineVertices = outline_arena();
+			lineVertices.assign(iVertices.begin(), iVertices.end());
+			if (aMode == GL_LINES)
+			{
+				for (std::size_t i = 0; i + 1 < lineVertices.size(); i += 2)
+				{
+					polyline segment{ point{ lineVertices[i].xy[0], lineVertices[i].xy[1] }, point{ lineVertices[i + 1].xy[0], lineVertices[i + 1].xy[1] } };
+					if (segment[0] != segment[1])
+						draw_outline(segment, false, -aLineWidth / 2.0, aLineWidth / 2.0, true, aColour);
+				}
+			}
+			else
+				draw_outline(lineVertices, 0, aMode == GL_LINE_LOOP, -aLineWidth / 2.0, aLineWidth / 2.0, true, aColour);
+			return;
 		}
-		glCheck(glDrawArrays(GL_QUADS, 0, 4));
-		if (iMonochrome)
-			iRenderingEngine.deactivate_shader_program();
-		glCheck(glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(previousTexture)));
+		auto rgba = to_rgba(aColour);
+		for (auto& v : iVertices)
+			v.rgba = rgba;
+		opengl_command_buffer::render_state state{ aKind, aMode, 0, false, iSmoothingMode, aLineWidth, iScissor };
+		iCommandBuffer->add(state, iVertices.data(), iVertices.data() + iVertices.size(), iLineStipple);
+		commit();
 	}
 
-	opengl_graphics_context::vertex opengl_graphics_context::to_shader_vertex(const point& aPoint) const
+	void opengl_graphics_context::draw_gradient_shape(const rect& aShape, dimension aRadius, const gradient& aGradient)
 	{
-		return vertex{{aPoint.x, aPoint.y, 0.0}};
+		// pending commands of this graphics context may refer to the lookup table row that is about to be reused
+		auto& gradientCache = rendering_engine().gradient_cache();
+		if (gradientCache.full() && !gradientCache.contains(aGradient))
+			flush();
+		uint32_t row = gradientCache.row(aGradient);
+		// the gradient shader reads the lookup table row and direction from the shape colour
+		std::array<uint8_t, 4> rgba{{ static_cast<uint8_t>(row & 0xFF), static_cast<uint8_t>(row >> 8), static_cast<uint8_t>(aGradient.direction()), 0xFF }};
+		opengl_command_buffer::render_state state{ opengl_command_buffer::Gradient, GL_TRIANGLES, 0, false, iSmoothingMode, 0.0, iScissor };
+		iCommandBuffer->add(state, make_shape(aShape, aRadius, 0.0, rgba));
+		commit();
 	}
 
-	glyph_text::container opengl_graphics_context::to_glyph_text_impl(string::const_iterator aTextBegin, string::const_iterator aTextEnd, std::function<font(std::string::size_type)> aFontSelector, bool& aFallbackFontNeeded) const
+	void opengl_graphics_context::draw_shape(const rect& aShape, dimension aRadius, dimension aOutlineWidth, const colour& aColour)
 	{
-		glyph_text::container result;
-		aFallbackFontNeeded = false;
-		if (aTextEnd - aTextBegin == 0)
-			return result;
+		opengl_command_buffer::render_state state{ opengl_command_buffer::Shape, GL_TRIANGLES, 0, false, iSmoothingMode, 0.0, iScissor };
+		iCommandBuffer->add(state, make_shape(aShape, aRadius, aOutlineWidth, to_rgba(aColour)));
+		commit();
+	}
 
-		auto& clusterMap = iClusterMap;
-		clusterMap.clear();
-		auto& textDirections = iTextDirections;
-		textDirections.clear();
+	opengl_command_buffer::render_state opengl_graphics_context::glyph_state(const i_font_texture& aFontTexture) const
+	{
+		return opengl_command_buffer::render_state{ opengl_command_buffer::Glyph, GL_QUADS, reinterpret_cast<GLuint>(aFontTexture.handle()), 
+			false, SmoothingModeNone, 0.0, iScissor };
+	}
 
-		iCodePointsBuffer.clear();
-		std::u32string& codePoints = iCodePointsBuffer;
+	void opengl_graphics_context::commit()
+	{
+		if (iRecording == 0 && !iDrawingGlyphs)
+			flush();
+	}
 
-		codePoints = neolib::utf8_to_utf32(aTextBegin, aTextEnd, [&clusterMap](std::string::size_type aFrom, std::u32string::size_type)
+	void opengl_graphics_context::replay()
+	{
+		const auto& batches = iCommandBuffer->build_batches();
+		const auto& vertices = iCommandBuffer->vertices();
+		const auto& shapes = iCommandBuffer->shapes();
+		if (batches.empty())
+			return;
+
+		auto& program = iRenderingEngine.default_shader_program();
+		const auto& uniforms = rendering_engine().default_shader_program_uniforms();
+		iRenderingEngine.activate_shader_program(program);
+		program.set_uniform_matrix(uniforms.projection, projection_matrix());
+
+		auto& state = rendering_engine().state();
+		state.bind_texture(GL_TEXTURE2, rendering_engine().gradient_cache().texture());
+		auto& counters = state.counters();
+		std::size_t base = 0;
+		if (!vertices.empty())
 		{
-			clusterMap.push_back(cluster{aFrom});
-		});
-		
-		if (iMnemonic != boost::none)
+			state.bind_array_buffer(rendering_engine().vertex_buffer().handle());
+			base = rendering_engine().vertex_buffer().append(vertices.data(), vertices.size());
+			counters.bufferBytesUploaded += vertices.size() * sizeof(opengl_command_buffer::vertex);
+		}
+		std::size_t shapeBase = 0;
+		if (!shapes.empty())
 		{
-			for (auto i = codePoints.begin(); i != codePoints.end();)
-			{
-				if (*i == static_cast<char32_t>(iMnemonic->second))
-				{
-					clusterMap.erase(clusterMap.begin() + (i - codePoints.begin()));
-					i = codePoints.erase(i);
-					if (i != codePoints.end())
-					{
-						auto& cluster = *(clusterMap.begin() + (i - codePoints.begin()));
-						if (*i != static_cast<char32_t>(iMnemonic->second))
-							cluster.flags = glyph::Mnemonic;
-					}
-				}
-				else
-					++i;
-			}
+			state.bind_array_buffer(rendering_engine().shape_buffer().handle());
+			shapeBase = rendering_engine().shape_buffer().append(shapes.data(), shapes.size());
+			counters.bufferBytesUploaded += shapes.size() * sizeof(opengl_command_buffer::shape);
 		}
+		state.enable(GL_BLEND);
+		state.blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-		if (codePoints.empty())
-			return result;
-		
-		auto& runs = iRuns;
-		runs.clear();
-		text_direction previousDirection = get_text_direction(codePoints[0]);
-		char32_t* runStart = &codePoints[0];
-		std::size_t lastCodePointIndex = codePoints.size() - 1;
-		font previousFont = aFontSelector(clusterMap[0].from);
-		hb_script_t previousScript = hb_unicode_script(static_cast<native_font_face::hb_handle*>(previousFont.native_font_face().aux_handle())->unicodeFuncs, codePoints[0]);
-
-		std::deque<std::pair<text_direction, bool>> directionStack;
-		const char32_t LRE = U'\u202A';
-		const char32_t RLE = U'\u202B';
-		const char32_t LRO = U'\u202D';
-		const char32_t RLO = U'\u202E';
-		const char32_t PDF = U'\u202C';
-
-		bool currentLineHasLTR = false;
-
-		for (std::size_t i = 0; i <= lastCodePointIndex; ++i)
+		std::size_t appliedScissor = static_cast<std::size_t>(-1);
+		int appliedMode = -1;
+		int appliedAntiAlias = -1;
+		for (const auto& b : batches)
 		{
-			font currentFont = aFontSelector(clusterMap[i].from);
-			if (currentFont.password())
-				codePoints[i] = neolib::utf8_to_utf32(currentFont.password_mask())[0];
-			if (codePoints[i] == '\r' || codePoints[i] == '\n')
-				currentLineHasLTR = false;
-			switch (codePoints[i])
+			if (b.state.scissor != appliedScissor)
 			{
-			case PDF:
-				if (!directionStack.empty())
-					directionStack.pop_back();
-				break;
-			case LRE:
-				directionStack.push_back(std::make_pair(text_direction::LTR, false));
-				break;
-			case RLE:
-				directionStack.push_back(std::make_pair(text_direction::RTL, false));
-				break;
-			case LRO:
-				directionStack.push_back(std::make_pair(text_direction::LTR, true));
-				break;
-			case RLO:
-				directionStack.push_back(std::make_pair(text_direction::RTL, true));
-				break;
-			default:
-				break;
+				appliedScissor = b.state.scissor;
+				apply_scissor(appliedScissor);
 			}
-			hb_unicode_funcs_t* unicodeFuncs = static_cast<native_font_face::hb_handle*>(currentFont.native_font_face().aux_handle())->unicodeFuncs;
-			text_direction currentDirection = get_text_direction(codePoints[i]);
-			textDirections.push_back(currentDirection);
-			auto bidi_check = [&directionStack](text_direction aDirection)
+			int mode = shader_mode(b.state);
+			if (mode != appliedMode)
 			{
-				if (!directionStack.empty())
-				{
-					switch (aDirection)
-					{
-					case text_direction::LTR:
-					case text_direction::RTL:
-						if (directionStack.back().second == true)
-							return directionStack.back().first;
-						break;
-					case text_direction::None:
-					case text_direction::Whitespace:
-						return directionStack.back().first;
-						break;
-					default:
-						break;
-					}
-				}
-				return aDirection;
-			};
-			currentDirection = bidi_check(currentDirection);
-			if (currentDirection == text_direction::LTR)
-				currentLineHasLTR = true;
-			hb_script_t currentScript = hb_unicode_script(unicodeFuncs, codePoints[i]);
-			bool newRun = previousFont != currentFont || (previousDirection == text_direction::LTR && currentDirection == text_direction::RTL) ||
-				(previousDirection == text_direction::RTL && currentDirection == text_direction::LTR) ||
-				(previousScript != currentScript && (previousScript != HB_SCRIPT_COMMON && currentScript != HB_SCRIPT_COMMON)) ||
-				i == lastCodePointIndex;
-			if (!newRun)
+				appliedMode = mode;
+				program.set_uniform_variable(uniforms.mode, mode);
+			}
+			int antiAlias = b.state.smoothingMode == SmoothingModeAntiAlias ? 1 : 0;
+			if (opengl_command_buffer::is_shape(b.state) && antiAlias != appliedAntiAlias)
 			{
-				if ((currentDirection == text_direction::Whitespace || currentDirection == text_direction::None) && previousDirection == text_direction::RTL)
-				{
-					for (std::size_t j = i + 1; j <= lastCodePointIndex; ++j)
-					{
-						text_direction nextDirection = bidi_check(get_text_direction(codePoints[j]));
-						if (nextDirection == text_direction::RTL)
-							break;
-						else if (nextDirection == text_direction::LTR || (j == lastCodePointIndex - 1 && currentLineHasLTR))
-						{
-							newRun = true;
-							currentDirection = text_direction::LTR;
-							break;
-						}
-					}
-				}
+				appliedAntiAlias = antiAlias;
+				program.set_uniform_variable(uniforms.antiAlias, antiAlias);
 			}
-			if (newRun)
+			if (b.state.kind == opengl_command_buffer::Texture || b.state.kind == opengl_command_buffer::Glyph)
+				state.bind_texture(GL_TEXTURE1, b.state.texture);
+			if (opengl_command_buffer::is_shape(b.state))
 			{
-				runs.push_back(std::make_tuple(runStart, &codePoints[i != lastCodePointIndex ? i : i+1], previousDirection, previousScript));
-				runStart = &codePoints[i];
+				state.bind_vertex_array(rendering_engine().shape_vertex_array());
+				state.bind_array_buffer(rendering_engine().shape_buffer().handle());
+				rendering_engine().set_shape_attributes(shapeBase + b.first);
+				glCheck(glDrawArraysInstanced(GL_TRIANGLES, 0, 6, static_cast<GLsizei>(b.count)));
+				counters.vertices += b.count * 6;
 			}
-			if (currentDirection == text_direction::LTR || currentDirection == text_direction::RTL)
+			else
 			{
-				previousDirection = currentDirection;
-				previousScript = currentScript;
+				state.bind_vertex_array(rendering_engine().vertex_array());
+				glCheck(glDrawArrays(b.state.mode, static_cast<GLint>(base + b.first), static_cast<GLsizei>(b.count)));
+				counters.vertices += b.count;
 			}
-			previousFont = currentFont;
+			++counters.drawCalls;
 		}
 
-		for (std::size_t i = 0; i < runs.size(); ++i)
+		iRenderingEngine.deactivate_shader_program();
+	}
+
+	int opengl_graphics_context::shader_mode(const opengl_command_buffer::render_state& aState) const
+	{
+		// must match the uMode values understood by the default fragment shader
+		switch (aState.kind)
 		{
-			std::string::size_type sourceClusterRunStart = (clusterMap.begin() + (std::get<0>(runs[i]) - &codePoints[0]))->from;
-			hb_font_t* hbFont = static_cast<native_font_face::hb_handle*>(aFontSelector(sourceClusterRunStart).native_font_face().aux_handle())->font;
-			hb_buffer_t* buf = static_cast<native_font_face::hb_handle*>(aFontSelector(sourceClusterRunStart).native_font_face().aux_handle())->buf;
-			hb_buffer_set_direction(buf, std::get<2>(runs[i]) == text_direction::RTL ? HB_DIRECTION_RTL : HB_DIRECTION_LTR);
-			hb_buffer_set_script(buf, std::get<3>(runs[i]));
-			hb_buffer_add_utf32(buf, reinterpret_cast<const uint32_t*>(std::get<0>(runs[i])), std::get<1>(runs[i]) - std::get<0>(runs[i]), 0, std::get<1>(runs[i]) - std::get<0>(runs[i]));
-			hb_shape(hbFont, buf, NULL, 0);
-			unsigned int glyphCount;
-			hb_glyph_info_t* glyphInfo = hb_buffer_get_glyph_infos(buf, &glyphCount);
-			hb_glyph_position_t* glyphPos = hb_buffer_get_glyph_positions(buf, &glyphCount);
-			for (unsigned int j = 0; j < glyphCount; ++j)
-			{
-				std::u32string::size_type cluster = glyphInfo[j].cluster + (std::get<0>(runs[i]) - &codePoints[0]);
-				if (glyphInfo[j].codepoint == 0)
-					glyphInfo[j].codepoint = aFontSelector(sourceClusterRunStart).native_font_face().glyph_index(codePoints[cluster]);
-				if (glyphInfo[j].codepoint == 0)
-					aFallbackFontNeeded = true;
-				std::string::size_type sourceClusterStart, sourceClusterEnd;
-				auto c = clusterMap.begin() + cluster;
-				sourceClusterStart = c->from;
-				if (c + 1 != clusterMap.end())
-					sourceClusterEnd = (c + 1)->from;
-				else
-					sourceClusterEnd = aTextEnd - aTextBegin;
-				if (j > 0)
-					result.back().kerning_adjust(static_cast<float>(aFontSelector(sourceClusterStart).kerning(glyphInfo[j - 1].codepoint, glyphInfo[j].codepoint)));
-				result.push_back(glyph(textDirections[cluster], glyphInfo[j].codepoint, glyph::source_type(sourceClusterStart, sourceClusterEnd), size(glyphPos[j].x_advance / 64.0, glyphPos[j].y_advance / 64.0), size(glyphPos[j].x_offset / 64.0, glyphPos[j].y_offset / 64.0)));
-				if (result.back().direction() == text_direction::Whitespace)
-					result.back().set_value(aTextBegin[sourceClusterStart]);
-				if ((aFontSelector(sourceClusterStart).style() & font::Underline) == font::Underline)
-					result.back().set_underline(true);
-				if ((c->flags & glyph::Mnemonic) == glyph::Mnemonic)
-					result.back().set_mnemonic(true);
-				if (glyphInfo[j].codepoint == 0)
-					result.back().set_use_fallback(true);
-			}
-			hb_buffer_clear_contents(buf);
+		case opengl_command_buffer::Texture:
+			return aState.monochrome ? 2 : 1;
+		case opengl_command_buffer::Glyph:
+			return 3;
+		case opengl_command_buffer::Shape:
+			return 4;
+		case opengl_command_buffer::Gradient:
+			return 5;
+		case opengl_command_buffer::Primitive:
+		default:
+			return 0;
 		}
+	}
 
-		return result;
+	matrix44 opengl_graphics_context::projection_matrix() const
+	{
+		const auto& logicalCoordinates = logical_coordinates();
+		double left = logicalCoordinates[0];
+		double bottom = logicalCoordinates[1];
+		double right = logicalCoordinates[2];
+		double top = logicalCoordinates[3];
+		return matrix44{ 
+			{ 2.0 / (right - left), 0.0, 0.0, 0.0 },
+			{ 0.0, 2.0 / (top - bottom), 0.0, 0.0 },
+			{ 0.0, 0.0, -1.0, 0.0 },
+			{ -(right + left) / (right - left), -(top + bottom) / (top - bottom), 0.0, 1.0 } };
 	}
 }
\ No newline at end of file
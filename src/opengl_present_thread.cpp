@@ -0,0 +1,216 @@
+// opengl_present_thread.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "neogfx.hpp"
+#include "opengl_error.hpp"
+#include "opengl_state.hpp"
+#include "opengl_present_thread.hpp"
+
+namespace neogfx
+{
+	opengl_present_thread::opengl_present_thread(void* aContext, make_current_function aMakeCurrent, display_function aDisplay) :
+		iContext(aContext),
+		iMakeCurrent(aMakeCurrent),
+		iDisplay(aDisplay),
+		iCopyFrameBuffer(0),
+		iFramesPresented(0),
+		iFramesReplaced(0),
+		iStop(false)
+	{
+		for (auto& s : iSlots)
+			s = slot{ slot_state::Free, 0, size{}, size{}, 0, region{} };
+		glCheck(glGenFramebuffers(1, &iCopyFrameBuffer));
+		iThread = std::thread([this]() { run(); });
+	}
+
+	opengl_present_thread::~opengl_present_thread()
+	{
+		{
+			std::lock_guard<std::mutex> lock(iMutex);
+			iStop = true;
+		}
+		iCondition.notify_one();
+		iThread.join();
+		// the presenting thread has gone so what remains belongs to the GUI thread (whose context is current)
+		for (auto& s : iSlots)
+		{
+			if (s.fence != 0)
+				glDeleteSync(s.fence);
+			if (s.texture != 0)
+			{
+				glDeleteTextures(1, &s.texture);
+				opengl_state::texture_deleted(s.texture);
+			}
+		}
+		glDeleteFramebuffers(1, &iCopyFrameBuffer);
+		opengl_state::frame_buffer_deleted(iCopyFrameBuffer);
+	}
+
+	void opengl_present_thread::submit(GLuint aFrameBuffer, const size& aExtents, const std::vector<rect>& aDamagedRects)
+	{
+		slot* target = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(iMutex);
+			if (iError)
+			{
+				auto error = iError;
+				iError = nullptr;
+				std::rethrow_exception(error);
+			}
+			// the presenting thread holds at most one slot so there is always either a pending submission to replace or
+			// a free slot
+			for (auto& s : iSlots)
+				if (s.state == slot_state::Pending)
+				{
+					target = &s;
+					++iFramesReplaced;
+				}
+			if (target == nullptr)
+				for (auto& s : iSlots)
+					if (s.state == slot_state::Free)
+					{
+						target = &s;
+						break;
+					}
+			target->state = slot_state::Writing;
+		}
+		if (target->fence != 0)
+		{
+			glDeleteSync(target->fence);
+			target->fence = 0;
+		}
+		auto& state = opengl_state::current();
+		if (target->textureExtents.cx < aExtents.cx || target->textureExtents.cy < aExtents.cy)
+		{
+			if (target->texture != 0)
+			{
+				glCheck(glDeleteTextures(1, &target->texture));
+				opengl_state::texture_deleted(target->texture);
+			}
+			target->textureExtents = aExtents;
+			glCheck(glGenTextures(1, &target->texture));
+			state.bind_texture(target->texture);
+			glCheck(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, static_cast<GLsizei>(aExtents.cx), static_cast<GLsizei>(aExtents.cy), 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL));
+			glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+			glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+		}
+		// the whole frame is copied as this slot last held a frame from two or more submissions ago
+		GLuint previousReadFrameBuffer = state.read_frame_buffer();
+		GLuint previousDrawFrameBuffer = state.draw_frame_buffer();
+		state.bind_frame_buffer(GL_READ_FRAMEBUFFER, aFrameBuffer);
+		state.bind_frame_buffer(GL_DRAW_FRAMEBUFFER, iCopyFrameBuffer);
+		glCheck(glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target->texture, 0));
+		state.disable(GL_SCISSOR_TEST);
+		GLint cx = static_cast<GLint>(aExtents.cx);
+		GLint cy = static_cast<GLint>(aExtents.cy);
+		glCheck(glBlitFramebuffer(0, 0, cx, cy, 0, 0, cx, cy, GL_COLOR_BUFFER_BIT, GL_NEAREST));
+		state.bind_frame_buffer(GL_READ_FRAMEBUFFER, previousReadFrameBuffer);
+		state.bind_frame_buffer(GL_DRAW_FRAMEBUFFER, previousDrawFrameBuffer);
+		GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		glCheck(glFlush());
+		{
+			std::lock_guard<std::mutex> lock(iMutex);
+			target->fence = fence;
+			if (target->frameExtents != aExtents)
+				target->damage = rect{ point{}, aExtents };
+			target->frameExtents = aExtents;
+			for (const auto& dr : aDamagedRects)
+				target->damage.combine(dr);
+			target->state = slot_state::Pending;
+		}
+		iCondition.notify_one();
+	}
+
+	uint64_t opengl_present_thread::frames_presented() const
+	{
+		std::lock_guard<std::mutex> lock(iMutex);
+		return iFramesPresented;
+	}
+
+	uint64_t opengl_present_thread::frames_replaced() const
+	{
+		std::lock_guard<std::mutex> lock(iMutex);
+		return iFramesReplaced;
+	}
+
+	void opengl_present_thread::run()
+	{
+		GLuint readFrameBuffer = 0;
+		try
+		{
+			iMakeCurrent(iContext);
+			glCheck(glGenFramebuffers(1, &readFrameBuffer));
+			for (;;)
+			{
+				slot* pending = nullptr;
+				std::vector<rect> damagedRects;
+				{
+					std::unique_lock<std::mutex> lock(iMutex);
+					iCondition.wait(lock, [this, &pending]()
+					{
+						for (auto& s : iSlots)
+							if (s.state == slot_state::Pending)
+								pending = &s;
+						return iStop || pending != nullptr;
+					});
+					if (iStop)
+						break;
+					pending->state = slot_state::Presenting;
+					damagedRects = pending->damage.coverage(MaxDamagedRects);
+					pending->damage.clear();
+				}
+				present(*pending, damagedRects, readFrameBuffer);
+				{
+					std::lock_guard<std::mutex> lock(iMutex);
+					pending->state = slot_state::Free;
+					++iFramesPresented;
+				}
+			}
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(iMutex);
+			iError = std::current_exception();
+		}
+		if (readFrameBuffer != 0)
+			glDeleteFramebuffers(1, &readFrameBuffer);
+		iMakeCurrent(nullptr);
+	}
+
+	void opengl_present_thread::present(slot& aSlot, const std::vector<rect>& aDamagedRects, GLuint aReadFrameBuffer)
+	{
+		// this thread's context is not shadowed by an opengl_state tracker so GL is used directly
+		glCheck(glWaitSync(aSlot.fence, 0, GL_TIMEOUT_IGNORED));
+		glDeleteSync(aSlot.fence);
+		aSlot.fence = 0;
+		glCheck(glBindFramebuffer(GL_READ_FRAMEBUFFER, aReadFrameBuffer));
+		glCheck(glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, aSlot.texture, 0));
+		glCheck(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0));
+		for (const auto& dr : aDamagedRects)
+		{
+			GLint x0 = static_cast<GLint>(dr.left());
+			GLint y0 = static_cast<GLint>(aSlot.frameExtents.cy - dr.bottom());
+			GLint x1 = static_cast<GLint>(dr.right());
+			GLint y1 = static_cast<GLint>(aSlot.frameExtents.cy - dr.top());
+			glCheck(glBlitFramebuffer(x0, y0, x1, y1, x0, y0, x1, y1, GL_COLOR_BUFFER_BIT, GL_NEAREST));
+		}
+		iDisplay(aSlot.frameExtents, aDamagedRects);
+	}
+}
@@ -24,10 +24,16 @@
 #endif
 #include "opengl_renderer.hpp"
 #include "opengl_window.hpp"
-#include "subpixel_rgb_horizontal.frag.glsl.hpp"
+#include "opengl_command_buffer.hpp"
 
 namespace neogfx
 {
+	namespace
+	{
+		const std::size_t VERTEX_BUFFER_INITIAL_CAPACITY = 4096 * 4;
+		const std::size_t SHAPE_BUFFER_INITIAL_CAPACITY = 1024;
+	}
+
 	detail::screen_metrics::screen_metrics() :
 		iSubpixelFormat(SubpixelFormatUnknown)
 	{
@@ -106,28 +112,56 @@ namespace neogfx
 		return reinterpret_cast<void*>(v->second);
 	}
 
+	opengl_renderer::shader_program::uniform_id opengl_renderer::shader_program::uniform(const std::string& aName) const
+	{
+		auto u = iUniforms.find(aName);
+		if (u == iUniforms.end())
+			throw variable_not_found();
+		return u->second;
+	}
+
 	void opengl_renderer::shader_program::set_uniform_variable(const std::string& aName, double aValue)
 	{
-		glUniform1d(uniform_location(aName), aValue);
-		GLenum errorCode = glGetError();
-		if (errorCode != GL_NO_ERROR)
-			throw shader_program_error(errorCode);
+		set_uniform_variable(uniform(aName), aValue);
 	}
 
 	void opengl_renderer::shader_program::set_uniform_variable(const std::string& aName, int aValue)
 	{
-		glUniform1i(uniform_location(aName), aValue);
-		GLenum errorCode = glGetError();
-		if (errorCode != GL_NO_ERROR)
-			throw shader_program_error(errorCode);
+		set_uniform_variable(uniform(aName), aValue);
 	}
 
 	void opengl_renderer::shader_program::set_uniform_variable(const std::string& aName, double aValue1, double aValue2)
 	{
-		glUniform2d(uniform_location(aName), aValue1, aValue2);
-		GLenum errorCode = glGetError();
-		if (errorCode != GL_NO_ERROR)
-			throw shader_program_error(errorCode);
+		set_uniform_variable(uniform(aName), aValue1, aValue2);
+	}
+
+	void opengl_renderer::shader_program::set_uniform_matrix(const std::string& aName, const matrix44& aMatrix)
+	{
+		set_uniform_matrix(uniform(aName), aMatrix);
+	}
+
+	void opengl_renderer::shader_program::set_uniform_variable(uniform_id aUniform, double aValue)
+	{
+		glCheck(glUniform1f(iUniformLocations[aUniform], static_cast<GLfloat>(aValue)));
+	}
+
+	void opengl_renderer::shader_program::set_uniform_variable(uniform_id aUniform, int aValue)
+	{
+		glCheck(glUniform1i(iUniformLocations[aUniform], aValue));
+	}
+
+	void opengl_renderer::shader_program::set_uniform_variable(uniform_id aUniform, double aValue1, double aValue2)
+	{
+		glCheck(glUniform2f(iUniformLocations[aUniform], static_cast<GLfloat>(aValue1), static_cast<GLfloat>(aValue2)));
+	}
+
+	void opengl_renderer::shader_program::set_uniform_matrix(uniform_id aUniform, const matrix44& aMatrix)
+	{
+		std::array<GLfloat, 16> columnMajor;
+		for (uint32_t column = 0; column < 4; ++column)
+			for (uint32_t row = 0; row < 4; ++row)
+				columnMajor[column * 4 + row] = static_cast<GLfloat>(aMatrix[column][row]);
+		glCheck(glUniformMatrix4fv(iUniformLocations[aUniform], 1, GL_FALSE, &columnMajor[0]));
 	}
 
 	GLuint opengl_renderer::shader_program::register_variable(const std::string& aVariableName)
@@ -137,111 +171,178 @@ namespace neogfx
 		return index;
 	}
 
-	bool opengl_renderer::shader_program::operator<(const shader_program& aRhs) const
+	void opengl_renderer::shader_program::resolve_uniforms()
 	{
-		return iHandle < aRhs.iHandle;
+		iUniforms.clear();
+		iUniformLocations.clear();
+		GLint activeUniforms = 0;
+		glCheck(glGetProgramiv(iHandle, GL_ACTIVE_UNIFORMS, &activeUniforms));
+		GLint maxNameLength = 0;
+		glCheck(glGetProgramiv(iHandle, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength));
+		std::vector<GLchar> nameBuffer(std::max<GLint>(maxNameLength, 1));
+		for (GLint i = 0; i < activeUniforms; ++i)
+		{
+			GLsizei nameLength = 0;
+			GLint size = 0;
+			GLenum type = 0;
+			glCheck(glGetActiveUniform(iHandle, static_cast<GLuint>(i), static_cast<GLsizei>(nameBuffer.size()), &nameLength, &size, &type, &nameBuffer[0]));
+			std::string name(&nameBuffer[0], nameLength);
+			// arrays are reported by the name of their first element
+			if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+				name.resize(name.size() - 3);
+			GLint location = glCheck(glGetUniformLocation(iHandle, name.c_str()));
+			iUniforms[name] = static_cast<uniform_id>(iUniformLocations.size());
+			iUniformLocations.push_back(location);
+		}
 	}
 
-	GLint opengl_renderer::shader_program::uniform_location(const std::string& aName)
+	bool opengl_renderer::shader_program::operator<(const shader_program& aRhs) const
 	{
-		GLint var = glGetUniformLocation(iHandle, aName.c_str());
-		GLenum errorCode = glGetError();
-		if (errorCode != GL_NO_ERROR)
-			throw shader_program_error(errorCode);
-		return var;
+		return iHandle < aRhs.iHandle;
 	}
 
 	opengl_renderer::opengl_renderer() :
 		iFontManager(*this, iScreenMetrics),
-		iActiveProgram(iShaderPrograms.end())
+		iActiveProgram(iShaderPrograms.end()),
+		iActiveContext(nullptr),
+		iStatistics{}
+	{
+	}
+
+	opengl_renderer::~opengl_renderer()
 	{
 	}
 
 	void opengl_renderer::initialize()
 	{
-		glCheck(glewInit());
-		iMonochromeProgram = create_shader_program(
+		// a core profile context has no extension string for GLEW to read so it has to be told to look the entry points up 
+		// regardless, which leaves behind an error that is not ours
+		glewExperimental = GL_TRUE;
+		if (glewInit() != GLEW_OK)
+			throw failed_to_initialize();
+		glGetError();
+		// the default shader program needs GLSL 1.50
+		if (!GLEW_VERSION_3_2)
+			throw failed_to_initialize();
+		// analytic shapes are drawn instanced
+		if (!GLEW_VERSION_3_3 && !GLEW_ARB_instanced_arrays)
+			throw failed_to_initialize();
+		iDefaultProgram = create_shader_program(
 			shaders
 			{
 				std::make_pair(
 					std::string(
-						"#version 130\n"
-						"uniform sampler2D tex;"
-						"void main()\n"
-						"{\n"
-						"	float gray = dot(gl_Color.rgb * texture2D(tex, gl_TexCoord[1].xy).rgb, vec3(0.299, 0.587, 0.114));\n"
-						"	gl_FragColor = vec4(gray, gray, gray, gl_Color.a * texture2D(tex, gl_TexCoord[1].xy).a);\n"
-						"}\n"),
-					GL_FRAGMENT_SHADER) 
-			}, {});
-		switch (screen_metrics().subpixel_format())
-		{
-		case i_screen_metrics::SubpixelFormatRGBHorizontal:
-			iSubpixelProgram = create_shader_program(
-				shaders
-			{
-				std::make_pair(
-				std::string(
-						"#version 130\n"
-						"in vec3 VertexPosition;\n"
+						"#version 150\n"
+						"uniform mat4 uProjection;\n"
+						"uniform int uMode;\n"
+						"in vec2 VertexPosition;\n"
 						"in vec4 VertexColor;\n"
 						"in vec2 VertexTextureCoord;\n"
+						"in vec4 ShapeRect;\n"
+						"in vec4 ShapeColor;\n"
+						"in vec2 ShapeParameters;\n"
 						"out vec4 Color;\n"
-						"varying vec2 vGlyphTexCoord;\n"
-						"varying vec2 vShift;\n"
+						"out vec2 TextureCoord;\n"
+						"out vec4 Shape;\n"
+						"const vec2 Corners[6] = vec2[6](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, 1.0));\n"
 						"void main()\n"
 						"{\n"
-						"	Color = VertexColor;\n"
-						"   gl_Position = gl_ModelViewProjectionMatrix * vec4(VertexPosition, 1.0);\n"
-						"	vGlyphTexCoord = VertexTextureCoord;\n"
+						"	if (uMode == 4 || uMode == 5)\n"
+						"	{\n"
+						"		vec2 offset = Corners[gl_VertexID] * (ShapeRect.zw + vec2(ShapeParameters.y * 0.5 + 1.0));\n"
+						"		Color = ShapeColor;\n"
+						"		TextureCoord = offset;\n"
+						"		Shape = vec4(ShapeRect.zw, ShapeParameters);\n"
+						"		gl_Position = uProjection * vec4(ShapeRect.xy + offset, 0.0, 1.0);\n"
+						"	}\n"
+						"	else\n"
+						"	{\n"
+						"		Color = VertexColor;\n"
+						"		TextureCoord = VertexTextureCoord;\n"
+						"		Shape = vec4(0.0);\n"
+						"		gl_Position = uProjection * vec4(VertexPosition, 0.0, 1.0);\n"
+						"	}\n"
 						"}\n"),
 					GL_VERTEX_SHADER),
 				std::make_pair(
-					glsl::SUBPIXEL_RGB_HORIZONTAL_FRAG,
+					std::string(
+						"#version 150\n"
+						"uniform int uMode;\n"
+						"uniform int uAntiAlias;\n"
+						"uniform sampler2D uTexture;\n"
+						"uniform sampler2D uGradient;\n"
+						"in vec4 Color;\n"
+						"in vec2 TextureCoord;\n"
+						"in vec4 Shape;\n"
+						"out vec4 FragColor;\n"
+						"float shape_coverage()\n"
+						"{\n"
+						"	vec2 q = abs(TextureCoord) - Shape.xy + vec2(Shape.z);\n"
+						"	float d = min(max(q.x, q.y), 0.0) + length(max(q, vec2(0.0))) - Shape.z;\n"
+						"	if (Shape.w > 0.0)\n"
+						"		d = abs(d) - Shape.w * 0.5;\n"
+						"	if (uAntiAlias == 0)\n"
+						"		return d <= 0.0 ? 1.0 : 0.0;\n"
+						"	float w = max(length(vec2(dFdx(d), dFdy(d))), 0.0001);\n"
+						"	return clamp(0.5 - d / w, 0.0, 1.0);\n"
+						"}\n"
+						"vec4 gradient_colour()\n"
+						"{\n"
+						"	vec2 p = TextureCoord / max(Shape.xy, vec2(0.0001));\n"
+						"	int direction = int(Color.b * 255.0 + 0.5);\n"
+						"	float t;\n"
+						"	if (direction == 0)\n"
+						"		t = (p.y + 1.0) * 0.5;\n"
+						"	else if (direction == 1)\n"
+						"		t = (p.x + 1.0) * 0.5;\n"
+						"	else if (direction == 2)\n"
+						"		t = (p.x + p.y + 2.0) * 0.25;\n"
+						"	else\n"
+						"		t = length(p);\n"
+						"	vec2 lutSize = vec2(textureSize(uGradient, 0));\n"
+						"	float row = floor(Color.r * 255.0 + 0.5) + floor(Color.g * 255.0 + 0.5) * 256.0;\n"
+						"	return texture(uGradient, vec2((clamp(t, 0.0, 1.0) * (lutSize.x - 1.0) + 0.5) / lutSize.x, (row + 0.5) / lutSize.y));\n"
+						"}\n"
+						"void main()\n"
+						"{\n"
+						"	if (uMode == 1)\n"
+						"		FragColor = Color * texture(uTexture, TextureCoord);\n"
+						"	else if (uMode == 2)\n"
+						"	{\n"
+						"		vec4 texel = texture(uTexture, TextureCoord);\n"
+						"		float gray = dot(Color.rgb * texel.rgb, vec3(0.299, 0.587, 0.114));\n"
+						"		FragColor = vec4(gray, gray, gray, Color.a * texel.a);\n"
+						"	}\n"
+						"	else if (uMode == 3)\n"
+						"		FragColor = vec4(Color.rgb, Color.a * (TextureCoord.x < 0.0 ? 1.0 : texture(uTexture, TextureCoord).r));\n"
+						"	else if (uMode == 4)\n"
+						"		FragColor = vec4(Color.rgb, Color.a * shape_coverage());\n"
+						"	else if (uMode == 5)\n"
+						"	{\n"
+						"		vec4 colour = gradient_colour();\n"
+						"		FragColor = vec4(colour.rgb, colour.a * shape_coverage());\n"
+						"	}\n"
+						"	else\n"
+						"		FragColor = Color;\n"
+						"}\n"),
 					GL_FRAGMENT_SHADER)
 			},
-			{ "VertexPosition", "VertexColor", "VertexTextureCoord" });
-			break;
-		case i_screen_metrics::SubpixelFormatBGRHorizontal:
-			/* todo */
-		case i_screen_metrics::SubpixelFormatRGBVertical:
-		case i_screen_metrics::SubpixelFormatBGRVertical:
-		default:
-			iSubpixelProgram = create_shader_program(
-				shaders
-			{
-				std::make_pair(
-				std::string(
-				"#version 130\n"
-				"in vec3 VertexPosition;\n"
-				"in vec4 VertexColor;\n"
-				"in vec2 VertexTextureCoord;\n"
-				"out vec4 Color;\n"
-				"varying vec2 vGlyphTexCoord;\n"
-				"void main()\n"
-				"{\n"
-				"	Color = VertexColor;\n"
-				"   gl_Position = gl_ModelViewProjectionMatrix * vec4(VertexPosition, 1.0);\n"
-				"	vGlyphTexCoord = VertexTextureCoord;\n"
-				"}\n"),
-				GL_VERTEX_SHADER),
-				std::make_pair(
-				std::string(
-				"#version 130\n"
-				"uniform sampler2D glyphTexture;\n"
-				"uniform vec2 glyphTextureExtents;\n"
-				"in vec4 Color;\n"
-				"out vec4 FragColor;\n"
-				"varying vec2 vGlyphTexCoord;\n"
-				"void main()\n"
-				"{\n"
-				"	FragColor = vec4(Color.xyz, Color.a * texture(glyphTexture, vec2(vGlyphTexCoord.x, vGlyphTexCoord.y)).a);\n"
-				"}\n"),
-				GL_FRAGMENT_SHADER)
-			},
-			{ "VertexPosition", "VertexColor", "VertexTextureCoord" });
-			break;
-		}
+			{ "VertexPosition", "VertexColor", "VertexTextureCoord", "ShapeRect", "ShapeColor", "ShapeParameters" });
+		iDefaultProgramUniforms.projection = iDefaultProgram->uniform("uProjection");
+		iDefaultProgramUniforms.mode = iDefaultProgram->uniform("uMode");
+		iDefaultProgramUniforms.antiAlias = iDefaultProgram->uniform("uAntiAlias");
+		// shape attributes are re-pointed for every shape batch so their locations are looked up once here
+		iDefaultProgramAttributes.shapeRect = reinterpret_cast<GLuint>(iDefaultProgram->variable("ShapeRect"));
+		iDefaultProgramAttributes.shapeColor = reinterpret_cast<GLuint>(iDefaultProgram->variable("ShapeColor"));
+		iDefaultProgramAttributes.shapeParameters = reinterpret_cast<GLuint>(iDefaultProgram->variable("ShapeParameters"));
+		// sampler bindings never change so are set once rather than every time the program is used
+		activate_shader_program(*iDefaultProgram);
+		iDefaultProgram->set_uniform_variable(iDefaultProgram->uniform("uTexture"), 1);
+		iDefaultProgram->set_uniform_variable(iDefaultProgram->uniform("uGradient"), 2);
+		deactivate_shader_program();
+
+		iVertexBuffer = std::make_unique<vertex_buffer_type>(VERTEX_BUFFER_INITIAL_CAPACITY);
+		iShapeBuffer = std::make_unique<shape_buffer_type>(SHAPE_BUFFER_INITIAL_CAPACITY);
 	}
 
 	const i_screen_metrics& opengl_renderer::screen_metrics() const
@@ -265,7 +366,7 @@ namespace neogfx
 			if (&*i == &aProgram)
 			{
 				iActiveProgram = i;
-				glCheck(glUseProgram(reinterpret_cast<GLuint>(iActiveProgram->handle())));
+				state().use_program(reinterpret_cast<GLuint>(iActiveProgram->handle()));
 				return;
 			}
 		throw shader_program_not_found();
@@ -276,7 +377,7 @@ namespace neogfx
 		if (iActiveProgram == iShaderPrograms.end())
 			throw no_shader_program_active();
 		iActiveProgram = iShaderPrograms.end();
-		glCheck(glUseProgram(0));
+		state().use_program(0);
 	}
 
 	const opengl_renderer::i_shader_program& opengl_renderer::active_shader_program() const
@@ -293,24 +394,171 @@ namespace neogfx
 		return *iActiveProgram;
 	}
 
-	const opengl_renderer::i_shader_program& opengl_renderer::monochrome_shader_program() const
+	const opengl_renderer::i_shader_program& opengl_renderer::default_shader_program() const
+	{
+		return *iDefaultProgram;
+	}
+
+	opengl_renderer::i_shader_program& opengl_renderer::default_shader_program()
+	{
+		return *iDefaultProgram;
+	}
+
+	const rendering_statistics& opengl_renderer::statistics() const
+	{
+		return iStatistics;
+	}
+
+	opengl_renderer::vertex_buffer_type& opengl_renderer::vertex_buffer()
+	{
+		return *iVertexBuffer;
+	}
+
+	GLuint opengl_renderer::vertex_array()
+	{
+		// vertex array objects are not shared between contexts so each context gets its own, set up the first time 
+		// it is needed in that context
+		auto va = iVertexArrays.find(iActiveContext);
+		if (va != iVertexArrays.end())
+			return va->second;
+		GLuint vertexArray = 0;
+		glCheck(glGenVertexArrays(1, &vertexArray));
+		iVertexArrays[iActiveContext] = vertexArray;
+		state().bind_vertex_array(vertexArray);
+		state().bind_array_buffer(iVertexBuffer->handle());
+		GLuint vertexPositionAttribArrayIndex = reinterpret_cast<GLuint>(iDefaultProgram->variable("VertexPosition"));
+		glCheck(glEnableVertexAttribArray(vertexPositionAttribArrayIndex));
+		glCheck(glVertexAttribPointer(vertexPositionAttribArrayIndex, 2, GL_FLOAT, GL_FALSE, sizeof(vertex), reinterpret_cast<const GLvoid*>(offsetof(vertex, xy))));
+		GLuint vertexColorAttribArrayIndex = reinterpret_cast<GLuint>(iDefaultProgram->variable("VertexColor"));
+		glCheck(glEnableVertexAttribArray(vertexColorAttribArrayIndex));
+		glCheck(glVertexAttribPointer(vertexColorAttribArrayIndex, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(vertex), reinterpret_cast<const GLvoid*>(offsetof(vertex, rgba))));
+		GLuint vertexTextureCoordAttribArrayIndex = reinterpret_cast<GLuint>(iDefaultProgram->variable("VertexTextureCoord"));
+		glCheck(glEnableVertexAttribArray(vertexTextureCoordAttribArrayIndex));
+		glCheck(glVertexAttribPointer(vertexTextureCoordAttribArrayIndex, 2, GL_FLOAT, GL_FALSE, sizeof(vertex), reinterpret_cast<const GLvoid*>(offsetof(vertex, st))));
+		return vertexArray;
+	}
+
+	opengl_renderer::shape_buffer_type& opengl_renderer::shape_buffer()
+	{
+		return *iShapeBuffer;
+	}
+
+	GLuint opengl_renderer::shape_vertex_array()
+	{
+		auto va = iShapeVertexArrays.find(iActiveContext);
+		if (va != iShapeVertexArrays.end())
+			return va->second;
+		GLuint vertexArray = 0;
+		glCheck(glGenVertexArrays(1, &vertexArray));
+		iShapeVertexArrays[iActiveContext] = vertexArray;
+		state().bind_vertex_array(vertexArray);
+		state().bind_array_buffer(iShapeBuffer->handle());
+		// one shape per instance; the vertex shader generates the corners of its quad
+		for (GLuint index : { iDefaultProgramAttributes.shapeRect, iDefaultProgramAttributes.shapeColor, iDefaultProgramAttributes.shapeParameters })
+		{
+			glCheck(glEnableVertexAttribArray(index));
+			if (GLEW_VERSION_3_3)
+				glCheck(glVertexAttribDivisor(index, 1));
+			else
+				glCheck(glVertexAttribDivisorARB(index, 1));
+		}
+		set_shape_attributes(0);
+		return vertexArray;
+	}
+
+	void opengl_renderer::set_shape_attributes(std::size_t aFirst)
+	{
+		// instanced draws have no base instance before OpenGL 4.2 so the attributes are pointed at the first shape instead
+		const GLvoid* base = reinterpret_cast<const GLvoid*>(aFirst * sizeof(shape));
+		glCheck(glVertexAttribPointer(iDefaultProgramAttributes.shapeRect, 4, GL_FLOAT, GL_FALSE, sizeof(shape), 
+			static_cast<const char*>(base) + offsetof(shape, rect)));
+		glCheck(glVertexAttribPointer(iDefaultProgramAttributes.shapeColor, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(shape), 
+			static_cast<const char*>(base) + offsetof(shape, rgba)));
+		glCheck(glVertexAttribPointer(iDefaultProgramAttributes.shapeParameters, 2, GL_FLOAT, GL_FALSE, sizeof(shape), 
+			static_cast<const char*>(base) + offsetof(shape, parameters)));
+	}
+
+	GLuint opengl_renderer::copy_frame_buffer()
+	{
+		// the read frame buffer textures are copied from; frame buffer objects are not shared between contexts either
+		auto fb = iCopyFrameBuffers.find(iActiveContext);
+		if (fb != iCopyFrameBuffers.end())
+			return fb->second;
+		GLuint frameBuffer = 0;
+		glCheck(glGenFramebuffers(1, &frameBuffer));
+		iCopyFrameBuffers[iActiveContext] = frameBuffer;
+		return frameBuffer;
+	}
+
+	neogfx::tessellation_cache& opengl_renderer::tessellation_cache()
+	{
+		return iTessellationCache;
+	}
+
+	const opengl_renderer::default_shader_uniforms& opengl_renderer::default_shader_program_uniforms() const
+	{
+		return iDefaultProgramUniforms;
+	}
+
+	const opengl_renderer::default_shader_attributes& opengl_renderer::default_shader_program_attributes() const
+	{
+		return iDefaultProgramAttributes;
+	}
+
+	opengl_state& opengl_renderer::state()
+	{
+		return opengl_state::current();
+	}
+
+	void opengl_renderer::context_activated(void* aContext)
+	{
+		auto& contextState = iContextStates[aContext];
+		if (contextState == nullptr)
+			contextState = std::make_unique<opengl_state>();
+		opengl_state::set_current(contextState.get());
+		iActiveContext = aContext;
+	}
+
+	void opengl_renderer::context_destroyed(void* aContext)
+	{
+		// a context's vertex array object is destroyed along with it
+		iVertexArrays.erase(aContext);
+		iShapeVertexArrays.erase(aContext);
+		iCopyFrameBuffers.erase(aContext);
+		iGradientCaches.erase(aContext);
+		iContextStates.erase(aContext);
+		if (iActiveContext == aContext)
+			iActiveContext = nullptr;
+	}
+
+	opengl_gradient_cache& opengl_renderer::gradient_cache()
 	{
-		return *iMonochromeProgram;
+		// the lookup table texture could be shared but each context gets its own cache so that a row is never replaced 
+		// while another context still has commands waiting to be drawn that use it
+		auto& cache = iGradientCaches[iActiveContext];
+		if (cache == nullptr)
+			cache = std::make_unique<opengl_gradient_cache>();
+		return *cache;
 	}
 
-	opengl_renderer::i_shader_program& opengl_renderer::monochrome_shader_program()
+	std::unique_ptr<opengl_command_buffer> opengl_renderer::allocate_command_buffer()
 	{
-		return *iMonochromeProgram;
+		if (iCommandBufferPool.empty())
+			return std::make_unique<opengl_command_buffer>();
+		auto result = std::move(iCommandBufferPool.back());
+		iCommandBufferPool.pop_back();
+		return result;
 	}
 
-	const opengl_renderer::i_shader_program& opengl_renderer::subpixel_shader_program() const
+	void opengl_renderer::free_command_buffer(std::unique_ptr<opengl_command_buffer> aCommandBuffer)
 	{
-		return *iSubpixelProgram;
+		aCommandBuffer->clear();
+		iCommandBufferPool.push_back(std::move(aCommandBuffer));
 	}
 
-	opengl_renderer::i_shader_program& opengl_renderer::subpixel_shader_program()
+	void opengl_renderer::frame_rendered(const rendering_statistics& aStatistics)
 	{
-		return *iSubpixelProgram;
+		iStatistics = aStatistics;
 	}
 
 	opengl_renderer::shader_programs::iterator opengl_renderer::create_shader_program(const shaders& aShaders, const std::vector<std::string>& aVariables)
@@ -348,6 +596,7 @@ namespace neogfx
 		glCheck(glGetProgramiv(programHandle, GL_LINK_STATUS, &result));
 		if (GL_FALSE == result)
 			throw failed_to_create_shader_program("Failed to link");
+		s->resolve_uniforms();
 		return s;
 	}
 }
\ No newline at end of file
@@ -0,0 +1,350 @@
+// opengl_state.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "neogfx.hpp"
+#include "opengl_error.hpp"
+#include "opengl_state.hpp"
+
+namespace neogfx
+{
+	std::set<opengl_state*> opengl_state::sInstances;
+	opengl_state* opengl_state::sCurrent;
+
+	opengl_state::opengl_state() :
+		iStateChanges(0), iRedundantStateChanges(0), iCounters{}
+	{
+		sInstances.insert(this);
+	}
+
+	opengl_state::~opengl_state()
+	{
+		if (sCurrent == this)
+			sCurrent = nullptr;
+		sInstances.erase(this);
+	}
+
+	template <typename T>
+	bool opengl_state::change(boost::optional<T>& aShadow, const T& aValue)
+	{
+		if (aShadow != boost::none && *aShadow == aValue)
+		{
+			++iRedundantStateChanges;
+			return false;
+		}
+		++iStateChanges;
+		aShadow = aValue;
+		return true;
+	}
+
+	opengl_state& opengl_state::current()
+	{
+		// a tracker that knows nothing is used until a context has been activated through the renderer
+		static opengl_state sUnknownContext;
+		if (sCurrent == nullptr)
+		{
+			sUnknownContext.invalidate();
+			return sUnknownContext;
+		}
+		return *sCurrent;
+	}
+
+	void opengl_state::set_current(opengl_state* aState)
+	{
+		sCurrent = aState;
+	}
+
+	void opengl_state::texture_deleted(GLuint aTexture)
+	{
+		// names of deleted objects can be reused so a shadowed binding must not outlive its object
+		for (auto s : sInstances)
+			for (auto& t : s->iTextures)
+				if (t != boost::none && *t == aTexture)
+					t = boost::none;
+	}
+
+	void opengl_state::buffer_deleted(GLuint aBuffer)
+	{
+		for (auto s : sInstances)
+			if (s->iArrayBuffer != boost::none && *s->iArrayBuffer == aBuffer)
+				s->iArrayBuffer = boost::none;
+	}
+
+	void opengl_state::vertex_array_deleted(GLuint aVertexArray)
+	{
+		for (auto s : sInstances)
+			if (s->iVertexArray != boost::none && *s->iVertexArray == aVertexArray)
+				s->iVertexArray = boost::none;
+	}
+
+	void opengl_state::frame_buffer_deleted(GLuint aFrameBuffer)
+	{
+		for (auto s : sInstances)
+		{
+			if (s->iReadFrameBuffer != boost::none && *s->iReadFrameBuffer == aFrameBuffer)
+				s->iReadFrameBuffer = boost::none;
+			if (s->iDrawFrameBuffer != boost::none && *s->iDrawFrameBuffer == aFrameBuffer)
+				s->iDrawFrameBuffer = boost::none;
+		}
+	}
+
+	void opengl_state::invalidate()
+	{
+		iActiveTexture = boost::none;
+		for (auto& t : iTextures)
+			t = boost::none;
+		iVertexArray = boost::none;
+		iArrayBuffer = boost::none;
+		iProgram = boost::none;
+		iReadFrameBuffer = boost::none;
+		iDrawFrameBuffer = boost::none;
+		iCapabilities.clear();
+		iBlendFunc = boost::none;
+		iScissor = boost::none;
+		iStencilFunc = boost::none;
+		iStencilOp = boost::none;
+		iStencilMask = boost::none;
+		iColourMask = boost::none;
+		iDepthMask = boost::none;
+		iLogicOp = boost::none;
+	}
+
+	void opengl_state::active_texture(GLenum aUnit)
+	{
+		if (change(iActiveTexture, aUnit))
+		{
+			glCheck(glActiveTexture(aUnit));
+		}
+	}
+
+	void opengl_state::bind_texture(GLuint aTexture)
+	{
+		if (iActiveTexture == boost::none || *iActiveTexture - GL_TEXTURE0 >= TextureUnits)
+		{
+			// the unit is unknown (or untracked) so the binding can neither be skipped nor shadowed
+			++iStateChanges;
+			++iCounters.textureBinds;
+			glCheck(glBindTexture(GL_TEXTURE_2D, aTexture));
+			for (auto& t : iTextures)
+				t = boost::none;
+			return;
+		}
+		if (change(iTextures[*iActiveTexture - GL_TEXTURE0], aTexture))
+		{
+			++iCounters.textureBinds;
+			glCheck(glBindTexture(GL_TEXTURE_2D, aTexture));
+		}
+	}
+
+	void opengl_state::bind_texture(GLenum aUnit, GLuint aTexture)
+	{
+		if (aUnit - GL_TEXTURE0 < TextureUnits && iTextures[aUnit - GL_TEXTURE0] != boost::none && *iTextures[aUnit - GL_TEXTURE0] == aTexture)
+		{
+			++iRedundantStateChanges;
+			return;
+		}
+		active_texture(aUnit);
+		bind_texture(aTexture);
+	}
+
+	void opengl_state::bind_vertex_array(GLuint aVertexArray)
+	{
+		if (change(iVertexArray, aVertexArray))
+		{
+			glCheck(glBindVertexArray(aVertexArray));
+		}
+	}
+
+	void opengl_state::bind_array_buffer(GLuint aBuffer)
+	{
+		if (change(iArrayBuffer, aBuffer))
+		{
+			glCheck(glBindBuffer(GL_ARRAY_BUFFER, aBuffer));
+		}
+	}
+
+	void opengl_state::use_program(GLuint aProgram)
+	{
+		if (change(iProgram, aProgram))
+		{
+			++iCounters.shaderSwitches;
+			glCheck(glUseProgram(aProgram));
+		}
+	}
+
+	void opengl_state::bind_frame_buffer(GLenum aTarget, GLuint aFrameBuffer)
+	{
+		switch (aTarget)
+		{
+		case GL_READ_FRAMEBUFFER:
+			if (change(iReadFrameBuffer, aFrameBuffer))
+			{
+				glCheck(glBindFramebuffer(GL_READ_FRAMEBUFFER, aFrameBuffer));
+			}
+			break;
+		case GL_DRAW_FRAMEBUFFER:
+			if (change(iDrawFrameBuffer, aFrameBuffer))
+			{
+				glCheck(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, aFrameBuffer));
+			}
+			break;
+		default:
+			{
+				bool readChanged = change(iReadFrameBuffer, aFrameBuffer);
+				bool drawChanged = change(iDrawFrameBuffer, aFrameBuffer);
+				if (readChanged || drawChanged)
+				{
+					glCheck(glBindFramebuffer(GL_FRAMEBUFFER, aFrameBuffer));
+				}
+			}
+			break;
+		}
+	}
+
+	GLuint opengl_state::read_frame_buffer() const
+	{
+		return iReadFrameBuffer != boost::none ? *iReadFrameBuffer : 0;
+	}
+
+	GLuint opengl_state::draw_frame_buffer() const
+	{
+		return iDrawFrameBuffer != boost::none ? *iDrawFrameBuffer : 0;
+	}
+
+	void opengl_state::enable(GLenum aCapability)
+	{
+		set_capability(aCapability, true);
+	}
+
+	void opengl_state::disable(GLenum aCapability)
+	{
+		set_capability(aCapability, false);
+	}
+
+	void opengl_state::set_capability(GLenum aCapability, bool aEnable)
+	{
+		auto existing = iCapabilities.find(aCapability);
+		if (existing != iCapabilities.end() && existing->second == aEnable)
+		{
+			++iRedundantStateChanges;
+			return;
+		}
+		++iStateChanges;
+		iCapabilities[aCapability] = aEnable;
+		if (aEnable)
+		{
+			glCheck(glEnable(aCapability));
+		}
+		else
+		{
+			glCheck(glDisable(aCapability));
+		}
+	}
+
+	void opengl_state::blend_func(GLenum aSourceFactor, GLenum aDestinationFactor)
+	{
+		if (change(iBlendFunc, std::make_pair(aSourceFactor, aDestinationFactor)))
+		{
+			glCheck(glBlendFunc(aSourceFactor, aDestinationFactor));
+		}
+	}
+
+	void opengl_state::scissor(GLint aX, GLint aY, GLsizei aWidth, GLsizei aHeight)
+	{
+		if (change(iScissor, std::make_tuple(aX, aY, aWidth, aHeight)))
+		{
+			glCheck(glScissor(aX, aY, aWidth, aHeight));
+		}
+	}
+
+	void opengl_state::stencil_func(GLenum aFunc, GLint aRef, GLuint aMask)
+	{
+		if (change(iStencilFunc, std::make_tuple(aFunc, aRef, aMask)))
+		{
+			glCheck(glStencilFunc(aFunc, aRef, aMask));
+		}
+	}
+
+	void opengl_state::stencil_op(GLenum aStencilFail, GLenum aDepthFail, GLenum aDepthPass)
+	{
+		if (change(iStencilOp, std::make_tuple(aStencilFail, aDepthFail, aDepthPass)))
+		{
+			glCheck(glStencilOp(aStencilFail, aDepthFail, aDepthPass));
+		}
+	}
+
+	void opengl_state::stencil_mask(GLuint aMask)
+	{
+		if (change(iStencilMask, aMask))
+		{
+			glCheck(glStencilMask(aMask));
+		}
+	}
+
+	void opengl_state::colour_mask(bool aWrite)
+	{
+		if (change(iColourMask, aWrite))
+		{
+			GLboolean write = aWrite ? GL_TRUE : GL_FALSE;
+			glCheck(glColorMask(write, write, write, write));
+		}
+	}
+
+	void opengl_state::depth_mask(bool aWrite)
+	{
+		if (change(iDepthMask, aWrite))
+		{
+			glCheck(glDepthMask(aWrite ? GL_TRUE : GL_FALSE));
+		}
+	}
+
+	void opengl_state::logic_op(GLenum aOperation)
+	{
+		if (change(iLogicOp, aOperation))
+		{
+			glCheck(glLogicOp(aOperation));
+		}
+	}
+
+	uint64_t opengl_state::state_changes() const
+	{
+		return iStateChanges;
+	}
+
+	uint64_t opengl_state::redundant_state_changes() const
+	{
+		return iRedundantStateChanges;
+	}
+
+	const rendering_statistics& opengl_state::counters() const
+	{
+		return iCounters;
+	}
+
+	rendering_statistics& opengl_state::counters()
+	{
+		return iCounters;
+	}
+
+	void opengl_state::reset_counters()
+	{
+		iStateChanges = 0;
+		iRedundantStateChanges = 0;
+		iCounters = rendering_statistics{};
+	}
+}
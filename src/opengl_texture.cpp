@@ -19,53 +19,45 @@
 
 #include "neogfx.hpp"
 #include "opengl_error.hpp"
+#include "opengl_state.hpp"
 #include "opengl_texture.hpp"
 
 namespace neogfx
 {
+	opengl_texture::opengl_texture(const size& aExtents) :
+		iSize(aExtents),
+		iStorageSize{size{std::max(std::pow(2.0, std::ceil(std::log2(iSize.cx + 2))), 16.0), std::max(std::pow(2.0, std::ceil(std::log2(iSize.cy + 2))), 16.0)}},
+		iHandle(0)
+	{
+	}
+
 	opengl_texture::opengl_texture(const i_image& aImage) :
 		iSize(aImage.extents()), 
 		iStorageSize{size{std::max(std::pow(2.0, std::ceil(std::log2(iSize.cx + 2))), 16.0), std::max(std::pow(2.0, std::ceil(std::log2(iSize.cy + 2))), 16.0)}},
 		iHandle(0), 
 		iUri(aImage.uri())
 	{
-		GLint previousTexture;
-		try
+		switch (aImage.colour_format())
 		{
-			glCheck(glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture));
-			glCheck(glGenTextures(1, &iHandle));
-			glCheck(glBindTexture(GL_TEXTURE_2D, iHandle));
-			glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
-			glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
-			switch (aImage.colour_format())
+		case ColourFormatRGBA8:
 			{
-			case ColourFormatRGBA8:
-				{
-					const uint8_t* imageData = static_cast<const uint8_t*>(aImage.data());
-					std::vector<uint8_t> data(iStorageSize.cx * 4 * iStorageSize.cy);
-					for (std::size_t y = 1; y < 1 + iSize.cy; ++y)
-						for (std::size_t x = 1; x < 1 + iSize.cx; ++x)
-							for (std::size_t c = 0; c < 4; ++c)
-								data[y * iStorageSize.cx * 4 + x * 4 + c] = imageData[(y - 1) * iSize.cx * 4 + (x - 1) * 4 + c];
-					glCheck(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, static_cast<GLsizei>(iStorageSize.cx), static_cast<GLsizei>(iStorageSize.cy), 0, GL_RGBA, GL_UNSIGNED_BYTE, &data[0]));
-				}
-				break;
-			default:
-				throw unsupported_colour_format();
-				break;
+				const uint8_t* imageData = static_cast<const uint8_t*>(aImage.data());
+				iData.resize(iStorageSize.cx * 4 * iStorageSize.cy);
+				for (std::size_t y = 1; y < 1 + iSize.cy; ++y)
+					for (std::size_t x = 1; x < 1 + iSize.cx; ++x)
+						for (std::size_t c = 0; c < 4; ++c)
+							iData[y * iStorageSize.cx * 4 + x * 4 + c] = imageData[(y - 1) * iSize.cx * 4 + (x - 1) * 4 + c];
 			}
-			glCheck(glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(previousTexture)));
-		}
-		catch (...)
-		{
-			glCheck(glDeleteTextures(1, &iHandle));
-			throw;
+			break;
+		default:
+			throw unsupported_colour_format();
+			break;
 		}
 	}
 
 	opengl_texture::~opengl_texture()
 	{
-		glCheck(glDeleteTextures(1, &iHandle));
+		evict();
 	}
 
 	size opengl_texture::extents() const
@@ -85,13 +77,74 @@ namespace neogfx
 
 	bool opengl_texture::is_resident() const
 	{
-		GLboolean resident;
-		glCheck(glAreTexturesResident(1, &iHandle, &resident));
-		return resident == GL_TRUE;
+		return iHandle != 0;
+	}
+
+	bool opengl_texture::is_evictable() const
+	{
+		// textures without image data are render targets whose contents cannot be recreated
+		return !iData.empty();
+	}
+
+	std::size_t opengl_texture::memory_size() const
+	{
+		return iStorageSize.cx * iStorageSize.cy * 4;
+	}
+
+	void opengl_texture::make_resident()
+	{
+		if (is_resident())
+			return;
+		try
+		{
+			glCheck(glGenTextures(1, &iHandle));
+			opengl_state::current().bind_texture(iHandle);
+			glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+			glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+			glCheck(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, static_cast<GLsizei>(iStorageSize.cx), static_cast<GLsizei>(iStorageSize.cy), 0, GL_RGBA, GL_UNSIGNED_BYTE, !iData.empty() ? &iData[0] : nullptr));
+		}
+		catch (...)
+		{
+			evict();
+			throw;
+		}
+	}
+
+	void opengl_texture::evict()
+	{
+		if (!is_resident())
+			return;
+		glCheck(glDeleteTextures(1, &iHandle));
+		opengl_state::texture_deleted(iHandle);
+		iHandle = 0;
 	}
 
 	const std::string& opengl_texture::uri() const
 	{
 		return iUri;
 	}
+
+	const void* opengl_texture::data() const
+	{
+		return !iData.empty() ? &iData[0] : nullptr;
+	}
+
+	void opengl_texture::update(const rect& aRect, const void* aPixels)
+	{
+		// keeping a copy of the pixels also makes a render target evictable as it can now be recreated
+		if (iData.empty())
+			iData.resize(iStorageSize.cx * 4 * iStorageSize.cy);
+		std::size_t x = static_cast<std::size_t>(aRect.x);
+		std::size_t y = static_cast<std::size_t>(aRect.y);
+		std::size_t cx = static_cast<std::size_t>(aRect.cx);
+		std::size_t cy = static_cast<std::size_t>(aRect.cy);
+		std::size_t storageWidth = static_cast<std::size_t>(iStorageSize.cx);
+		const uint8_t* pixels = static_cast<const uint8_t*>(aPixels);
+		for (std::size_t row = 0; row < cy; ++row)
+			std::copy(pixels + row * cx * 4, pixels + (row + 1) * cx * 4, &iData[((y + row) * storageWidth + x) * 4]);
+		if (!is_resident())
+			return;
+		opengl_state::current().bind_texture(iHandle);
+		glCheck(glTexSubImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(x), static_cast<GLint>(y), static_cast<GLsizei>(cx), static_cast<GLsizei>(cy), GL_RGBA, GL_UNSIGNED_BYTE, aPixels));
+	}
 }
\ No newline at end of file
@@ -20,9 +20,15 @@
 #include "neogfx.hpp"
 #include "opengl_texture_manager.hpp"
 #include "opengl_texture.hpp"
+#include "font_texture.hpp"
 
 namespace neogfx
 {
+	std::unique_ptr<i_native_texture> opengl_texture_manager::create_texture(const size& aExtents)
+	{
+		return add_texture(std::make_shared<opengl_texture>(aExtents));
+	}
+
 	std::unique_ptr<i_native_texture> opengl_texture_manager::create_texture(const i_image& aImage)
 	{
 		auto existing = find_texture(aImage);
@@ -30,4 +36,9 @@ namespace neogfx
 			return join_texture(*existing->lock());
 		return add_texture(std::make_shared<opengl_texture>(aImage));
 	}
+
+	std::unique_ptr<i_font_texture> opengl_texture_manager::create_font_texture(const size& aExtents, bool aSubPixelRendering)
+	{
+		return std::make_unique<font_texture>(aExtents, aSubPixelRendering);
+	}
 }
\ No newline at end of file
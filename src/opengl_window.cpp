@@ -18,8 +18,13 @@
 */
 
 #include "neogfx.hpp"
+#include <algorithm>
 #include "opengl_window.hpp"
+#include "opengl_state.hpp"
+#include "opengl_renderer.hpp"
+#include "i_image.hpp"
 #include "app.hpp"
+#include "profiler.hpp"
 #ifdef _WIN32
 #include <D2d1.h>
 #endif
@@ -32,9 +37,12 @@ namespace neogfx
 		native_window(aRenderingEngine, aSurfaceManager),
 		iEventHandler(aEventHandler),
 		iLogicalCoordinateSystem(neogfx::logical_coordinate_system::AutomaticGui),
-		iFrameRate(60),
+		iGpuTimer(0),
+		iGpuTimerPending(false),
 		iFrameCounter(0),
-		iLastFrameTime(0),
+		iFrameScheduler(neogfx::frame_pacing::OnDemand, 60),
+		iThreadedPresentation(false),
+		iPresentationContext(nullptr),
 		iRendering(false)
 	{
 #ifdef _WIN32
@@ -91,13 +99,47 @@ namespace neogfx
 
 	void opengl_window::limit_frame_rate(uint32_t aFps)
 	{
-		iFrameRate = aFps;
+		iFrameScheduler.set_frame_rate(aFps);
+	}
+
+	neogfx::frame_pacing opengl_window::frame_pacing() const
+	{
+		return iFrameScheduler.frame_pacing();
+	}
+
+	void opengl_window::set_frame_pacing(neogfx::frame_pacing aPacing)
+	{
+		iFrameScheduler.set_frame_pacing(aPacing);
+	}
+
+	neogfx::frame_statistics opengl_window::frame_statistics() const
+	{
+		return iFrameScheduler.frame_statistics();
+	}
+
+	boost::optional<frame_scheduler::time_point> opengl_window::next_frame_time() const
+	{
+		// an on demand surface with nothing invalidated has no reason to wake anyone up
+		if (iFrameScheduler.frame_pacing() == neogfx::frame_pacing::OnDemand && iInvalidatedRegion.empty())
+			return boost::none;
+		return iFrameScheduler.next_frame_time();
+	}
+
+	bool opengl_window::threaded_presentation() const
+	{
+		return iThreadedPresentation;
+	}
+
+	void opengl_window::set_threaded_presentation(bool aThreadedPresentation)
+	{
+		iThreadedPresentation = aThreadedPresentation;
+		if (!iThreadedPresentation)
+			stop_present_thread();
 	}
 
 	void opengl_window::invalidate(const rect& aInvalidatedRect)
 	{
-		if (iInvalidatedRects.find(aInvalidatedRect) == iInvalidatedRects.end())
-			iInvalidatedRects.insert(aInvalidatedRect);
+		iInvalidatedRegion.combine(aInvalidatedRect);
 	}
 
 	void opengl_window::render()
@@ -105,8 +147,8 @@ namespace neogfx
 		if (iRendering || processing_event())
 			return;
 
-		uint64_t now = app::instance().program_elapsed_ms();
-		if (iFrameRate != boost::none && now - iLastFrameTime < 1000 / *iFrameRate)
+		auto now = frame_scheduler::clock::now();
+		if (!iFrameScheduler.frame_due(now))
 			return;
 
 		if (!iEventHandler.native_window_ready_to_render())
@@ -114,24 +156,25 @@ namespace neogfx
 
 		rendering_check.trigger();
 
-		if (iInvalidatedRects.empty())
+		iInvalidatedRegion.intersect(rect{ point{}, surface_size() });
+		if (iInvalidatedRegion.empty())
+		{
+			iFrameScheduler.frame_skipped(now);
 			return;
+		}
 
 		++iFrameCounter;
 
+		profiler::scope ps(profiler::Frame);
+
 		iRendering = true;
-		iLastFrameTime = now;
+		iFrameScheduler.frame_started(now);
 
 		rendering.trigger();
 
-		rect invalidatedRect = *iInvalidatedRects.begin();
-		for (const auto& ir : iInvalidatedRects)
-		{
-			invalidatedRect = invalidatedRect.combine(ir);
-		}
-		iInvalidatedRects.clear();
-		invalidatedRect.cx = std::min(invalidatedRect.cx, surface_size().cx - invalidatedRect.x);
-		invalidatedRect.cy = std::min(invalidatedRect.cy, surface_size().cy - invalidatedRect.y);
+		rect invalidatedRect = iInvalidatedRegion.bounding_rect();
+		auto invalidatedRects = iInvalidatedRegion.coverage(MaxInvalidatedRects);
+		iInvalidatedRegion.clear();
 
 		static bool initialized = false;
 		if (!initialized)
@@ -141,64 +184,98 @@ namespace neogfx
 		}
 
 		activate_context();
+		bool timingGpu = begin_gpu_timer();
 
 		glCheck(glViewport(0, 0, static_cast<GLsizei>(extents().cx), static_cast<GLsizei>(extents().cy)));
-		glCheck(glMatrixMode(GL_PROJECTION));
-		glCheck(glLoadIdentity());
-		glCheck(glScalef(1.0, 1.0, 1.0));
-		glCheck(glMatrixMode(GL_MODELVIEW));
-		glCheck(glLoadIdentity());
-		const auto& logicalCoordinates = logical_coordinates();
-		glCheck(glOrtho(logicalCoordinates[0], logicalCoordinates[2], logicalCoordinates[1], logicalCoordinates[3], -1.0, 1.0));
-		glCheck(glEnableClientState(GL_VERTEX_ARRAY));
-		glCheck(glEnableClientState(GL_COLOR_ARRAY));
-		glCheck(glEnableClientState(GL_TEXTURE_COORD_ARRAY));
-		glCheck(glEnable(GL_TEXTURE_2D));
-		glCheck(glEnable(GL_MULTISAMPLE));
-		glCheck(glEnable(GL_BLEND));
+		opengl_state::current().disable(GL_MULTISAMPLE);
+		opengl_state::current().enable(GL_BLEND);
 		if (iFrameBufferSize.cx < static_cast<double>(extents().cx) || iFrameBufferSize.cy < static_cast<double>(extents().cy))
 		{
 			if (iFrameBufferSize != size{})
 			{
 				glCheck(glDeleteRenderbuffers(1, &iDepthStencilBuffer));
 				glCheck(glDeleteTextures(1, &iFrameBufferTexture));
+				opengl_state::texture_deleted(iFrameBufferTexture);
 				glCheck(glDeleteFramebuffers(1, &iFrameBuffer));
+				opengl_state::frame_buffer_deleted(iFrameBuffer);
 			}
 			iFrameBufferSize = size(
 				iFrameBufferSize.cx < extents().cx ? extents().cx * 1.5f : iFrameBufferSize.cx,
 				iFrameBufferSize.cy < extents().cy ? extents().cy * 1.5f : iFrameBufferSize.cy);
 			glCheck(glGenFramebuffers(1, &iFrameBuffer));
-			glCheck(glBindFramebuffer(GL_FRAMEBUFFER, iFrameBuffer));
+			opengl_state::current().bind_frame_buffer(GL_FRAMEBUFFER, iFrameBuffer);
 			glCheck(glGenTextures(1, &iFrameBufferTexture));
-			glCheck(glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, iFrameBufferTexture));
-			glCheck(glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, 4, GL_RGBA8, static_cast<GLsizei>(iFrameBufferSize.cx), static_cast<GLsizei>(iFrameBufferSize.cy), true));
-			glCheck(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D_MULTISAMPLE, iFrameBufferTexture, 0));
+			opengl_state::current().bind_texture(iFrameBufferTexture);
+			glCheck(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, static_cast<GLsizei>(iFrameBufferSize.cx), static_cast<GLsizei>(iFrameBufferSize.cy), 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL));
+			glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST));
+			glCheck(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+			glCheck(glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, iFrameBufferTexture, 0));
 			glCheck(glGenRenderbuffers(1, &iDepthStencilBuffer));
 			glCheck(glBindRenderbuffer(GL_RENDERBUFFER, iDepthStencilBuffer));
-			glCheck(glRenderbufferStorageMultisample(GL_RENDERBUFFER, 4, GL_DEPTH24_STENCIL8, static_cast<GLsizei>(iFrameBufferSize.cx), static_cast<GLsizei>(iFrameBufferSize.cy)));
+			glCheck(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, static_cast<GLsizei>(iFrameBufferSize.cx), static_cast<GLsizei>(iFrameBufferSize.cy)));
 			glCheck(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, iDepthStencilBuffer));
 			glCheck(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_STENCIL_ATTACHMENT, GL_RENDERBUFFER, iDepthStencilBuffer));
 		}
 		else
 		{
-			glCheck(glBindFramebuffer(GL_FRAMEBUFFER, iFrameBuffer));
-			glCheck(glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, iFrameBufferTexture));
+			opengl_state::current().bind_frame_buffer(GL_FRAMEBUFFER, iFrameBuffer);
+			opengl_state::current().bind_texture(iFrameBufferTexture);
 			glCheck(glBindRenderbuffer(GL_RENDERBUFFER, iDepthStencilBuffer));
 		}
 		GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
 		if (status != GL_NO_ERROR && status != GL_FRAMEBUFFER_COMPLETE)
 			throw failed_to_create_framebuffer(status);
-		glCheck(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, iFrameBuffer));
+		opengl_state::current().bind_frame_buffer(GL_DRAW_FRAMEBUFFER, iFrameBuffer);
 		GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0 };
 		glCheck(glDrawBuffers(sizeof(drawBuffers) / sizeof(drawBuffers[0]), drawBuffers));
 
 		glCheck(iEventHandler.native_window_render(invalidatedRect));
+		rendering_engine().texture_manager().end_frame();
+		end_gpu_timer(timingGpu);
+		publish_statistics();
+		// counters are reset at the end of a frame rather than the start so that work done between frames (e.g. glyph 
+		// uploads) is attributed to the next frame
+		opengl_state::current().reset_counters();
+
+		// the back buffer only holds the previous frame if the platform preserves it across presents and the window
+		// has not been resized since, otherwise the whole frame buffer has to be presented
+		if (!partial_present() || iPresentedExtents != extents())
+			invalidatedRects.assign(1, rect{ point{}, extents() });
+		iPresentedExtents = extents();
+		if (iThreadedPresentation)
+		{
+			// the frame is handed over and presented by another thread while we get on with processing events
+			if (iPresentThread == nullptr)
+			{
+				iPresentationContext = create_presentation_context();
+				iPresentThread = std::make_unique<opengl_present_thread>(iPresentationContext,
+					[this](void* aContext) { make_presentation_context_current(aContext); },
+					[this](const size& aFrameExtents, const std::vector<rect>& aDamagedRects) { display(aFrameExtents, aDamagedRects); });
+			}
+			auto submitted = frame_scheduler::clock::now();
+			iPresentThread->submit(iFrameBuffer, extents(), invalidatedRects);
+			iFrameScheduler.set_refresh_rate(boost::none);
+			iFrameScheduler.frame_presented(submitted, frame_scheduler::clock::now());
+			deactivate_context();
+			iRendering = false;
+			rendering_finished.trigger();
+			return;
+		}
+		opengl_state::current().bind_frame_buffer(GL_DRAW_FRAMEBUFFER, 0);
+		opengl_state::current().bind_frame_buffer(GL_READ_FRAMEBUFFER, iFrameBuffer);
+		for (const auto& ir : invalidatedRects)
+		{
+			GLint x0 = static_cast<GLint>(ir.left());
+			GLint y0 = static_cast<GLint>(extents().cy - ir.bottom());
+			GLint x1 = static_cast<GLint>(ir.right());
+			GLint y1 = static_cast<GLint>(extents().cy - ir.top());
+			glCheck(glBlitFramebuffer(x0, y0, x1, y1, x0, y0, x1, y1, GL_COLOR_BUFFER_BIT, GL_NEAREST));
+		}
 
-		glCheck(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0));
-		glCheck(glBindFramebuffer(GL_READ_FRAMEBUFFER, iFrameBuffer));
-		glCheck(glBlitFramebuffer(0, 0, static_cast<GLint>(extents().cx), static_cast<GLint>(extents().cy), 0, 0, static_cast<GLint>(extents().cx), static_cast<GLint>(extents().cy), GL_COLOR_BUFFER_BIT, GL_NEAREST));
-
-		display();
+		iFrameScheduler.set_refresh_rate(vertical_sync_rate());
+		auto presentStarted = frame_scheduler::clock::now();
+		display(extents(), invalidatedRects);
+		iFrameScheduler.frame_presented(presentStarted, frame_scheduler::clock::now());
 		deactivate_context();
 
 		iRendering = false;
@@ -211,6 +288,28 @@ namespace neogfx
 		return iRendering;
 	}
 
+	void opengl_window::read_pixels(i_image& aImage) const
+	{
+		if (aImage.colour_format() != ColourFormatRGBA8)
+			throw unsupported_colour_format();
+		aImage.resize(extents());
+		if (iFrameBufferSize == size{} || aImage.size() == 0)
+			return;
+		GLsizei width = static_cast<GLsizei>(aImage.extents().cx);
+		GLsizei height = static_cast<GLsizei>(aImage.extents().cy);
+		uint8_t* pixels = static_cast<uint8_t*>(aImage.data());
+		activate_context();
+		opengl_state::current().bind_frame_buffer(GL_READ_FRAMEBUFFER, iFrameBuffer);
+		glCheck(glReadBuffer(GL_COLOR_ATTACHMENT0));
+		glCheck(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+		glCheck(glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
+		deactivate_context();
+		// OpenGL rows run bottom to top
+		std::size_t stride = static_cast<std::size_t>(width) * 4;
+		for (GLsizei y = 0; y < height / 2; ++y)
+			std::swap_ranges(pixels + y * stride, pixels + (y + 1) * stride, pixels + (height - 1 - y) * stride);
+	}
+
 	size opengl_window::extents() const
 	{
 		return surface_size();
@@ -238,12 +337,21 @@ namespace neogfx
 
 	void opengl_window::destroying()
 	{
+		stop_present_thread();
 		activate_context();
 		if (iFrameBufferSize != size{})
 		{
 			glCheck(glDeleteRenderbuffers(1, &iDepthStencilBuffer));
 			glCheck(glDeleteTextures(1, &iFrameBufferTexture));
+			opengl_state::texture_deleted(iFrameBufferTexture);
 			glCheck(glDeleteFramebuffers(1, &iFrameBuffer));
+			opengl_state::frame_buffer_deleted(iFrameBuffer);
+		}
+		if (iGpuTimer != 0)
+		{
+			glCheck(glDeleteQueries(1, &iGpuTimer));
+			iGpuTimer = 0;
+			iGpuTimerPending = false;
 		}
 		deactivate_context();
 	}
@@ -251,4 +359,57 @@ namespace neogfx
 	void opengl_window::destroyed()
 	{
 	}
+
+	void opengl_window::stop_present_thread()
+	{
+		if (iPresentThread == nullptr)
+			return;
+		activate_context();
+		iPresentThread.reset();
+		deactivate_context();
+		destroy_presentation_context(iPresentationContext);
+		iPresentationContext = nullptr;
+	}
+
+	bool opengl_window::begin_gpu_timer()
+	{
+		if (!GLEW_ARB_timer_query && !GLEW_VERSION_3_3)
+			return false;
+		if (iGpuTimer == 0)
+			glCheck(glGenQueries(1, &iGpuTimer));
+		else if (iGpuTimerPending)
+		{
+			// never wait for the GPU: the previous query is only collected once its result is available and the 
+			// frames rendered in the meantime go untimed
+			GLint available = GL_FALSE;
+			glCheck(glGetQueryObjectiv(iGpuTimer, GL_QUERY_RESULT_AVAILABLE, &available));
+			if (available == GL_FALSE)
+				return false;
+			GLuint64 elapsed = 0;
+			glCheck(glGetQueryObjectui64v(iGpuTimer, GL_QUERY_RESULT, &elapsed));
+			iGpuTime = elapsed / 1000000.0;
+			iGpuTimerPending = false;
+		}
+		glCheck(glBeginQuery(GL_TIME_ELAPSED, iGpuTimer));
+		return true;
+	}
+
+	void opengl_window::end_gpu_timer(bool aStarted)
+	{
+		if (!aStarted)
+			return;
+		glCheck(glEndQuery(GL_TIME_ELAPSED));
+		iGpuTimerPending = true;
+	}
+
+	void opengl_window::publish_statistics()
+	{
+		auto& state = opengl_state::current();
+		rendering_statistics statistics = state.counters();
+		statistics.frame = iFrameCounter;
+		statistics.stateChanges = state.state_changes();
+		statistics.redundantStateChanges = state.redundant_state_changes();
+		statistics.gpuTime = iGpuTime;
+		static_cast<opengl_renderer&>(rendering_engine()).frame_rendered(statistics);
+	}
 }
\ No newline at end of file
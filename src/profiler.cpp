@@ -0,0 +1,281 @@
+// profiler.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "neogfx.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <typeinfo>
+#include "i_widget.hpp"
+#include "profiler.hpp"
+
+namespace neogfx
+{
+	namespace
+	{
+		thread_local const profiler::scope* tCurrentScope;
+
+		uint32_t this_thread()
+		{
+			static std::atomic<uint32_t> sNextThread;
+			thread_local uint32_t tThread = ++sNextThread;
+			return tThread;
+		}
+
+		const char* widget_type(const i_widget* aWidget)
+		{
+			return aWidget != nullptr ? typeid(*aWidget).name() : nullptr;
+		}
+
+		const char* event_name(profiler::event_type_e aType)
+		{
+			switch (aType)
+			{
+			case profiler::Frame:
+				return "frame";
+			case profiler::Render:
+				return "render";
+			case profiler::Paint:
+				return "paint";
+			case profiler::Layout:
+				return "layout";
+			case profiler::Update:
+				return "update";
+			case profiler::External:
+			default:
+				return "event";
+			}
+		}
+
+		std::string json_string(const char* aText)
+		{
+			std::string result = "\"";
+			for (const char* c = aText; c != nullptr && *c != '\0'; ++c)
+			{
+				if (*c == '"' || *c == '\\')
+					result += '\\';
+				if (static_cast<unsigned char>(*c) >= 0x20)
+					result += *c;
+			}
+			return result + "\"";
+		}
+
+		std::string address(const void* aPointer)
+		{
+			std::ostringstream result;
+			result << aPointer;
+			return result.str();
+		}
+	}
+
+	struct profiler::record
+	{
+		// zero while being written, otherwise one more than the index of the sample it holds
+		std::atomic<uint64_t> sequence;
+		sample value;
+	};
+
+	std::atomic<profiler*> profiler::sActive;
+
+	profiler::profiler() : 
+		iCapacity(0), iNext(0), iEpoch(clock::now())
+	{
+	}
+
+	profiler::~profiler()
+	{
+		disable();
+	}
+
+	bool profiler::enabled() const
+	{
+		return active() == this;
+	}
+
+	void profiler::enable(std::size_t aCapacity)
+	{
+		if (enabled())
+			return;
+		std::size_t capacity = 1;
+		while (capacity < aCapacity)
+			capacity *= 2;
+		if (capacity != iCapacity)
+		{
+			iRecords.reset(new record[capacity]);
+			iCapacity = capacity;
+		}
+		clear();
+		sActive.store(this);
+	}
+
+	void profiler::disable()
+	{
+		profiler* self = this;
+		sActive.compare_exchange_strong(self, nullptr);
+	}
+
+	void profiler::clear()
+	{
+		for (std::size_t i = 0; i < iCapacity; ++i)
+			iRecords[i].sequence.store(0, std::memory_order_relaxed);
+		iNext.store(0);
+		iEpoch = clock::now();
+	}
+
+	profiler::sample_list profiler::samples() const
+	{
+		sample_list result;
+		uint64_t next = iNext.load(std::memory_order_acquire);
+		uint64_t first = next > iCapacity ? next - iCapacity : 0;
+		result.reserve(static_cast<std::size_t>(next - first));
+		for (uint64_t i = first; i < next; ++i)
+		{
+			const record& r = iRecords[i & (iCapacity - 1)];
+			uint64_t sequence = r.sequence.load(std::memory_order_acquire);
+			if (sequence != i + 1)
+				continue;
+			sample value = r.value;
+			// discard the sample if a writer lapped us while we were copying it
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (r.sequence.load(std::memory_order_relaxed) != sequence)
+				continue;
+			result.push_back(value);
+		}
+		return result;
+	}
+
+	profiler::widget_statistics_list profiler::statistics() const
+	{
+		std::map<const i_widget*, widget_statistics> widgets;
+		for (const auto& s : samples())
+		{
+			if (s.widget == nullptr)
+				continue;
+			auto w = widgets.find(s.widget);
+			if (w == widgets.end())
+				w = widgets.insert(std::make_pair(s.widget, widget_statistics{ s.widget, s.widgetType, 0, 0.0, 0, 0.0, 0, 0.0, 0, {} })).first;
+			auto& statistics = w->second;
+			double milliseconds = s.duration / 1000000.0;
+			switch (s.type)
+			{
+			case Render:
+				++statistics.renderCount;
+				statistics.renderTime += milliseconds;
+				break;
+			case Paint:
+				++statistics.paintCount;
+				statistics.paintTime += milliseconds;
+				break;
+			case Layout:
+				++statistics.layoutCount;
+				statistics.layoutTime += milliseconds;
+				break;
+			case Update:
+				++statistics.updateCount;
+				++statistics.updateSources[s.sourceWidgetType != nullptr ? std::string(event_name(s.sourceType)) + " " + s.sourceWidgetType : event_name(s.sourceType)];
+				break;
+			default:
+				break;
+			}
+		}
+		widget_statistics_list result;
+		for (auto& w : widgets)
+			result.push_back(std::move(w.second));
+		std::sort(result.begin(), result.end(), [](const widget_statistics& aLeft, const widget_statistics& aRight) { return aLeft.paintTime > aRight.paintTime; });
+		return result;
+	}
+
+	void profiler::export_chrome_trace(std::ostream& aOutput) const
+	{
+		auto savedFlags = aOutput.flags();
+		auto savedPrecision = aOutput.precision();
+		// microseconds to the nearest nanosecond
+		aOutput << std::fixed << std::setprecision(3);
+		aOutput << "{\"traceEvents\":[";
+		bool first = true;
+		for (const auto& s : samples())
+		{
+			aOutput << (first ? "\n" : ",\n");
+			first = false;
+			aOutput << "{\"name\":" << (s.widgetType != nullptr ? json_string(s.widgetType) : json_string(event_name(s.type))) << 
+				",\"cat\":\"" << event_name(s.type) << "\"" <<
+				",\"pid\":1,\"tid\":" << s.thread << 
+				",\"ts\":" << s.start / 1000.0;
+			if (s.type == Update)
+				aOutput << ",\"ph\":\"i\",\"s\":\"t\"";
+			else
+				aOutput << ",\"ph\":\"X\",\"dur\":" << s.duration / 1000.0;
+			aOutput << ",\"args\":{";
+			if (s.widget != nullptr)
+				aOutput << "\"widget\":\"" << address(s.widget) << "\"";
+			if (s.type == Update)
+				aOutput << (s.widget != nullptr ? "," : "") << "\"source\":" << 
+					(s.sourceWidgetType != nullptr ? json_string((std::string(event_name(s.sourceType)) + " " + s.sourceWidgetType).c_str()) : json_string(event_name(s.sourceType)));
+			aOutput << "}}";
+		}
+		aOutput << "\n],\"displayTimeUnit\":\"ms\"}" << std::endl;
+		aOutput.flags(savedFlags);
+		aOutput.precision(savedPrecision);
+	}
+
+	void profiler::begin(scope& aScope, event_type_e aType, const i_widget* aWidget)
+	{
+		aScope.iType = aType;
+		aScope.iWidget = aWidget;
+		aScope.iParent = tCurrentScope;
+		aScope.iStart = now();
+		tCurrentScope = &aScope;
+	}
+
+	void profiler::end(const scope& aScope)
+	{
+		tCurrentScope = aScope.iParent;
+		uint64_t finish = now();
+		write(sample{ aScope.iType, aScope.iWidget, widget_type(aScope.iWidget),
+			aScope.iParent != nullptr ? aScope.iParent->iType : External,
+			aScope.iParent != nullptr ? aScope.iParent->iWidget : nullptr,
+			aScope.iParent != nullptr ? widget_type(aScope.iParent->iWidget) : nullptr,
+			aScope.iStart, finish - aScope.iStart, this_thread() });
+	}
+
+	void profiler::update(const i_widget& aWidget)
+	{
+		write(sample{ Update, &aWidget, widget_type(&aWidget),
+			tCurrentScope != nullptr ? tCurrentScope->iType : External,
+			tCurrentScope != nullptr ? tCurrentScope->iWidget : nullptr,
+			tCurrentScope != nullptr ? widget_type(tCurrentScope->iWidget) : nullptr,
+			now(), 0, this_thread() });
+	}
+
+	void profiler::write(const sample& aSample)
+	{
+		uint64_t index = iNext.fetch_add(1, std::memory_order_relaxed);
+		record& r = iRecords[index & (iCapacity - 1)];
+		r.sequence.store(0, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		r.value = aSample;
+		r.sequence.store(index + 1, std::memory_order_release);
+	}
+
+	uint64_t profiler::now() const
+	{
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - iEpoch).count());
+	}
+}
@@ -0,0 +1,135 @@
+// rendering_statistics_overlay.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "neogfx.hpp"
+#include <sstream>
+#include <iomanip>
+#include "app.hpp"
+#include "rendering_statistics_overlay.hpp"
+#include "graphics_context.hpp"
+
+namespace neogfx
+{
+	rendering_statistics_overlay::rendering_statistics_overlay(uint32_t aRefreshInterval) :
+		iUpdater(app::instance(), [this](neolib::callback_timer& aTimer) { aTimer.again(); iRefreshDue = true; }, aRefreshInterval), iRefreshDue(true), iOwnFrame(false)
+	{
+		init();
+	}
+
+	rendering_statistics_overlay::rendering_statistics_overlay(i_widget& aParent, uint32_t aRefreshInterval) :
+		widget(aParent), iUpdater(app::instance(), [this](neolib::callback_timer& aTimer) { aTimer.again(); iRefreshDue = true; }, aRefreshInterval), iRefreshDue(true), iOwnFrame(false)
+	{
+		init();
+	}
+
+	rendering_statistics_overlay::rendering_statistics_overlay(i_layout& aLayout, uint32_t aRefreshInterval) :
+		widget(aLayout), iUpdater(app::instance(), [this](neolib::callback_timer& aTimer) { aTimer.again(); iRefreshDue = true; }, aRefreshInterval), iRefreshDue(true), iOwnFrame(false)
+	{
+		init();
+	}
+
+	rendering_statistics_overlay::~rendering_statistics_overlay()
+	{
+		if (has_surface() && !surface().destroyed())
+			surface().native_surface().rendering_finished.unsubscribe(this);
+	}
+
+	neogfx::size_policy rendering_statistics_overlay::size_policy() const
+	{
+		if (widget::has_size_policy())
+			return widget::size_policy();
+		return neogfx::size_policy::Minimum;
+	}
+
+	size rendering_statistics_overlay::minimum_size(const optional_size& aAvailableSpace) const
+	{
+		if (has_minimum_size())
+			return widget::minimum_size(aAvailableSpace);
+		graphics_context gc(*this);
+		size result = gc.multiline_text_extent(text(), font()) + margins().size();
+		result.cx = std::ceil(result.cx);
+		result.cy = std::ceil(result.cy);
+		return result;
+	}
+
+	void rendering_statistics_overlay::paint(graphics_context& aGraphicsContext) const
+	{
+		aGraphicsContext.fill_rect(client_rect(), colour::Black.with_alpha(0xC0));
+		aGraphicsContext.draw_multiline_text(client_rect(false).top_left(), text(), font(), colour::White);
+	}
+
+	void rendering_statistics_overlay::parent_changed()
+	{
+		widget::parent_changed();
+		subscribe();
+	}
+
+	void rendering_statistics_overlay::init()
+	{
+		set_margins(neogfx::margins(4.0));
+		set_ignore_mouse_events(true);
+		if (has_surface())
+			subscribe();
+	}
+
+	void rendering_statistics_overlay::subscribe()
+	{
+		surface().native_surface().rendering_finished.unsubscribe(this);
+		surface().native_surface().rendering_finished([this]() { frame_finished(); }, this);
+	}
+
+	void rendering_statistics_overlay::frame_finished()
+	{
+		// the frame following our own update() only exists because of us so neither show its statistics nor refresh
+		if (iOwnFrame)
+		{
+			iOwnFrame = false;
+			return;
+		}
+		iStatistics = app::instance().rendering_engine().statistics();
+		if (iRefreshDue && effectively_visible())
+		{
+			iRefreshDue = false;
+			iOwnFrame = true;
+			update();
+		}
+	}
+
+	std::string rendering_statistics_overlay::text() const
+	{
+		const auto& statistics = iStatistics;
+		std::ostringstream result;
+		result << "Frame: " << statistics.frame << "\n";
+		result << "Draw calls: " << statistics.drawCalls << "\n";
+		result << "Vertices: " << statistics.vertices << "\n";
+		result << "Buffer uploads: " << statistics.bufferBytesUploaded / 1024 << " KiB\n";
+		result << "Texture binds: " << statistics.textureBinds << "\n";
+		result << "Shader switches: " << statistics.shaderSwitches << "\n";
+		result << "Stencil clears: " << statistics.stencilClears << "\n";
+		result << "Glyph uploads: " << statistics.glyphUploads << "\n";
+		result << "State changes: " << statistics.stateChanges << " (" << statistics.redundantStateChanges << " redundant)\n";
+		result << "GPU time: ";
+		if (statistics.gpuTime != boost::none)
+			result << std::fixed << std::setprecision(2) << *statistics.gpuTime << " ms";
+		else
+			result << "n/a";
+		return result.str();
+	}
+}
@@ -104,6 +104,27 @@ namespace neogfx
 		return result;
 	}
 
+	void scrollable_widget::render(graphics_context& aGraphicsContext) const
+	{
+		if (iPendingScroll != point{} && !effectively_hidden())
+		{
+			// move the part of last frame's client content that is still visible; only what scrolled into view has been marked for update
+			rect clientRect = client_rect();
+			rect source = clientRect.intersection(clientRect - iPendingScroll);
+			if (!source.empty())
+			{
+				if (iScrollBuffer == boost::none || iScrollBuffer->extents() != clientRect.extents())
+					iScrollBuffer = texture{ clientRect.extents() };
+				aGraphicsContext.set_extents(extents());
+				aGraphicsContext.set_origin(origin());
+				aGraphicsContext.copy_to_texture(source, *iScrollBuffer);
+				aGraphicsContext.copy_from_texture(*iScrollBuffer, source + iPendingScroll);
+			}
+		}
+		iPendingScroll = point{};
+		framed_widget::render(aGraphicsContext);
+	}
+
 	void scrollable_widget::paint_non_client(graphics_context& aGraphicsContext) const
 	{
 		framed_widget::paint_non_client(aGraphicsContext);
@@ -341,8 +362,14 @@ namespace neogfx
 		if (iIgnoreScrollbarUpdates)
 			return;
 		point scrollPosition = units_converter(*this).from_device_units(point(static_cast<coordinate>(horizontal_scrollbar().position()), static_cast<coordinate>(vertical_scrollbar().position())));
+		bool scrolledByCopy = false;
 		if (iOldScrollPosition != scrollPosition)
 		{
+			point contentDelta = -(scrollPosition - iOldScrollPosition);
+			if (aScrollbar.type() == i_scrollbar::Horizontal)
+				contentDelta.y = 0.0;
+			else if (aScrollbar.type() == i_scrollbar::Vertical)
+				contentDelta.x = 0.0;
 			for (auto& c : children())
 			{
 				point delta = -(scrollPosition - iOldScrollPosition);
@@ -360,8 +387,13 @@ namespace neogfx
 			{
 				iOldScrollPosition.x = scrollPosition.x;
 			}
+			scrolledByCopy = scroll_by_copy(contentDelta);
+		}
+		if (!scrolledByCopy)
+		{
+			iPendingScroll = point{};
+			update();
 		}
-		update();
 	}
 
 	colour scrollable_widget::scrollbar_colour(const i_scrollbar&) const
@@ -374,6 +406,46 @@ namespace neogfx
 		return surface();
 	}
 
+	bool scrollable_widget::scroll_by_copy(const point& aDelta)
+	{
+		// copying is only valid if the whole client area was rendered by us into a frame buffer that persists between frames; 
+		// child widgets have to move (and so repaint) anyway
+		if (!children().empty() || !has_surface() || !surface().native_surface().using_frame_buffer() || effectively_hidden() ||
+			logical_coordinate_system() != neogfx::logical_coordinate_system::AutomaticGui || !default_clip_rect(true).contains(rect{ point{}, extents() }))
+			return false;
+		point deviceDelta = units_converter(*this).to_device_units(aDelta);
+		if (std::floor(deviceDelta.x) != deviceDelta.x || std::floor(deviceDelta.y) != deviceDelta.y)
+			return false;
+		rect clientRect = client_rect();
+		point pendingScroll = iPendingScroll + aDelta;
+		if (std::abs(pendingScroll.x) >= clientRect.cx || std::abs(pendingScroll.y) >= clientRect.cy)
+			return false;
+		// anything still waiting to be painted moves along with the content
+		if (requires_update())
+		{
+			rect pending = update_rect().intersection(clientRect);
+			if (!pending.empty())
+			{
+				rect moved = (pending + aDelta).intersection(clientRect);
+				if (!moved.empty())
+					update(moved);
+			}
+		}
+		iPendingScroll = pendingScroll;
+		// the copied pixels have to be presented too; mark the whole client area dirty at the surface without repainting it
+		surface().invalidate_surface(clientRect + origin());
+		region exposed{ clientRect };
+		exposed.subtract(clientRect + aDelta);
+		for (const auto& r : exposed)
+			update(r);
+		// scrollbars and frame
+		region nonClient{ rect{ origin(true) - origin(), extents() } };
+		nonClient.subtract(clientRect);
+		for (const auto& r : nonClient)
+			update(r);
+		return true;
+	}
+
 	void scrollable_widget::update_scrollbar_visibility()
 	{
 		{
@@ -48,7 +48,9 @@ namespace neogfx
 
 	uint32_t sdl_basic_services::display_count() const
 	{
-		return SDL_GetNumVideoDisplays();
+		// negative if the video subsystem has not been initialized (e.g. when rendering offscreen)
+		int displayCount = SDL_GetNumVideoDisplays();
+		return displayCount > 0 ? static_cast<uint32_t>(displayCount) : 0;
 	}
 
 	rect sdl_basic_services::desktop_rect(uint32_t aDisplayIndex) const
@@ -57,7 +59,7 @@ namespace neogfx
 #ifdef WIN32
 		EnumDisplayMonitors(NULL, NULL, &enum_display_monitors_proc, reinterpret_cast<LPARAM>(this));
 #else
-		for (int i = 0; i < display_count(); ++i)
+		for (uint32_t i = 0; i < display_count(); ++i)
 		{
 			SDL_Rect rectDisplayBounds;
 			SDL_GetDisplayBounds(i, &rectDisplayBounds);
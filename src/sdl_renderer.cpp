@@ -30,6 +30,10 @@ namespace neogfx
 	sdl_renderer::sdl_renderer(i_basic_services& aBasicServices, i_keyboard& aKeyboard) : iBasicServices(aBasicServices), iKeyboard(aKeyboard), iCreatingWindow(0)
 	{
 		SDL_Init(SDL_INIT_VIDEO);
+		// the default shader program is GLSL 1.50 and nothing compatibility only is used so ask for a core profile context
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 2);
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
 	}
 
 	sdl_renderer::~sdl_renderer()
@@ -50,6 +54,7 @@ namespace neogfx
 		auto c = iContexts.find(&aSurface);
 		if (c == iContexts.end())
 			throw context_not_found();
+		context_destroyed(c->second);
 		SDL_GL_DeleteContext(c->second);
 		iContexts.erase(c);
 	}
@@ -219,4 +224,10 @@ namespace neogfx
 		}
 		return handledEvents;
 	}
+
+	void sdl_renderer::wait_for_events(frame_scheduler::duration aTimeout)
+	{
+		// a null event leaves whatever arrived in the queue for process_events
+		SDL_WaitEventTimeout(NULL, static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(aTimeout).count()));
+	}
 }
\ No newline at end of file
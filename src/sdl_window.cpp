@@ -22,7 +22,12 @@
 #include <SDL.h>
 #include <SDL_syswm.h>
 #include <SDL_mouse.h>
+#include <GL/glew.h>
+#ifdef WIN32
+#include <GL/wglew.h>
+#endif
 #include "opengl_error.hpp"
+#include "opengl_renderer.hpp"
 #include "sdl_window.hpp"
 #include "app.hpp"
 
@@ -491,6 +496,7 @@ namespace neogfx
 		{
 			release_capture();
 			event_handler().native_window_closing();
+			stop_present_thread();
 			if (!iDestroyed)
 			{
 #ifdef WIN32
@@ -794,6 +800,7 @@ namespace neogfx
 	{
 		if (SDL_GL_MakeCurrent(iHandle, iContext) != 0)
 			throw failed_to_activate_opengl_context(SDL_GetError());
+		static_cast<opengl_renderer&>(rendering_engine()).context_activated(iContext);
 		glCheck("");
 	}
 
@@ -819,11 +826,69 @@ namespace neogfx
 		return sStack;
 	}
 
-	void sdl_window::display()
+	bool sdl_window::partial_present() const
+	{
+		if (iPartialPresent == boost::none)
+		{
+			iPartialPresent = false;
+#ifdef WIN32
+			// presenting part of a frame relies on the back buffer being copied rather than exchanged on swap
+			if (WGLEW_ARB_pixel_format && GLEW_WIN_swap_hint)
+			{
+				HDC dc = wglGetCurrentDC();
+				int attribute = WGL_SWAP_METHOD_ARB;
+				int swapMethod = 0;
+				if (wglGetPixelFormatAttribivARB(dc, GetPixelFormat(dc), 0, 1, &attribute, &swapMethod))
+					iPartialPresent = (swapMethod == WGL_SWAP_COPY_ARB);
+			}
+#endif
+		}
+		return *iPartialPresent;
+	}
+
+	void sdl_window::display(const size& aFrameExtents, const std::vector<rect>& aDamagedRects)
 	{
+		// may be called on the present thread so the extents are those of the frame being presented, not our current ones
+#ifdef WIN32
+		if (partial_present())
+			for (const auto& dr : aDamagedRects)
+				glCheck(glAddSwapHintRectWIN(static_cast<GLint>(dr.x), static_cast<GLint>(aFrameExtents.cy - dr.bottom()), static_cast<GLsizei>(dr.cx), static_cast<GLsizei>(dr.cy)));
+#endif
 		SDL_GL_SwapWindow(iHandle);
 	}
 
+	boost::optional<uint32_t> sdl_window::vertical_sync_rate() const
+	{
+		if (SDL_GL_GetSwapInterval() == 0)
+			return boost::none;
+		SDL_DisplayMode displayMode;
+		if (SDL_GetWindowDisplayMode(iHandle, &displayMode) != 0 || displayMode.refresh_rate == 0)
+			return 60;
+		return static_cast<uint32_t>(displayMode.refresh_rate);
+	}
+
+	void* sdl_window::create_presentation_context()
+	{
+		// called with our own context current so that the new one shares its objects; creating it makes it current
+		SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 1);
+		SDL_GLContext context = SDL_GL_CreateContext(iHandle);
+		SDL_GL_SetAttribute(SDL_GL_SHARE_WITH_CURRENT_CONTEXT, 0);
+		if (context == 0)
+			throw failed_to_create_opengl_context(SDL_GetError());
+		do_activate_context();
+		return context;
+	}
+
+	void sdl_window::make_presentation_context_current(void* aContext)
+	{
+		SDL_GL_MakeCurrent(iHandle, static_cast<SDL_GLContext>(aContext));
+	}
+
+	void sdl_window::destroy_presentation_context(void* aContext)
+	{
+		SDL_GL_DeleteContext(static_cast<SDL_GLContext>(aContext));
+	}
+
 	bool sdl_window::processing_event() const
 	{
 		return iProcessingEvent;
@@ -0,0 +1,835 @@
+// software_graphics_context.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "neogfx.hpp"
+#include <boost/math/constants/constants.hpp>
+#include "glyph.hpp"
+#include "i_rendering_engine.hpp"
+#include "i_native_font_face.hpp"
+#include "i_font_texture.hpp"
+#include "i_texture.hpp"
+#include "i_native_texture.hpp"
+#include "software_window.hpp"
+#include "software_graphics_context.hpp"
+
+namespace neogfx
+{
+	namespace
+	{
+		inline software_rasterizer::rgba to_rgba(const colour& aColour)
+		{
+			return software_rasterizer::rgba{{aColour.red(), aColour.green(), aColour.blue(), aColour.alpha()}};
+		}
+
+		inline double pixel_adjust(const dimension aWidth)
+		{
+			return static_cast<uint32_t>(aWidth) % 2 == 1 ? 0.5 : 0.0;
+		}
+
+		inline double pixel_adjust(const pen& aPen)
+		{
+			return pixel_adjust(aPen.width());
+		}
+
+		inline rect circle_bounds(const point& aCentre, dimension aRadius)
+		{
+			return rect{ aCentre - point{ aRadius, aRadius }, size{ aRadius * 2.0, aRadius * 2.0 } };
+		}
+
+		inline std::vector<point> path_points(const path& aPath, const path::path_type& aSubPath)
+		{
+			std::vector<point> result;
+			result.reserve(aSubPath.size());
+			for (const auto& v : aSubPath)
+				result.push_back(v + aPath.position());
+			return result;
+		}
+
+		const i_glyph_texture& glyph_texture(const glyph& aGlyph, const font& aFont)
+		{
+			return !aGlyph.use_fallback() ? aFont.native_font_face().glyph_texture(aGlyph) : aFont.fallback().native_font_face().glyph_texture(aGlyph);
+		}
+	}
+
+	software_graphics_context::software_graphics_context(i_rendering_engine& aRenderingEngine, const software_window& aSurface) :
+		iRenderingEngine(aRenderingEngine),
+		iSurface(aSurface),
+		iSavedCoordinateSystem(aSurface.logical_coordinate_system()),
+		iLogicalCoordinateSystem(iSavedCoordinateSystem),
+		iLogicalCoordinates(aSurface.logical_coordinates()),
+		iSmoothingMode(SmoothingModeNone),
+		iMonochrome(false),
+		iRecording(0),
+		iDrawingGlyphs(false)
+	{
+		update_scissor();
+		set_smoothing_mode(SmoothingModeAntiAlias);
+	}
+
+	software_graphics_context::software_graphics_context(i_rendering_engine& aRenderingEngine, const software_window& aSurface, const i_widget& aWidget) :
+		iRenderingEngine(aRenderingEngine),
+		iSurface(aSurface),
+		iSavedCoordinateSystem(aWidget.logical_coordinate_system()),
+		iLogicalCoordinateSystem(iSavedCoordinateSystem),
+		iLogicalCoordinates(aSurface.logical_coordinates()),
+		iSmoothingMode(SmoothingModeNone),
+		iMonochrome(false),
+		iRecording(0),
+		iDrawingGlyphs(false)
+	{
+		update_scissor();
+		set_smoothing_mode(SmoothingModeAntiAlias);
+	}
+
+	software_graphics_context::software_graphics_context(const software_graphics_context& aOther) :
+		iRenderingEngine(aOther.iRenderingEngine),
+		iSurface(aOther.iSurface),
+		iSavedCoordinateSystem(aOther.iSavedCoordinateSystem),
+		iLogicalCoordinateSystem(aOther.iLogicalCoordinateSystem),
+		iLogicalCoordinates(aOther.iLogicalCoordinates),
+		iSmoothingMode(aOther.iSmoothingMode),
+		iMonochrome(false),
+		iRecording(0),
+		iDrawingGlyphs(false)
+	{
+		update_scissor();
+	}
+
+	software_graphics_context::~software_graphics_context()
+	{
+		flush();
+		set_logical_coordinate_system(iSavedCoordinateSystem);
+	}
+
+	std::unique_ptr<i_native_graphics_context> software_graphics_context::clone() const
+	{
+		return std::unique_ptr<i_native_graphics_context>(new software_graphics_context(*this));
+	}
+
+	const i_native_surface& software_graphics_context::surface() const
+	{
+		return iSurface;
+	}
+
+	rect software_graphics_context::rendering_area(bool aConsiderScissor) const
+	{
+		if (scissor_rect() == boost::none || !aConsiderScissor)
+			return rect{ point{}, iSurface.surface_size() };
+		else
+			return *scissor_rect();
+	}
+
+	neogfx::logical_coordinate_system software_graphics_context::logical_coordinate_system() const
+	{
+		return iLogicalCoordinateSystem;
+	}
+
+	void software_graphics_context::set_logical_coordinate_system(neogfx::logical_coordinate_system aSystem)
+	{
+		iLogicalCoordinateSystem = aSystem;
+	}
+
+	const vector4& software_graphics_context::logical_coordinates() const
+	{
+		switch (iLogicalCoordinateSystem)
+		{
+		case neogfx::logical_coordinate_system::Specified:
+			return iLogicalCoordinates;
+		case neogfx::logical_coordinate_system::AutomaticGui:
+			return iLogicalCoordinates = vector4{ 0.0, surface().surface_size().cy, surface().surface_size().cx, 0.0 };
+		case neogfx::logical_coordinate_system::AutomaticGame:
+			return iLogicalCoordinates = vector4{ 0.0, 0.0, surface().surface_size().cx, surface().surface_size().cy };
+		}
+		return iLogicalCoordinates;
+	}
+
+	void software_graphics_context::set_logical_coordinates(const vector4& aCoordinates) const
+	{
+		// commands are recorded in device coordinates so there is nothing to flush
+		iLogicalCoordinates = aCoordinates;
+	}
+
+	void software_graphics_context::flush()
+	{
+		if (iRasterizer.empty())
+			return;
+		iRasterizer.execute(target());
+	}
+
+	void software_graphics_context::begin_recording()
+	{
+		++iRecording;
+	}
+
+	void software_graphics_context::end_recording()
+	{
+		if (--iRecording == 0)
+			flush();
+	}
+
+	void software_graphics_context::scissor_on(const rect& aRect)
+	{
+		iScissorRects.push_back(aRect);
+		update_scissor();
+	}
+
+	void software_graphics_context::scissor_off()
+	{
+		iScissorRects.pop_back();
+		update_scissor();
+	}
+
+	optional_rect software_graphics_context::scissor_rect() const
+	{
+		if (iScissorRects.empty())
+			return optional_rect();
+		rect result = *iScissorRects.begin();
+		for (auto& r : iScissorRects)
+			result = result.intersection(r);
+		return result;
+	}
+
+	void software_graphics_context::update_scissor()
+	{
+		auto scissorRect = scissor_rect();
+		for (const auto& c : iClipStack)
+			if (c.scissor != boost::none)
+				scissorRect = scissorRect != boost::none ? scissorRect->intersection(*c.scissor) : *c.scissor;
+		size surfaceSize = surface().surface_size();
+		if (scissorRect == boost::none)
+		{
+			iScissor = software_rasterizer::device_rect{ 0, 0, static_cast<int32_t>(surfaceSize.cx), static_cast<int32_t>(surfaceSize.cy) };
+			return;
+		}
+		// rounded exactly as the OpenGL contexts round their scissor boxes
+		int32_t x = static_cast<int32_t>(std::ceil(scissorRect->x));
+		int32_t y = static_cast<int32_t>(std::ceil(surfaceSize.cy - scissorRect->cy - scissorRect->y));
+		int32_t cx = static_cast<int32_t>(std::ceil(scissorRect->cx));
+		int32_t cy = static_cast<int32_t>(std::ceil(scissorRect->cy));
+		int32_t top = static_cast<int32_t>(surfaceSize.cy) - y - cy;
+		iScissor = software_rasterizer::device_rect{ x, top, x + cx, top + cy };
+	}
+
+	void software_graphics_context::clip_to(const rect& aRect)
+	{
+		// in GUI coordinates a rectangular clip is just another scissor rectangle
+		if (iLogicalCoordinateSystem == neogfx::logical_coordinate_system::AutomaticGui)
+		{
+			iClipStack.push_back(clip{ aRect, nullptr });
+			update_scissor();
+			return;
+		}
+		clip_to(path{ aRect }, 0.0);
+	}
+
+	void software_graphics_context::clip_to(const path& aPath, dimension aPathOutline)
+	{
+		software_rasterizer::edge_list edges;
+		for (const auto& subPath : aPath.paths())
+			if (subPath.size() > 2)
+				add_edges(edges, path_points(aPath, subPath));
+		if (aPathOutline != 0)
+		{
+			path innerPath = aPath;
+			innerPath.deflate(aPathOutline);
+			for (const auto& subPath : innerPath.paths())
+				if (subPath.size() > 2)
+					add_edges(edges, path_points(innerPath, subPath));
+		}
+		software_rasterizer::mask_pointer enclosingMask;
+		for (const auto& c : iClipStack)
+			if (c.mask != nullptr)
+				enclosingMask = c.mask;
+		size surfaceSize = surface().surface_size();
+		iClipStack.push_back(clip{ boost::none, software_rasterizer::rasterize_mask(edges, 
+			aPathOutline != 0 ? software_rasterizer::EvenOdd : software_rasterizer::NonZero, analytic_anti_alias(),
+			software_rasterizer::device_rect{ 0, 0, static_cast<int32_t>(surfaceSize.cx), static_cast<int32_t>(surfaceSize.cy) }, enclosingMask) });
+	}
+
+	void software_graphics_context::reset_clip()
+	{
+		if (iClipStack.empty())
+			return;
+		bool scissor = iClipStack.back().scissor != boost::none;
+		iClipStack.pop_back();
+		if (scissor)
+			update_scissor();
+	}
+
+	bool software_graphics_context::monochrome() const
+	{
+		return iMonochrome;
+	}
+
+	void software_graphics_context::set_monochrome(bool aMonochrome)
+	{
+		iMonochrome = aMonochrome;
+	}
+
+	smoothing_mode_e software_graphics_context::smoothing_mode() const
+	{
+		return iSmoothingMode;
+	}
+
+	smoothing_mode_e software_graphics_context::set_smoothing_mode(smoothing_mode_e aSmoothingMode)
+	{
+		smoothing_mode_e oldSmoothingMode = iSmoothingMode;
+		iSmoothingMode = aSmoothingMode;
+		return oldSmoothingMode;
+	}
+
+	void software_graphics_context::push_logical_operation(logical_operation_e aLogicalOperation)
+	{
+		iLogicalOperationStack.push_back(aLogicalOperation);
+	}
+
+	void software_graphics_context::pop_logical_operation()
+	{
+		if (!iLogicalOperationStack.empty())
+			iLogicalOperationStack.pop_back();
+	}
+
+	void software_graphics_context::line_stipple_on(uint32_t aFactor, uint16_t aPattern)
+	{
+		iLineStipple = std::make_pair(aFactor, aPattern);
+	}
+
+	void software_graphics_context::line_stipple_off()
+	{
+		iLineStipple = boost::none;
+	}
+
+	void software_graphics_context::clear(const colour& aColour)
+	{
+		disable_anti_alias daa(*this);
+		fill_rect(rendering_area(), aColour);
+	}
+
+	void software_graphics_context::set_pixel(const point& aPoint, const colour& aColour)
+	{
+		draw_pixel(aPoint, aColour);
+	}
+
+	void software_graphics_context::draw_pixel(const point& aPoint, const colour& aColour)
+	{
+		point devicePoint = to_device(aPoint);
+		float x = static_cast<float>(std::floor(devicePoint.x));
+		float y = static_cast<float>(std::floor(devicePoint.y));
+		iRasterizer.fill_area(render_state(false), software_rasterizer::area{ x, y, x + 1.0f, y + 1.0f }, solid(aColour));
+		commit();
+	}
+
+	void software_graphics_context::draw_line(const point& aFrom, const point& aTo, const pen& aPen)
+	{
+		double pixelAdjust = pixel_adjust(aPen);
+		stroke(std::vector<point>{ aFrom + point{ pixelAdjust, pixelAdjust }, aTo + point{ pixelAdjust, pixelAdjust } }, false, aPen.width(), aPen.colour());
+	}
+
+	void software_graphics_context::draw_rect(const rect& aRect, const pen& aPen)
+	{
+		double pixelAdjust = pixel_adjust(aPen);
+		if (analytic_anti_alias())
+		{
+			draw_shape(rect{ aRect }.deflate(pixelAdjust, pixelAdjust), 0.0, aPen.width(), solid(aPen.colour()));
+			return;
+		}
+		// the same four lines the OpenGL contexts draw so that stippled focus rectangles look the same
+		begin_recording();
+		stroke(std::vector<point>{ point{ aRect.top_left().x, aRect.top_left().y + pixelAdjust }, point{ aRect.top_right().x, aRect.top_right().y + pixelAdjust } }, false, aPen.width(), aPen.colour());
+		stroke(std::vector<point>{ point{ aRect.top_right().x - pixelAdjust, aRect.top_right().y }, point{ aRect.bottom_right().x - pixelAdjust, aRect.bottom_right().y } }, false, aPen.width(), aPen.colour());
+		stroke(std::vector<point>{ point{ aRect.bottom_right().x, aRect.bottom_right().y - pixelAdjust }, point{ aRect.bottom_left().x, aRect.bottom_left().y - pixelAdjust } }, false, aPen.width(), aPen.colour());
+		stroke(std::vector<point>{ point{ aRect.bottom_left().x + pixelAdjust, aRect.bottom_left().y }, point{ aRect.top_left().x + pixelAdjust, aRect.top_left().y } }, false, aPen.width(), aPen.colour());
+		end_recording();
+	}
+
+	void software_graphics_context::draw_rounded_rect(const rect& aRect, dimension aRadius, const pen& aPen)
+	{
+		double pixelAdjust = pixel_adjust(aPen);
+		draw_shape(rect{ aRect }.deflate(pixelAdjust, pixelAdjust), aRadius, aPen.width(), solid(aPen.colour()));
+	}
+
+	void software_graphics_context::draw_circle(const point& aCentre, dimension aRadius, const pen& aPen)
+	{
+		draw_shape(circle_bounds(aCentre, aRadius), aRadius, aPen.width(), solid(aPen.colour()));
+	}
+
+	void software_graphics_context::draw_arc(const point& aCentre, dimension aRadius, angle aStartAngle, angle aEndAngle, const pen& aPen)
+	{
+		std::vector<point> points;
+		for (const auto& v : rendering_engine().tessellation_cache().arc(aRadius, aStartAngle, aEndAngle, false))
+			points.push_back(point{ v.x + aCentre.x, v.y + aCentre.y });
+		stroke(points, false, aPen.width(), aPen.colour());
+	}
+
+	void software_graphics_context::draw_path(const path& aPath, const pen& aPen)
+	{
+		begin_recording();
+		for (std::size_t i = 0; i < aPath.paths().size(); ++i)
+		{
+			if (aPath.paths()[i].size() <= 2)
+				continue;
+			auto points = path_points(aPath, aPath.paths()[i]);
+			switch (aPath.shape())
+			{
+			case path::ConvexPolygon:
+				{
+					// the band between the polygon and the polygon deflated by the pen width
+					software_rasterizer::edge_list edges;
+					add_edges(edges, points);
+					path innerPath = aPath;
+					innerPath.deflate(aPen.width());
+					add_edges(edges, path_points(innerPath, innerPath.paths()[i]));
+					iRasterizer.fill_polygon(render_state(analytic_anti_alias()), edges, software_rasterizer::EvenOdd, solid(aPen.colour()));
+				}
+				break;
+			case path::Quads:
+				for (std::size_t j = 0; j + 3 < points.size(); j += 4)
+					fill_polygon(std::vector<point>(points.begin() + j, points.begin() + j + 4), aPen.colour());
+				break;
+			case path::Lines:
+				for (std::size_t j = 0; j + 1 < points.size(); j += 2)
+					stroke(std::vector<point>(points.begin() + j, points.begin() + j + 2), false, 1.0, aPen.colour());
+				break;
+			case path::LineLoop:
+				stroke(points, true, 1.0, aPen.colour());
+				break;
+			case path::LineStrip:
+				stroke(points, false, 1.0, aPen.colour());
+				break;
+			case path::Vertices:
+			default:
+				for (const auto& p : points)
+					draw_pixel(p, aPen.colour());
+				break;
+			}
+		}
+		end_recording();
+	}
+
+	void software_graphics_context::fill_rect(const rect& aRect, const colour& aColour)
+	{
+		iRasterizer.fill_area(render_state(analytic_anti_alias()), to_device(aRect), solid(aColour));
+		commit();
+	}
+
+	void software_graphics_context::fill_rect(const rect& aRect, const gradient& aGradient)
+	{
+		fill_rounded_rect(aRect, 0.0, aGradient);
+	}
+
+	void software_graphics_context::fill_rounded_rect(const rect& aRect, dimension aRadius, const colour& aColour)
+	{
+		draw_shape(aRect, aRadius, 0.0, solid(aColour));
+	}
+
+	void software_graphics_context::fill_rounded_rect(const rect& aRect, dimension aRadius, const gradient& aGradient)
+	{
+		if (aRect.empty())
+			return;
+		auto gradientPaint = std::make_shared<software_rasterizer::gradient_paint>();
+		for (std::size_t i = 0; i < software_rasterizer::GradientLookupSize; ++i)
+			gradientPaint->lookup[i] = to_rgba(aGradient.at(static_cast<double>(i) / (software_rasterizer::GradientLookupSize - 1)));
+		gradientPaint->direction = aGradient.direction();
+		// the gradient follows the logical axes so its box keeps their direction
+		const auto& logicalCoordinates = logical_coordinates();
+		size surfaceSize = surface().surface_size();
+		point centre = to_device(aRect.centre());
+		gradientPaint->cx = static_cast<float>(centre.x);
+		gradientPaint->cy = static_cast<float>(centre.y);
+		gradientPaint->halfWidth = static_cast<float>(aRect.cx / 2.0 * surfaceSize.cx / (logicalCoordinates[2] - logicalCoordinates[0]));
+		gradientPaint->halfHeight = static_cast<float>(aRect.cy / 2.0 * surfaceSize.cy / (logicalCoordinates[1] - logicalCoordinates[3]));
+		software_rasterizer::paint paint{ software_rasterizer::rgba{{0xFF, 0xFF, 0xFF, 0xFF}}, gradientPaint, nullptr };
+		draw_shape(aRect, aRadius, 0.0, paint);
+	}
+
+	void software_graphics_context::fill_circle(const point& aCentre, dimension aRadius, const colour& aColour)
+	{
+		draw_shape(circle_bounds(aCentre, aRadius), aRadius, 0.0, solid(aColour));
+	}
+
+	void software_graphics_context::fill_arc(const point& aCentre, dimension aRadius, angle aStartAngle, angle aEndAngle, const colour& aColour)
+	{
+		std::vector<point> points;
+		for (const auto& v : rendering_engine().tessellation_cache().arc(aRadius, aStartAngle, aEndAngle, true))
+			points.push_back(point{ v.x + aCentre.x, v.y + aCentre.y });
+		fill_polygon(points, aColour);
+	}
+
+	void software_graphics_context::fill_shape(const point& aCentre, const vertex_list2& aVertices, const colour& aColour)
+	{
+		// the OpenGL contexts fan the vertices about the centre; as an outline the vertices alone cover the same pixels
+		std::vector<point> points;
+		points.reserve(aVertices.size());
+		for (const auto& v : aVertices)
+			points.push_back(point{ v[0], v[1] });
+		fill_polygon(points, aColour);
+	}
+
+	void software_graphics_context::fill_and_draw_path(const path& aPath, const colour& aFillColour, const pen& aPen)
+	{
+		software_rasterizer::edge_list edges;
+		for (const auto& subPath : aPath.paths())
+			if (subPath.size() > 2)
+				add_edges(edges, path_points(aPath, subPath));
+		iRasterizer.fill_polygon(render_state(analytic_anti_alias()), edges, 
+			aPath.fill_rule() == FillRuleEvenOdd ? software_rasterizer::EvenOdd : software_rasterizer::NonZero, solid(aFillColour));
+		commit();
+		if (aPen.width() != 0.0)
+			draw_path(aPath, aPen);
+	}
+
+	glyph_text software_graphics_context::to_glyph_text(string::const_iterator aTextBegin, string::const_iterator aTextEnd, const font& aFont) const
+	{
+		return to_glyph_text(aTextBegin, aTextEnd, [&aFont](std::string::size_type) { return aFont; });
+	}
+
+	glyph_text software_graphics_context::to_glyph_text(string::const_iterator aTextBegin, string::const_iterator aTextEnd, std::function<font(std::string::size_type)> aFontSelector) const
+	{
+		return iTextShaper.to_glyph_text(aTextBegin, aTextEnd, aFontSelector);
+	}
+
+	void software_graphics_context::set_mnemonic(bool aShowMnemonics, char aMnemonicPrefix)
+	{
+		iTextShaper.set_mnemonic(aShowMnemonics, aMnemonicPrefix);
+	}
+
+	void software_graphics_context::unset_mnemonic()
+	{
+		iTextShaper.unset_mnemonic();
+	}
+
+	bool software_graphics_context::mnemonics_shown() const
+	{
+		return iTextShaper.mnemonics_shown();
+	}
+
+	void software_graphics_context::begin_drawing_glyphs()
+	{
+		iDrawingGlyphs = true;
+	}
+
+	void software_graphics_context::draw_glyph(const point& aPoint, const glyph& aGlyph, const font& aFont, const colour& aColour)
+	{
+		if (aGlyph.is_whitespace())
+			return;
+		draw_glyph_mask(aPoint, glyph_texture(aGlyph, aFont), aFont, aColour);
+		commit();
+	}
+
+	void software_graphics_context::draw_glyph_run(const glyph_run& aRun)
+	{
+		for (const auto& item : aRun)
+		{
+			if (item.glyph->is_whitespace() && !item.underline)
+				continue;
+			const i_glyph_texture& glyphTexture = glyph_texture(*item.glyph, *item.font);
+			if (!item.glyph->is_whitespace())
+				draw_glyph_mask(item.position + item.glyph->offset(), glyphTexture, *item.font, item.colour);
+			if (item.underline)
+				draw_glyph_underline(item.position, glyphTexture, *item.font, item.colour);
+		}
+		commit();
+	}
+
+	void software_graphics_context::end_drawing_glyphs()
+	{
+		iDrawingGlyphs = false;
+		commit();
+	}
+
+	void software_graphics_context::draw_texture(const texture_map& aTextureMap, const i_texture& aTexture, const rect& aTextureRect, const optional_colour& aColour)
+	{
+		if (aTexture.is_empty())
+			return;
+		auto nativeTexture = aTexture.native_texture();
+		if (nativeTexture->data() == nullptr)
+			return;
+		// texel coordinates of the storage (which has a one texel border) for the first, second and fourth corners
+		rect textureRect = aTextureRect + point{ 1.0, 1.0 };
+		double s0 = textureRect.left();
+		double s1 = textureRect.right();
+		double t0 = textureRect.top();
+		double t1 = textureRect.bottom();
+		if (logical_coordinates()[1] < logical_coordinates()[3])
+			std::swap(t0, t1);
+		point d0 = to_device(point{ aTextureMap[0][0], aTextureMap[0][1] });
+		point d1 = to_device(point{ aTextureMap[1][0], aTextureMap[1][1] });
+		point d2 = to_device(point{ aTextureMap[2][0], aTextureMap[2][1] });
+		point d3 = to_device(point{ aTextureMap[3][0], aTextureMap[3][1] });
+		// the map is treated as a parallelogram: solve for the affine transformation from device to texel coordinates
+		double e1x = d1.x - d0.x;
+		double e1y = d1.y - d0.y;
+		double e2x = d3.x - d0.x;
+		double e2y = d3.y - d0.y;
+		double determinant = e1x * e2y - e1y * e2x;
+		if (std::abs(determinant) < 1.0e-9)
+			return;
+		double dudx = e2y / determinant;
+		double dudy = -e2x / determinant;
+		double dvdx = -e1y / determinant;
+		double dvdy = e1x / determinant;
+		double u0 = -d0.x * dudx - d0.y * dudy;
+		double v0 = -d0.x * dvdx - d0.y * dvdy;
+		auto texturePaint = std::make_shared<software_rasterizer::texture_paint>();
+		texturePaint->texture = nativeTexture;
+		texturePaint->texels = static_cast<const uint8_t*>(nativeTexture->data());
+		texturePaint->width = static_cast<int32_t>(nativeTexture->storage_extents().cx);
+		texturePaint->height = static_cast<int32_t>(nativeTexture->storage_extents().cy);
+		texturePaint->s0 = static_cast<float>(s0 + (s1 - s0) * u0);
+		texturePaint->t0 = static_cast<float>(t0 + (t1 - t0) * v0);
+		texturePaint->dsdx = static_cast<float>((s1 - s0) * dudx);
+		texturePaint->dsdy = static_cast<float>((s1 - s0) * dudy);
+		texturePaint->dtdx = static_cast<float>((t1 - t0) * dvdx);
+		texturePaint->dtdy = static_cast<float>((t1 - t0) * dvdy);
+		texturePaint->monochrome = iMonochrome;
+		software_rasterizer::edge_list edges{
+			software_rasterizer::edge{ static_cast<float>(d0.x), static_cast<float>(d0.y), static_cast<float>(d1.x), static_cast<float>(d1.y) },
+			software_rasterizer::edge{ static_cast<float>(d1.x), static_cast<float>(d1.y), static_cast<float>(d2.x), static_cast<float>(d2.y) },
+			software_rasterizer::edge{ static_cast<float>(d2.x), static_cast<float>(d2.y), static_cast<float>(d3.x), static_cast<float>(d3.y) },
+			software_rasterizer::edge{ static_cast<float>(d3.x), static_cast<float>(d3.y), static_cast<float>(d0.x), static_cast<float>(d0.y) } };
+		software_rasterizer::paint paint{ to_rgba(aColour != boost::none ? *aColour : colour{ 0xFF, 0xFF, 0xFF, 0xFF }), nullptr, texturePaint };
+		iRasterizer.fill_polygon(render_state(false), edges, software_rasterizer::NonZero, paint);
+		commit();
+	}
+
+	void software_graphics_context::copy_to_texture(const rect& aSourceRect, const i_texture& aTexture)
+	{
+		flush();
+		// texture rows run bottom to top as they do after an OpenGL copy so either kind of context can read them back
+		const i_image& source = target();
+		int32_t width = static_cast<int32_t>(source.extents().cx);
+		int32_t height = static_cast<int32_t>(source.extents().cy);
+		int32_t x = static_cast<int32_t>(aSourceRect.x);
+		int32_t bottom = static_cast<int32_t>(aSourceRect.bottom());
+		int32_t cx = static_cast<int32_t>(aSourceRect.cx);
+		int32_t cy = static_cast<int32_t>(aSourceRect.cy);
+		if (cx <= 0 || cy <= 0 || source.size() == 0)
+			return;
+		const uint8_t* sourcePixels = static_cast<const uint8_t*>(source.data());
+		std::vector<uint8_t> pixels(static_cast<std::size_t>(cx) * cy * 4);
+		for (int32_t row = 0; row < cy; ++row)
+		{
+			int32_t y = bottom - 1 - row;
+			if (y < 0 || y >= height)
+				continue;
+			for (int32_t column = std::max(0, -x); column < cx && x + column < width; ++column)
+				std::copy(sourcePixels + (static_cast<std::size_t>(y) * width + x + column) * 4, sourcePixels + (static_cast<std::size_t>(y) * width + x + column + 1) * 4,
+					&pixels[(static_cast<std::size_t>(row) * cx + column) * 4]);
+		}
+		aTexture.native_texture()->update(rect{ point{ 1.0, 1.0 }, size{ static_cast<dimension>(cx), static_cast<dimension>(cy) } }, &pixels[0]);
+	}
+
+	void software_graphics_context::copy_from_texture(const i_texture& aTexture, const rect& aDestinationRect)
+	{
+		flush();
+		auto nativeTexture = aTexture.native_texture();
+		if (nativeTexture->data() == nullptr || target().size() == 0)
+			return;
+		// like a frame buffer blit this replaces the destination and ignores the scissor
+		i_image& destination = target();
+		int32_t width = static_cast<int32_t>(destination.extents().cx);
+		int32_t height = static_cast<int32_t>(destination.extents().cy);
+		int32_t storageWidth = static_cast<int32_t>(nativeTexture->storage_extents().cx);
+		int32_t x = static_cast<int32_t>(aDestinationRect.x);
+		int32_t bottom = static_cast<int32_t>(aDestinationRect.bottom());
+		int32_t cx = std::min(static_cast<int32_t>(aDestinationRect.cx), storageWidth - 1);
+		int32_t cy = std::min(static_cast<int32_t>(aDestinationRect.cy), static_cast<int32_t>(nativeTexture->storage_extents().cy) - 1);
+		const uint8_t* texels = static_cast<const uint8_t*>(nativeTexture->data());
+		uint8_t* pixels = static_cast<uint8_t*>(destination.data());
+		for (int32_t row = 0; row < cy; ++row)
+		{
+			int32_t y = bottom - 1 - row;
+			if (y < 0 || y >= height)
+				continue;
+			for (int32_t column = std::max(0, -x); column < cx && x + column < width; ++column)
+				std::copy(texels + (static_cast<std::size_t>(row + 1) * storageWidth + column + 1) * 4, texels + (static_cast<std::size_t>(row + 1) * storageWidth + column + 2) * 4,
+					pixels + (static_cast<std::size_t>(y) * width + x + column) * 4);
+		}
+	}
+
+	i_image& software_graphics_context::target() const
+	{
+		return iSurface.back_buffer();
+	}
+
+	software_renderer& software_graphics_context::rendering_engine() const
+	{
+		return static_cast<software_renderer&>(iRenderingEngine);
+	}
+
+	bool software_graphics_context::analytic_anti_alias() const
+	{
+		return iSmoothingMode == SmoothingModeAntiAlias;
+	}
+
+	point software_graphics_context::to_device(const point& aPoint) const
+	{
+		const auto& logicalCoordinates = logical_coordinates();
+		size surfaceSize = surface().surface_size();
+		return point{
+			(aPoint.x - logicalCoordinates[0]) / (logicalCoordinates[2] - logicalCoordinates[0]) * surfaceSize.cx,
+			(aPoint.y - logicalCoordinates[3]) / (logicalCoordinates[1] - logicalCoordinates[3]) * surfaceSize.cy };
+	}
+
+	software_rasterizer::area software_graphics_context::to_device(const rect& aRect) const
+	{
+		point a = to_device(aRect.top_left());
+		point b = to_device(aRect.bottom_right());
+		return software_rasterizer::area{
+			static_cast<float>(std::min(a.x, b.x)), static_cast<float>(std::min(a.y, b.y)),
+			static_cast<float>(std::max(a.x, b.x)), static_cast<float>(std::max(a.y, b.y)) };
+	}
+
+	dimension software_graphics_context::to_device(dimension aLength) const
+	{
+		const auto& logicalCoordinates = logical_coordinates();
+		return std::abs(aLength * surface().surface_size().cx / (logicalCoordinates[2] - logicalCoordinates[0]));
+	}
+
+	software_rasterizer::state software_graphics_context::render_state(bool aAntiAlias) const
+	{
+		software_rasterizer::mask_pointer clipMask;
+		for (const auto& c : iClipStack)
+			if (c.mask != nullptr)
+				clipMask = c.mask;
+		bool logicalXor = !iLogicalOperationStack.empty() && iLogicalOperationStack.back() == LogicalXor;
+		return software_rasterizer::state{ iScissor, clipMask, logicalXor ? software_rasterizer::Xor : software_rasterizer::Blend, aAntiAlias };
+	}
+
+	software_rasterizer::paint software_graphics_context::solid(const colour& aColour) const
+	{
+		return software_rasterizer::paint{ to_rgba(aColour), nullptr, nullptr };
+	}
+
+	void software_graphics_context::add_edges(software_rasterizer::edge_list& aEdges, const std::vector<point>& aPolygon) const
+	{
+		if (aPolygon.size() < 2)
+			return;
+		point previous = to_device(aPolygon.back());
+		for (const auto& p : aPolygon)
+		{
+			point current = to_device(p);
+			aEdges.push_back(software_rasterizer::edge{ 
+				static_cast<float>(previous.x), static_cast<float>(previous.y), static_cast<float>(current.x), static_cast<float>(current.y) });
+			previous = current;
+		}
+	}
+
+	void software_graphics_context::add_stroke_edges(software_rasterizer::edge_list& aEdges, const point& aFrom, const point& aTo, dimension aWidth) const
+	{
+		point from = to_device(aFrom);
+		point to = to_device(aTo);
+		double dx = to.x - from.x;
+		double dy = to.y - from.y;
+		double length = std::sqrt(dx * dx + dy * dy);
+		if (length == 0.0)
+			return;
+		double ux = dx / length;
+		double uy = dy / length;
+		double halfWidth = to_device(aWidth) / 2.0;
+		// every quad winds the same way whatever the direction of its line so overlapping segments do not cancel
+		auto add_dash = [&](double aStart, double aEnd)
+		{
+			float ax = static_cast<float>(from.x + ux * aStart);
+			float ay = static_cast<float>(from.y + uy * aStart);
+			float bx = static_cast<float>(from.x + ux * aEnd);
+			float by = static_cast<float>(from.y + uy * aEnd);
+			float nx = static_cast<float>(-uy * halfWidth);
+			float ny = static_cast<float>(ux * halfWidth);
+			aEdges.push_back(software_rasterizer::edge{ ax + nx, ay + ny, bx + nx, by + ny });
+			aEdges.push_back(software_rasterizer::edge{ bx + nx, by + ny, bx - nx, by - ny });
+			aEdges.push_back(software_rasterizer::edge{ bx - nx, by - ny, ax - nx, ay - ny });
+			aEdges.push_back(software_rasterizer::edge{ ax - nx, ay - ny, ax + nx, ay + ny });
+		};
+		if (iLineStipple == boost::none)
+		{
+			add_dash(0.0, length);
+			return;
+		}
+		// one pattern bit per aFactor pixels along the line, least significant bit first
+		double factor = static_cast<double>(std::max(iLineStipple->first, 1u));
+		uint32_t bit = 0;
+		for (double position = 0.0; position < length; position += factor, bit = (bit + 1) % 16)
+			if ((iLineStipple->second & (1u << bit)) != 0)
+				add_dash(position, std::min(position + factor, length));
+	}
+
+	void software_graphics_context::stroke(const std::vector<point>& aPoints, bool aClosed, dimension aWidth, const colour& aColour)
+	{
+		software_rasterizer::edge_list edges;
+		for (std::size_t i = 0; i + 1 < aPoints.size(); ++i)
+			add_stroke_edges(edges, aPoints[i], aPoints[i + 1], aWidth);
+		if (aClosed && aPoints.size() > 2)
+			add_stroke_edges(edges, aPoints.back(), aPoints.front(), aWidth);
+		iRasterizer.fill_polygon(render_state(analytic_anti_alias()), edges, software_rasterizer::NonZero, solid(aColour));
+		commit();
+	}
+
+	void software_graphics_context::fill_polygon(const std::vector<point>& aPolygon, const colour& aColour)
+	{
+		software_rasterizer::edge_list edges;
+		add_edges(edges, aPolygon);
+		iRasterizer.fill_polygon(render_state(analytic_anti_alias()), edges, software_rasterizer::NonZero, solid(aColour));
+		commit();
+	}
+
+	void software_graphics_context::draw_shape(const rect& aShape, dimension aRadius, dimension aOutlineWidth, const software_rasterizer::paint& aPaint)
+	{
+		auto area = to_device(aShape);
+		float halfWidth = (area.x1 - area.x0) / 2.0f;
+		float halfHeight = (area.y1 - area.y0) / 2.0f;
+		software_rasterizer::shape shape{ 
+			area.x0 + halfWidth, area.y0 + halfHeight, halfWidth, halfHeight, 
+			std::min(static_cast<float>(to_device(aRadius)), std::min(halfWidth, halfHeight)), static_cast<float>(to_device(aOutlineWidth)) };
+		iRasterizer.fill_shape(render_state(analytic_anti_alias()), shape, aPaint);
+		commit();
+	}
+
+	void software_graphics_context::draw_glyph_mask(const point& aPoint, const i_glyph_texture& aGlyphTexture, const font& aFont, const colour& aColour)
+	{
+		point glyphOrigin(aPoint.x + aGlyphTexture.placement().x, 
+			logical_coordinates()[1] < logical_coordinates()[3] ? 
+				aPoint.y + (aGlyphTexture.placement().y + -aFont.descender()) :
+				aPoint.y + aFont.height() - (aGlyphTexture.placement().y + -aFont.descender()) - aGlyphTexture.extents().cy);
+		// glyph bitmaps are upright on the screen whichever way the logical y axis runs
+		auto area = to_device(rect{ glyphOrigin, aGlyphTexture.extents() });
+		software_rasterizer::glyph_mask mask{ &aGlyphTexture.coverage(),
+			static_cast<int32_t>(std::floor(area.x0 + 0.5f)), static_cast<int32_t>(std::floor(area.y0 + 0.5f)),
+			static_cast<int32_t>(aGlyphTexture.extents().cx), static_cast<int32_t>(aGlyphTexture.extents().cy) };
+		iRasterizer.fill_glyph(render_state(true), mask, solid(aColour));
+	}
+
+	void software_graphics_context::draw_glyph_underline(const point& aPoint, const i_glyph_texture& aGlyphTexture, const font& aFont, const colour& aColour)
+	{
+		auto yLine = logical_coordinates()[1] > logical_coordinates()[3] ?
+			(aFont.height() + aFont.descender()) - std::ceil(aFont.native_font_face().underline_position()) :
+			-aFont.descender() + std::ceil(aFont.native_font_face().underline_position());
+		auto thickness = std::ceil(aFont.native_font_face().underline_thickness());
+		rect underline{ 
+			aPoint + point{ aGlyphTexture.placement().x, yLine + pixel_adjust(thickness) - thickness / 2.0 }, 
+			size{ aGlyphTexture.extents().cx, thickness } };
+		iRasterizer.fill_area(render_state(false), to_device(underline), solid(aColour));
+	}
+
+	void software_graphics_context::commit()
+	{
+		if (iRecording == 0 && !iDrawingGlyphs)
+			flush();
+	}
+}
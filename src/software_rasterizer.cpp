@@ -0,0 +1,709 @@
+// software_rasterizer.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "neogfx.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NEOGFX_SOFTWARE_RASTERIZER_SSE2
+#include <emmintrin.h>
+#endif
+#include "i_image.hpp"
+#include "i_native_texture.hpp"
+#include "software_rasterizer.hpp"
+
+namespace neogfx
+{
+	namespace
+	{
+		// Shades the tiles of a frame on worker threads shared by every rasterizer; the calling thread takes tiles too.
+		class tile_pool
+		{
+		public:
+			typedef std::function<void(std::size_t)> job;
+		public:
+			static tile_pool& instance()
+			{
+				static tile_pool sInstance;
+				return sInstance;
+			}
+		public:
+			void run(std::size_t aTileCount, const job& aJob)
+			{
+				if (iWorkers.empty() || aTileCount < 2)
+				{
+					for (std::size_t tile = 0; tile < aTileCount; ++tile)
+						aJob(tile);
+					return;
+				}
+				std::unique_lock<std::mutex> lock(iMutex);
+				iJob = &aJob;
+				iTileCount = aTileCount;
+				iNextTile = 0;
+				iBusy = iWorkers.size();
+				++iGeneration;
+				lock.unlock();
+				iWake.notify_all();
+				work();
+				lock.lock();
+				iDone.wait(lock, [this]() { return iBusy == 0; });
+				iJob = nullptr;
+			}
+		private:
+			tile_pool() : iJob(nullptr), iTileCount(0), iNextTile(0), iBusy(0), iGeneration(0), iStopping(false)
+			{
+				std::size_t threadCount = std::thread::hardware_concurrency();
+				for (std::size_t i = 1; i < threadCount; ++i)
+					iWorkers.emplace_back([this]() { worker(); });
+			}
+			~tile_pool()
+			{
+				{
+					std::lock_guard<std::mutex> lock(iMutex);
+					iStopping = true;
+				}
+				iWake.notify_all();
+				for (auto& w : iWorkers)
+					w.join();
+			}
+		private:
+			void worker()
+			{
+				uint64_t generation = 0;
+				for (;;)
+				{
+					{
+						std::unique_lock<std::mutex> lock(iMutex);
+						iWake.wait(lock, [this, generation]() { return iStopping || iGeneration != generation; });
+						if (iStopping)
+							return;
+						generation = iGeneration;
+					}
+					work();
+					{
+						std::lock_guard<std::mutex> lock(iMutex);
+						--iBusy;
+					}
+					iDone.notify_one();
+				}
+			}
+			void work()
+			{
+				for (std::size_t tile = iNextTile++; tile < iTileCount; tile = iNextTile++)
+					(*iJob)(tile);
+			}
+		private:
+			std::mutex iMutex;
+			std::condition_variable iWake;
+			std::condition_variable iDone;
+			std::vector<std::thread> iWorkers;
+			const job* iJob;
+			std::size_t iTileCount;
+			std::atomic<std::size_t> iNextTile;
+			std::size_t iBusy;
+			uint64_t iGeneration;
+			bool iStopping;
+		};
+
+		inline uint8_t multiply(uint8_t aLhs, uint8_t aRhs)
+		{
+			uint32_t t = static_cast<uint32_t>(aLhs) * aRhs + 128;
+			return static_cast<uint8_t>((t + (t >> 8)) >> 8);
+		}
+
+		inline uint8_t to_coverage(float aValue)
+		{
+			return static_cast<uint8_t>(std::min(std::max(aValue, 0.0f), 1.0f) * 255.0f + 0.5f);
+		}
+
+		inline float fill_coverage(float aArea, software_rasterizer::fill_rule_e aFillRule)
+		{
+			float a = std::abs(aArea);
+			if (aFillRule == software_rasterizer::NonZero)
+				return std::min(a, 1.0f);
+			a = std::fmod(a, 2.0f);
+			return a > 1.0f ? 2.0f - a : a;
+		}
+
+		// Signed area accumulation (as in Raph Levien's font-rs): a line adds the area it covers to the right of it
+		// within each pixel it crosses so a running sum along a row gives that row's coverage. aWidth is the width
+		// of the region; rows are aWidth + 2 long.
+		void accumulate_line(float* aAccumulation, float aWidth, int32_t aHeight, float aX0, float aY0, float aX1, float aY1)
+		{
+			if (aY0 == aY1)
+				return;
+			float direction = 1.0f;
+			if (aY0 > aY1)
+			{
+				std::swap(aX0, aX1);
+				std::swap(aY0, aY1);
+				direction = -1.0f;
+			}
+			std::size_t stride = static_cast<std::size_t>(aWidth) + 2;
+			float dxdy = (aX1 - aX0) / (aY1 - aY0);
+			float x = aX0;
+			if (aY0 < 0.0f)
+				x -= aY0 * dxdy;
+			int32_t yStart = aY0 < 0.0f ? 0 : static_cast<int32_t>(aY0);
+			int32_t yEnd = std::min(static_cast<int32_t>(std::ceil(aY1)), aHeight);
+			for (int32_t y = yStart; y < yEnd; ++y)
+			{
+				float* row = aAccumulation + y * stride;
+				float dy = std::min(static_cast<float>(y + 1), aY1) - std::max(static_cast<float>(y), aY0);
+				x = std::min(std::max(x, 0.0f), aWidth);
+				float xNext = std::min(std::max(x + dxdy * dy, 0.0f), aWidth);
+				float d = dy * direction;
+				float x0 = std::min(x, xNext);
+				float x1 = std::max(x, xNext);
+				float x0Floor = std::floor(x0);
+				int32_t x0i = static_cast<int32_t>(x0Floor);
+				float x1Ceil = std::ceil(x1);
+				int32_t x1i = static_cast<int32_t>(x1Ceil);
+				if (x1i <= x0i + 1)
+				{
+					float xmf = 0.5f * (x + xNext) - x0Floor;
+					row[x0i] += d - d * xmf;
+					row[x0i + 1] += d * xmf;
+				}
+				else
+				{
+					float s = 1.0f / (x1 - x0);
+					float x0f = x0 - x0Floor;
+					float a0 = 0.5f * s * (1.0f - x0f) * (1.0f - x0f);
+					float x1f = x1 - x1Ceil + 1.0f;
+					float am = 0.5f * s * x1f * x1f;
+					row[x0i] += d * a0;
+					if (x1i == x0i + 2)
+						row[x0i + 1] += d * (1.0f - a0 - am);
+					else
+					{
+						float a1 = s * (1.5f - x0f);
+						row[x0i + 1] += d * (a1 - a0);
+						for (int32_t xi = x0i + 2; xi < x1i - 1; ++xi)
+							row[xi] += d * s;
+						float a2 = a1 + (x1i - x0i - 3) * s;
+						row[x1i - 1] += d * (1.0f - a2 - am);
+					}
+					row[x1i] += d * am;
+				}
+				x = xNext;
+			}
+		}
+
+		// accumulates an edge into a region whose top left is at aOriginX, aOriginY; the edge is split where it crosses
+		// the region's sides and the parts outside are moved onto them, which leaves the coverage inside unchanged
+		void accumulate_edge(float* aAccumulation, int32_t aWidth, int32_t aHeight, float aOriginX, float aOriginY, const software_rasterizer::edge& aEdge)
+		{
+			float x0 = aEdge.x0 - aOriginX;
+			float y0 = aEdge.y0 - aOriginY;
+			float x1 = aEdge.x1 - aOriginX;
+			float y1 = aEdge.y1 - aOriginY;
+			float width = static_cast<float>(aWidth);
+			if (y0 == y1 || std::max(y0, y1) <= 0.0f || std::min(y0, y1) >= static_cast<float>(aHeight) || std::min(x0, x1) >= width)
+				return;
+			float splits[4] = { 0.0f };
+			std::size_t splitCount = 1;
+			if (x0 != x1)
+			{
+				float left = -x0 / (x1 - x0);
+				float right = (width - x0) / (x1 - x0);
+				if (left > 0.0f && left < 1.0f)
+					splits[splitCount++] = left;
+				if (right > 0.0f && right < 1.0f)
+					splits[splitCount++] = right;
+				if (splitCount == 3 && splits[1] > splits[2])
+					std::swap(splits[1], splits[2]);
+			}
+			splits[splitCount] = 1.0f;
+			for (std::size_t i = 0; i < splitCount; ++i)
+			{
+				float xa = x0 + (x1 - x0) * splits[i];
+				float ya = y0 + (y1 - y0) * splits[i];
+				float xb = x0 + (x1 - x0) * splits[i + 1];
+				float yb = y0 + (y1 - y0) * splits[i + 1];
+				accumulate_line(aAccumulation, width, aHeight, 
+					std::min(std::max(xa, 0.0f), width), ya, std::min(std::max(xb, 0.0f), width), yb);
+			}
+		}
+
+		software_rasterizer::device_rect edge_bounds(const software_rasterizer::edge* aFirst, const software_rasterizer::edge* aLast)
+		{
+			if (aFirst == aLast)
+				return software_rasterizer::device_rect{};
+			float x0 = std::min(aFirst->x0, aFirst->x1);
+			float y0 = std::min(aFirst->y0, aFirst->y1);
+			float x1 = std::max(aFirst->x0, aFirst->x1);
+			float y1 = std::max(aFirst->y0, aFirst->y1);
+			for (auto e = aFirst; e != aLast; ++e)
+			{
+				x0 = std::min(x0, std::min(e->x0, e->x1));
+				y0 = std::min(y0, std::min(e->y0, e->y1));
+				x1 = std::max(x1, std::max(e->x0, e->x1));
+				y1 = std::max(y1, std::max(e->y0, e->y1));
+			}
+			return software_rasterizer::device_rect{ 
+				static_cast<int32_t>(std::floor(x0)), static_cast<int32_t>(std::floor(y0)), 
+				static_cast<int32_t>(std::ceil(x1)), static_cast<int32_t>(std::ceil(y1)) };
+		}
+
+		// must match the signed distance function of the default fragment shader's shape mode
+		inline float shape_coverage(const software_rasterizer::shape& aShape, float aX, float aY)
+		{
+			float qx = std::abs(aX - aShape.cx) - aShape.halfWidth + aShape.radius;
+			float qy = std::abs(aY - aShape.cy) - aShape.halfHeight + aShape.radius;
+			float ox = std::max(qx, 0.0f);
+			float oy = std::max(qy, 0.0f);
+			float distance = std::min(std::max(qx, qy), 0.0f) + std::sqrt(ox * ox + oy * oy) - aShape.radius;
+			if (aShape.outline != 0.0f)
+				distance = std::abs(distance) - aShape.outline / 2.0f;
+			return 0.5f - distance;
+		}
+
+		// must match the default fragment shader's gradient mode
+		inline const software_rasterizer::rgba& gradient_colour(const software_rasterizer::gradient_paint& aGradient, float aX, float aY)
+		{
+			float px = (aX - aGradient.cx) / aGradient.halfWidth;
+			float py = (aY - aGradient.cy) / aGradient.halfHeight;
+			float t;
+			switch (aGradient.direction)
+			{
+			case gradient::Vertical:
+				t = (py + 1.0f) / 2.0f;
+				break;
+			case gradient::Horizontal:
+				t = (px + 1.0f) / 2.0f;
+				break;
+			case gradient::Diagonal:
+				t = (px + py + 2.0f) / 4.0f;
+				break;
+			case gradient::Radial:
+			default:
+				t = std::sqrt(px * px + py * py);
+				break;
+			}
+			t = std::min(std::max(t, 0.0f), 1.0f);
+			return aGradient.lookup[static_cast<std::size_t>(t * (software_rasterizer::GradientLookupSize - 1) + 0.5f)];
+		}
+
+		// bilinear filtering with texel centres at half texel coordinates, clamped to the texture's edges
+		inline software_rasterizer::rgba sample(const software_rasterizer::texture_paint& aTexture, float aS, float aT)
+		{
+			float x = aS - 0.5f;
+			float y = aT - 0.5f;
+			float xFloor = std::floor(x);
+			float yFloor = std::floor(y);
+			uint32_t fx = std::min(static_cast<uint32_t>((x - xFloor) * 256.0f), 255u);
+			uint32_t fy = std::min(static_cast<uint32_t>((y - yFloor) * 256.0f), 255u);
+			int32_t x0 = static_cast<int32_t>(xFloor);
+			int32_t y0 = static_cast<int32_t>(yFloor);
+			int32_t xa = std::min(std::max(x0, 0), aTexture.width - 1);
+			int32_t xb = std::min(std::max(x0 + 1, 0), aTexture.width - 1);
+			int32_t ya = std::min(std::max(y0, 0), aTexture.height - 1);
+			int32_t yb = std::min(std::max(y0 + 1, 0), aTexture.height - 1);
+			const uint8_t* p00 = aTexture.texels + (static_cast<std::size_t>(ya) * aTexture.width + xa) * 4;
+			const uint8_t* p10 = aTexture.texels + (static_cast<std::size_t>(ya) * aTexture.width + xb) * 4;
+			const uint8_t* p01 = aTexture.texels + (static_cast<std::size_t>(yb) * aTexture.width + xa) * 4;
+			const uint8_t* p11 = aTexture.texels + (static_cast<std::size_t>(yb) * aTexture.width + xb) * 4;
+			software_rasterizer::rgba result;
+			for (std::size_t c = 0; c < 4; ++c)
+			{
+				uint32_t top = p00[c] * (256 - fx) + p10[c] * fx;
+				uint32_t bottom = p01[c] * (256 - fx) + p11[c] * fx;
+				result[c] = static_cast<uint8_t>((top * (256 - fy) + bottom * fy + 32768) >> 16);
+			}
+			return result;
+		}
+
+#ifdef NEOGFX_SOFTWARE_RASTERIZER_SSE2
+		inline __m128i blend_channels(__m128i aSource, __m128i aDestination, __m128i aAlpha)
+		{
+			__m128i t = _mm_add_epi16(
+				_mm_add_epi16(_mm_mullo_epi16(aSource, aAlpha), _mm_mullo_epi16(aDestination, _mm_sub_epi16(_mm_set1_epi16(255), aAlpha))),
+				_mm_set1_epi16(128));
+			return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+		}
+#endif
+
+		// source over destination using the source alpha for every channel (the GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA
+		// blend the OpenGL contexts use); the SIMD and scalar paths produce identical results
+		void blend_span(uint8_t* aDestination, const software_rasterizer::rgba* aSource, int32_t aCount)
+		{
+			int32_t i = 0;
+#ifdef NEOGFX_SOFTWARE_RASTERIZER_SSE2
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i opaque = _mm_set1_epi32(255);
+			for (; i + 4 <= aCount; i += 4)
+			{
+				__m128i source = _mm_loadu_si128(reinterpret_cast<const __m128i*>(aSource + i));
+				__m128i alpha = _mm_srli_epi32(source, 24);
+				if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, zero)) == 0xFFFF)
+					continue;
+				__m128i* destination = reinterpret_cast<__m128i*>(aDestination + i * 4);
+				if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, opaque)) == 0xFFFF)
+				{
+					_mm_storeu_si128(destination, source);
+					continue;
+				}
+				alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 8));
+				alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 16));
+				__m128i target = _mm_loadu_si128(destination);
+				__m128i low = blend_channels(_mm_unpacklo_epi8(source, zero), _mm_unpacklo_epi8(target, zero), _mm_unpacklo_epi8(alpha, zero));
+				__m128i high = blend_channels(_mm_unpackhi_epi8(source, zero), _mm_unpackhi_epi8(target, zero), _mm_unpackhi_epi8(alpha, zero));
+				_mm_storeu_si128(destination, _mm_packus_epi16(low, high));
+			}
+#endif
+			for (; i < aCount; ++i)
+			{
+				const auto& source = aSource[i];
+				uint32_t alpha = source[3];
+				if (alpha == 0)
+					continue;
+				uint8_t* destination = aDestination + i * 4;
+				if (alpha == 255)
+				{
+					std::copy(source.begin(), source.end(), destination);
+					continue;
+				}
+				for (std::size_t c = 0; c < 4; ++c)
+				{
+					uint32_t t = source[c] * alpha + destination[c] * (255 - alpha) + 128;
+					destination[c] = static_cast<uint8_t>((t + (t >> 8)) >> 8);
+				}
+			}
+		}
+
+		void xor_span(uint8_t* aDestination, const software_rasterizer::rgba* aSource, const uint8_t* aCoverage, int32_t aCount)
+		{
+			for (int32_t i = 0; i < aCount; ++i)
+				if (aCoverage[i] >= 128)
+					for (std::size_t c = 0; c < 4; ++c)
+						aDestination[i * 4 + c] ^= aSource[i][c];
+		}
+	}
+
+	software_rasterizer::device_rect software_rasterizer::device_rect::intersection(const device_rect& aOther) const
+	{
+		return device_rect{ std::max(x0, aOther.x0), std::max(y0, aOther.y0), std::min(x1, aOther.x1), std::min(y1, aOther.y1) };
+	}
+
+	software_rasterizer::software_rasterizer()
+	{
+	}
+
+	bool software_rasterizer::empty() const
+	{
+		return iCommands.empty();
+	}
+
+	std::size_t software_rasterizer::size() const
+	{
+		return iCommands.size();
+	}
+
+	void software_rasterizer::fill_area(const state& aState, const area& aArea, const paint& aPaint)
+	{
+		command newCommand{};
+		newCommand.coverage = AreaCoverage;
+		newCommand.area = aArea;
+		if (!aState.antiAlias)
+		{
+			// without anti-aliasing a pixel is inside if its centre is
+			newCommand.area = area{ 
+				std::ceil(aArea.x0 - 0.5f), std::ceil(aArea.y0 - 0.5f), 
+				std::ceil(aArea.x1 - 0.5f), std::ceil(aArea.y1 - 0.5f) };
+		}
+		if (newCommand.area.x0 >= newCommand.area.x1 || newCommand.area.y0 >= newCommand.area.y1)
+			return;
+		newCommand.state = aState;
+		newCommand.paint = aPaint;
+		add(newCommand, device_rect{
+			static_cast<int32_t>(std::floor(newCommand.area.x0)), static_cast<int32_t>(std::floor(newCommand.area.y0)),
+			static_cast<int32_t>(std::ceil(newCommand.area.x1)), static_cast<int32_t>(std::ceil(newCommand.area.y1)) });
+	}
+
+	void software_rasterizer::fill_polygon(const state& aState, const edge_list& aEdges, fill_rule_e aFillRule, const paint& aPaint)
+	{
+		if (aEdges.empty())
+			return;
+		command newCommand{};
+		newCommand.coverage = PolygonCoverage;
+		newCommand.state = aState;
+		newCommand.paint = aPaint;
+		newCommand.fillRule = aFillRule;
+		newCommand.firstEdge = iEdges.size();
+		newCommand.edgeCount = aEdges.size();
+		std::size_t previousCommandCount = iCommands.size();
+		add(newCommand, edge_bounds(&aEdges[0], &aEdges[0] + aEdges.size()));
+		if (iCommands.size() != previousCommandCount)
+			iEdges.insert(iEdges.end(), aEdges.begin(), aEdges.end());
+	}
+
+	void software_rasterizer::fill_shape(const state& aState, const shape& aShape, const paint& aPaint)
+	{
+		if (aShape.halfWidth <= 0.0f || aShape.halfHeight <= 0.0f)
+			return;
+		command newCommand{};
+		newCommand.coverage = ShapeCoverage;
+		newCommand.state = aState;
+		newCommand.paint = aPaint;
+		newCommand.shape = aShape;
+		float marginX = aShape.halfWidth + aShape.outline / 2.0f + 1.0f;
+		float marginY = aShape.halfHeight + aShape.outline / 2.0f + 1.0f;
+		add(newCommand, device_rect{
+			static_cast<int32_t>(std::floor(aShape.cx - marginX)), static_cast<int32_t>(std::floor(aShape.cy - marginY)),
+			static_cast<int32_t>(std::ceil(aShape.cx + marginX)), static_cast<int32_t>(std::ceil(aShape.cy + marginY)) });
+	}
+
+	void software_rasterizer::fill_glyph(const state& aState, const glyph_mask& aGlyph, const paint& aPaint)
+	{
+		if (aGlyph.cx <= 0 || aGlyph.cy <= 0 || aGlyph.coverage->size() < static_cast<std::size_t>(aGlyph.cx * aGlyph.cy))
+			return;
+		command newCommand{};
+		newCommand.coverage = GlyphCoverage;
+		newCommand.state = aState;
+		newCommand.paint = aPaint;
+		newCommand.glyph = aGlyph;
+		add(newCommand, device_rect{ aGlyph.x, aGlyph.y, aGlyph.x + aGlyph.cx, aGlyph.y + aGlyph.cy });
+	}
+
+	void software_rasterizer::execute(i_image& aTarget)
+	{
+		if (aTarget.colour_format() != ColourFormatRGBA8)
+			throw unsupported_colour_format();
+		int32_t width = static_cast<int32_t>(aTarget.extents().cx);
+		int32_t height = static_cast<int32_t>(aTarget.extents().cy);
+		if (iCommands.empty() || width <= 0 || height <= 0)
+		{
+			clear();
+			return;
+		}
+		int32_t tilesAcross = (width + TileSize - 1) / TileSize;
+		int32_t tilesDown = (height + TileSize - 1) / TileSize;
+		iBins.resize(static_cast<std::size_t>(tilesAcross * tilesDown));
+		for (auto& bin : iBins)
+			bin.clear();
+		device_rect target{ 0, 0, width, height };
+		std::size_t pixelCount = 0;
+		for (uint32_t i = 0; i < iCommands.size(); ++i)
+		{
+			auto bounds = iCommands[i].bounds.intersection(target);
+			if (bounds.empty())
+				continue;
+			pixelCount += static_cast<std::size_t>(bounds.x1 - bounds.x0) * (bounds.y1 - bounds.y0);
+			for (int32_t ty = bounds.y0 / TileSize; ty <= (bounds.y1 - 1) / TileSize; ++ty)
+				for (int32_t tx = bounds.x0 / TileSize; tx <= (bounds.x1 - 1) / TileSize; ++tx)
+					iBins[ty * tilesAcross + tx].push_back(i);
+		}
+		uint8_t* pixels = static_cast<uint8_t*>(aTarget.data());
+		auto job = [this, pixels, width, height](std::size_t aTile) { execute_tile(aTile, pixels, width, height); };
+		// waking the workers costs more than shading a few small commands
+		if (pixelCount < static_cast<std::size_t>(TileSize * TileSize * 4))
+		{
+			for (std::size_t tile = 0; tile < iBins.size(); ++tile)
+				job(tile);
+		}
+		else
+			tile_pool::instance().run(iBins.size(), job);
+		clear();
+	}
+
+	void software_rasterizer::clear()
+	{
+		iCommands.clear();
+		iEdges.clear();
+	}
+
+	software_rasterizer::mask_pointer software_rasterizer::rasterize_mask(const edge_list& aEdges, fill_rule_e aFillRule, bool aAntiAlias, const device_rect& aBounds, const mask_pointer& aEnclosingMask)
+	{
+		auto result = std::make_shared<coverage_mask>();
+		device_rect bounds = aEdges.empty() ? device_rect{} : edge_bounds(&aEdges[0], &aEdges[0] + aEdges.size()).intersection(aBounds);
+		if (aEnclosingMask != nullptr)
+			bounds = bounds.intersection(aEnclosingMask->bounds);
+		if (bounds.empty())
+		{
+			result->bounds = device_rect{};
+			return result;
+		}
+		result->bounds = bounds;
+		int32_t width = bounds.x1 - bounds.x0;
+		int32_t height = bounds.y1 - bounds.y0;
+		std::vector<float> accumulation(static_cast<std::size_t>(width + 2) * height);
+		for (const auto& e : aEdges)
+			accumulate_edge(&accumulation[0], width, height, static_cast<float>(bounds.x0), static_cast<float>(bounds.y0), e);
+		result->coverage.resize(static_cast<std::size_t>(width) * height);
+		for (int32_t y = 0; y < height; ++y)
+		{
+			const float* row = &accumulation[static_cast<std::size_t>(y) * (width + 2)];
+			uint8_t* coverage = &result->coverage[static_cast<std::size_t>(y) * width];
+			float sum = 0.0f;
+			for (int32_t x = 0; x < width; ++x)
+			{
+				sum += row[x];
+				coverage[x] = to_coverage(fill_coverage(sum, aFillRule));
+				if (!aAntiAlias)
+					coverage[x] = coverage[x] >= 128 ? 255 : 0;
+			}
+			if (aEnclosingMask != nullptr)
+			{
+				const auto& enclosing = *aEnclosingMask;
+				const uint8_t* enclosingCoverage = &enclosing.coverage[
+					static_cast<std::size_t>(bounds.y0 + y - enclosing.bounds.y0) * (enclosing.bounds.x1 - enclosing.bounds.x0) + (bounds.x0 - enclosing.bounds.x0)];
+				for (int32_t x = 0; x < width; ++x)
+					coverage[x] = multiply(coverage[x], enclosingCoverage[x]);
+			}
+		}
+		return result;
+	}
+
+	void software_rasterizer::add(command& aCommand, const device_rect& aBounds)
+	{
+		aCommand.bounds = aBounds.intersection(aCommand.state.scissor);
+		if (aCommand.state.clip != nullptr)
+			aCommand.bounds = aCommand.bounds.intersection(aCommand.state.clip->bounds);
+		if (aCommand.bounds.empty())
+			return;
+		iCommands.push_back(aCommand);
+	}
+
+	void software_rasterizer::execute_tile(std::size_t aTile, uint8_t* aPixels, int32_t aWidth, int32_t aHeight) const
+	{
+		int32_t tilesAcross = (aWidth + TileSize - 1) / TileSize;
+		int32_t x = static_cast<int32_t>(aTile % tilesAcross) * TileSize;
+		int32_t y = static_cast<int32_t>(aTile / tilesAcross) * TileSize;
+		device_rect tile{ x, y, std::min(x + TileSize, aWidth), std::min(y + TileSize, aHeight) };
+		for (auto c : iBins[aTile])
+		{
+			auto region = iCommands[c].bounds.intersection(tile);
+			if (!region.empty())
+				execute_command(iCommands[c], region, aPixels, aWidth);
+		}
+	}
+
+	void software_rasterizer::execute_command(const command& aCommand, const device_rect& aRegion, uint8_t* aPixels, int32_t aWidth) const
+	{
+		thread_local std::vector<float> tAccumulation;
+		thread_local std::vector<uint8_t> tCoverage;
+		thread_local std::vector<rgba> tSpan;
+		int32_t width = aRegion.x1 - aRegion.x0;
+		int32_t height = aRegion.y1 - aRegion.y0;
+		tCoverage.resize(static_cast<std::size_t>(width));
+		tSpan.resize(static_cast<std::size_t>(width));
+		if (aCommand.coverage == PolygonCoverage)
+		{
+			tAccumulation.assign(static_cast<std::size_t>(width + 2) * height, 0.0f);
+			for (auto e = iEdges.begin() + aCommand.firstEdge; e != iEdges.begin() + aCommand.firstEdge + aCommand.edgeCount; ++e)
+				accumulate_edge(&tAccumulation[0], width, height, static_cast<float>(aRegion.x0), static_cast<float>(aRegion.y0), *e);
+		}
+		const coverage_mask* clip = aCommand.state.clip.get();
+		const auto& paint = aCommand.paint;
+		uint8_t* coverage = &tCoverage[0];
+		rgba* span = &tSpan[0];
+		for (int32_t y = aRegion.y0; y < aRegion.y1; ++y)
+		{
+			float centreY = y + 0.5f;
+			switch (aCommand.coverage)
+			{
+			case AreaCoverage:
+				{
+					const auto& area = aCommand.area;
+					float coverageY = std::min(y + 1.0f, area.y1) - std::max(static_cast<float>(y), area.y0);
+					for (int32_t x = aRegion.x0; x < aRegion.x1; ++x)
+					{
+						float coverageX = std::min(x + 1.0f, area.x1) - std::max(static_cast<float>(x), area.x0);
+						coverage[x - aRegion.x0] = to_coverage(std::min(std::max(coverageX, 0.0f), 1.0f) * coverageY);
+					}
+				}
+				break;
+			case PolygonCoverage:
+				{
+					const float* row = &tAccumulation[static_cast<std::size_t>(y - aRegion.y0) * (width + 2)];
+					float sum = 0.0f;
+					for (int32_t x = 0; x < width; ++x)
+					{
+						sum += row[x];
+						coverage[x] = to_coverage(fill_coverage(sum, aCommand.fillRule));
+					}
+				}
+				break;
+			case ShapeCoverage:
+				for (int32_t x = aRegion.x0; x < aRegion.x1; ++x)
+					coverage[x - aRegion.x0] = to_coverage(shape_coverage(aCommand.shape, x + 0.5f, centreY));
+				break;
+			case GlyphCoverage:
+				{
+					const auto& glyph = aCommand.glyph;
+					const uint8_t* row = &(*glyph.coverage)[static_cast<std::size_t>(y - glyph.y) * glyph.cx + (aRegion.x0 - glyph.x)];
+					std::copy(row, row + width, coverage);
+				}
+				break;
+			}
+			if (!aCommand.state.antiAlias)
+				for (int32_t x = 0; x < width; ++x)
+					coverage[x] = coverage[x] >= 128 ? 255 : 0;
+			if (clip != nullptr)
+			{
+				const uint8_t* mask = &clip->coverage[
+					static_cast<std::size_t>(y - clip->bounds.y0) * (clip->bounds.x1 - clip->bounds.x0) + (aRegion.x0 - clip->bounds.x0)];
+				for (int32_t x = 0; x < width; ++x)
+					coverage[x] = multiply(coverage[x], mask[x]);
+			}
+			if (paint.gradient != nullptr)
+			{
+				for (int32_t x = aRegion.x0; x < aRegion.x1; ++x)
+					span[x - aRegion.x0] = gradient_colour(*paint.gradient, x + 0.5f, centreY);
+			}
+			else if (paint.texture != nullptr)
+			{
+				const auto& texture = *paint.texture;
+				float s = texture.s0 + texture.dsdx * (aRegion.x0 + 0.5f) + texture.dsdy * centreY;
+				float t = texture.t0 + texture.dtdx * (aRegion.x0 + 0.5f) + texture.dtdy * centreY;
+				for (int32_t x = 0; x < width; ++x, s += texture.dsdx, t += texture.dtdx)
+				{
+					if (coverage[x] == 0)
+						continue;
+					rgba texel = sample(texture, s, t);
+					rgba& result = span[x];
+					for (std::size_t c = 0; c < 4; ++c)
+						result[c] = multiply(texel[c], paint.colour[c]);
+					if (texture.monochrome)
+					{
+						uint8_t grey = static_cast<uint8_t>((result[0] * 77 + result[1] * 150 + result[2] * 29 + 128) >> 8);
+						result[0] = result[1] = result[2] = grey;
+					}
+				}
+			}
+			else
+				std::fill(span, span + width, paint.colour);
+			uint8_t* destination = aPixels + (static_cast<std::size_t>(y) * aWidth + aRegion.x0) * 4;
+			if (aCommand.state.blend == Xor)
+				xor_span(destination, span, coverage, width);
+			else
+			{
+				for (int32_t x = 0; x < width; ++x)
+					span[x][3] = multiply(span[x][3], coverage[x]);
+				blend_span(destination, span, width);
+			}
+		}
+	}
+}
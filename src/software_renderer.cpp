@@ -0,0 +1,192 @@
+// software_renderer.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "neogfx.hpp"
+#include <thread>
+#include <neolib/raii.hpp>
+#include "app.hpp"
+#include "surface_manager.hpp"
+#include "software_window.hpp"
+#include "software_renderer.hpp"
+
+namespace neogfx
+{
+	dimension software_renderer::screen_metrics::horizontal_dpi() const
+	{
+		return 96.0;
+	}
+
+	dimension software_renderer::screen_metrics::vertical_dpi() const
+	{
+		return 96.0;
+	}
+
+	size software_renderer::screen_metrics::extents() const
+	{
+		throw unsupported_function();
+	}
+
+	dimension software_renderer::screen_metrics::em_size() const
+	{
+		throw unsupported_function();
+	}
+
+	i_screen_metrics::subpixel_format_e software_renderer::screen_metrics::subpixel_format() const
+	{
+		// glyphs are blended using a single coverage value per pixel
+		return SubpixelFormatUnknown;
+	}
+
+	software_renderer::software_renderer(i_basic_services& aBasicServices, i_keyboard& aKeyboard) :
+		iBasicServices(aBasicServices), iKeyboard(aKeyboard), iFontManager(*this, iScreenMetrics), iCreatingWindow(0), iStatistics{}
+	{
+	}
+
+	software_renderer::~software_renderer()
+	{
+	}
+
+	void software_renderer::initialize()
+	{
+	}
+
+	void* software_renderer::create_context(i_native_surface& aSurface)
+	{
+		// nothing to create: the surface's back buffer is all there is
+		return &aSurface;
+	}
+
+	void software_renderer::destroy_context(i_native_surface&)
+	{
+	}
+
+	const i_screen_metrics& software_renderer::screen_metrics() const
+	{
+		return iScreenMetrics;
+	}
+
+	std::unique_ptr<i_native_window> software_renderer::create_window(i_surface_manager& aSurfaceManager, i_native_window_event_handler& aEventHandler, const video_mode& aVideoMode, const std::string&, window::style_e aStyle)
+	{
+		neolib::scoped_counter sc(iCreatingWindow);
+		return std::unique_ptr<i_native_window>(new software_window(*this, aSurfaceManager, aEventHandler, point{}, size{ static_cast<dimension>(aVideoMode.width()), static_cast<dimension>(aVideoMode.height()) }, aStyle));
+	}
+
+	std::unique_ptr<i_native_window> software_renderer::create_window(i_surface_manager& aSurfaceManager, i_native_window_event_handler& aEventHandler, const size& aDimensions, const std::string&, window::style_e aStyle)
+	{
+		neolib::scoped_counter sc(iCreatingWindow);
+		return std::unique_ptr<i_native_window>(new software_window(*this, aSurfaceManager, aEventHandler, point{}, aDimensions, aStyle));
+	}
+
+	std::unique_ptr<i_native_window> software_renderer::create_window(i_surface_manager& aSurfaceManager, i_native_window_event_handler& aEventHandler, const point& aPosition, const size& aDimensions, const std::string&, window::style_e aStyle)
+	{
+		neolib::scoped_counter sc(iCreatingWindow);
+		return std::unique_ptr<i_native_window>(new software_window(*this, aSurfaceManager, aEventHandler, aPosition, aDimensions, aStyle));
+	}
+
+	std::unique_ptr<i_native_window> software_renderer::create_window(i_surface_manager& aSurfaceManager, i_native_window_event_handler& aEventHandler, i_native_surface&, const video_mode& aVideoMode, const std::string& aWindowTitle, window::style_e aStyle)
+	{
+		return create_window(aSurfaceManager, aEventHandler, aVideoMode, aWindowTitle, aStyle);
+	}
+
+	std::unique_ptr<i_native_window> software_renderer::create_window(i_surface_manager& aSurfaceManager, i_native_window_event_handler& aEventHandler, i_native_surface&, const size& aDimensions, const std::string& aWindowTitle, window::style_e aStyle)
+	{
+		return create_window(aSurfaceManager, aEventHandler, aDimensions, aWindowTitle, aStyle);
+	}
+
+	std::unique_ptr<i_native_window> software_renderer::create_window(i_surface_manager& aSurfaceManager, i_native_window_event_handler& aEventHandler, i_native_surface&, const point& aPosition, const size& aDimensions, const std::string& aWindowTitle, window::style_e aStyle)
+	{
+		return create_window(aSurfaceManager, aEventHandler, aPosition, aDimensions, aWindowTitle, aStyle);
+	}
+
+	bool software_renderer::creating_window() const
+	{
+		return iCreatingWindow != 0;
+	}
+
+	i_font_manager& software_renderer::font_manager()
+	{
+		return iFontManager;
+	}
+
+	i_texture_manager& software_renderer::texture_manager()
+	{
+		return iTextureManager;
+	}
+
+	void software_renderer::activate_shader_program(i_shader_program&)
+	{
+		throw shaders_not_supported();
+	}
+
+	void software_renderer::deactivate_shader_program()
+	{
+		throw shaders_not_supported();
+	}
+
+	const i_rendering_engine::i_shader_program& software_renderer::active_shader_program() const
+	{
+		throw no_shader_program_active();
+	}
+
+	i_rendering_engine::i_shader_program& software_renderer::active_shader_program()
+	{
+		throw no_shader_program_active();
+	}
+
+	const i_rendering_engine::i_shader_program& software_renderer::default_shader_program() const
+	{
+		throw shaders_not_supported();
+	}
+
+	i_rendering_engine::i_shader_program& software_renderer::default_shader_program()
+	{
+		throw shaders_not_supported();
+	}
+
+	void software_renderer::render_now()
+	{
+		app::instance().surface_manager().render_surfaces();
+	}
+
+	const rendering_statistics& software_renderer::statistics() const
+	{
+		return iStatistics;
+	}
+
+	bool software_renderer::process_events()
+	{
+		return false;
+	}
+
+	void software_renderer::wait_for_events(frame_scheduler::duration aTimeout)
+	{
+		// there is no event source when headless so there is nothing to wake us early
+		std::this_thread::sleep_for(aTimeout);
+	}
+
+	neogfx::tessellation_cache& software_renderer::tessellation_cache()
+	{
+		return iTessellationCache;
+	}
+
+	void software_renderer::frame_rendered(const rendering_statistics& aStatistics)
+	{
+		iStatistics = aStatistics;
+	}
+}
@@ -0,0 +1,146 @@
+// software_texture.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "neogfx.hpp"
+#include <cmath>
+#include "software_texture.hpp"
+
+namespace neogfx
+{
+	software_texture::software_texture(const size& aExtents) :
+		iSize(aExtents),
+		iStorageSize{ iSize.cx + 2, iSize.cy + 2 },
+		iData(iStorageSize.cx * 4 * iStorageSize.cy)
+	{
+	}
+
+	software_texture::software_texture(const i_image& aImage) :
+		iSize(aImage.extents()),
+		iStorageSize{ iSize.cx + 2, iSize.cy + 2 },
+		iUri(aImage.uri()),
+		iData(iStorageSize.cx * 4 * iStorageSize.cy)
+	{
+		// same layout as an OpenGL texture: a one texel border around the image
+		switch (aImage.colour_format())
+		{
+		case ColourFormatRGBA8:
+			{
+				const uint8_t* imageData = static_cast<const uint8_t*>(aImage.data());
+				for (std::size_t y = 1; y < 1 + iSize.cy; ++y)
+					std::copy(imageData + (y - 1) * iSize.cx * 4, imageData + y * iSize.cx * 4, &iData[(y * iStorageSize.cx + 1) * 4]);
+			}
+			break;
+		default:
+			throw unsupported_colour_format();
+			break;
+		}
+	}
+
+	software_texture::~software_texture()
+	{
+	}
+
+	size software_texture::extents() const
+	{
+		return iSize;
+	}
+
+	size software_texture::storage_extents() const
+	{
+		return iStorageSize;
+	}
+
+	void* software_texture::handle() const
+	{
+		return const_cast<software_texture*>(this);
+	}
+
+	bool software_texture::is_resident() const
+	{
+		return true;
+	}
+
+	bool software_texture::is_evictable() const
+	{
+		return false;
+	}
+
+	std::size_t software_texture::memory_size() const
+	{
+		return iData.size();
+	}
+
+	void software_texture::make_resident()
+	{
+	}
+
+	void software_texture::evict()
+	{
+	}
+
+	const std::string& software_texture::uri() const
+	{
+		return iUri;
+	}
+
+	const void* software_texture::data() const
+	{
+		return &iData[0];
+	}
+
+	void software_texture::update(const rect& aRect, const void* aPixels)
+	{
+		std::size_t x = static_cast<std::size_t>(aRect.x);
+		std::size_t y = static_cast<std::size_t>(aRect.y);
+		std::size_t cx = static_cast<std::size_t>(aRect.cx);
+		std::size_t cy = static_cast<std::size_t>(aRect.cy);
+		std::size_t storageWidth = static_cast<std::size_t>(iStorageSize.cx);
+		const uint8_t* pixels = static_cast<const uint8_t*>(aPixels);
+		for (std::size_t row = 0; row < cy; ++row)
+			std::copy(pixels + row * cx * 4, pixels + (row + 1) * cx * 4, &iData[((y + row) * storageWidth + x) * 4]);
+	}
+
+	software_font_texture::software_font_texture(const size& aExtents, bool aSubPixelRendering) :
+		iExtents(aExtents), iSubPixelRendering(aSubPixelRendering), iBinPack(aExtents, false)
+	{
+	}
+
+	software_font_texture::~software_font_texture()
+	{
+	}
+
+	const size& software_font_texture::extents() const
+	{
+		return iExtents;
+	}
+
+	bool software_font_texture::allocate_glyph_space(const size& aSize, rect& aResult)
+	{
+		return iBinPack.insert(size(std::max(std::pow(2.0, std::ceil(std::log2(aSize.cx + (iSubPixelRendering ? 6 : 2)))), 16.0), std::max(std::pow(2.0, std::ceil(std::log2(aSize.cy + 2))), 16.0)), aResult);
+	}
+
+	void* software_font_texture::handle() const
+	{
+		return const_cast<software_font_texture*>(this);
+	}
+
+	void software_font_texture::update(const rect&, const void*)
+	{
+	}
+}
@@ -0,0 +1,43 @@
+// software_texture_manager.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "neogfx.hpp"
+#include "software_texture_manager.hpp"
+#include "software_texture.hpp"
+
+namespace neogfx
+{
+	std::unique_ptr<i_native_texture> software_texture_manager::create_texture(const size& aExtents)
+	{
+		return add_texture(std::make_shared<software_texture>(aExtents));
+	}
+
+	std::unique_ptr<i_native_texture> software_texture_manager::create_texture(const i_image& aImage)
+	{
+		auto existing = find_texture(aImage);
+		if (existing != textures().end())
+			return join_texture(*existing->lock());
+		return add_texture(std::make_shared<software_texture>(aImage));
+	}
+
+	std::unique_ptr<i_font_texture> software_texture_manager::create_font_texture(const size& aExtents, bool aSubPixelRendering)
+	{
+		return std::make_unique<software_font_texture>(aExtents, aSubPixelRendering);
+	}
+}
@@ -0,0 +1,352 @@
+// software_window.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "neogfx.hpp"
+#include <algorithm>
+#include "software_graphics_context.hpp"
+#include "software_window.hpp"
+#include "profiler.hpp"
+
+namespace neogfx
+{
+	software_window::software_window(software_renderer& aRenderingEngine, i_surface_manager& aSurfaceManager, i_native_window_event_handler& aEventHandler, const point& aPosition, const size& aDimensions, window::style_e aStyle) :
+		native_window(aRenderingEngine, aSurfaceManager),
+		iRenderingEngine(aRenderingEngine),
+		iEventHandler(aEventHandler),
+		iLogicalCoordinateSystem(neogfx::logical_coordinate_system::AutomaticGui),
+		iPosition(aPosition),
+		iExtents(aDimensions),
+		iVisible(false),
+		iActive(false),
+		iDestroyed(false),
+		iFrameCounter(0),
+		iFrameScheduler(neogfx::frame_pacing::OnDemand, 60),
+		iRendering(false)
+	{
+		if ((aStyle & window::InitiallyHidden) != window::InitiallyHidden)
+			show((aStyle & window::NoActivate) != window::NoActivate);
+	}
+
+	software_window::~software_window()
+	{
+		close();
+	}
+
+	neogfx::logical_coordinate_system software_window::logical_coordinate_system() const
+	{
+		return iLogicalCoordinateSystem;
+	}
+
+	void software_window::set_logical_coordinate_system(neogfx::logical_coordinate_system aSystem)
+	{
+		iLogicalCoordinateSystem = aSystem;
+	}
+
+	const vector4& software_window::logical_coordinates() const
+	{
+		switch (iLogicalCoordinateSystem)
+		{
+		case neogfx::logical_coordinate_system::Specified:
+			return iLogicalCoordinates;
+		case neogfx::logical_coordinate_system::AutomaticGui:
+			return iLogicalCoordinates = vector4{ 0.0, extents().cy, extents().cx, 0.0 };
+		case neogfx::logical_coordinate_system::AutomaticGame:
+			return iLogicalCoordinates = vector4{ 0.0, 0.0, extents().cx, extents().cy };
+		}
+		return iLogicalCoordinates;
+	}
+
+	void software_window::set_logical_coordinates(const vector4& aCoordinates)
+	{
+		iLogicalCoordinates = aCoordinates;
+	}
+
+	void* software_window::handle() const
+	{
+		return const_cast<software_window*>(this);
+	}
+
+	void* software_window::native_handle() const
+	{
+		return const_cast<software_window*>(this);
+	}
+
+	void* software_window::native_context() const
+	{
+		return nullptr;
+	}
+
+	point software_window::surface_position() const
+	{
+		return iPosition;
+	}
+
+	void software_window::move_surface(const point& aPosition)
+	{
+		iPosition = aPosition;
+	}
+
+	size software_window::surface_size() const
+	{
+		return iExtents;
+	}
+
+	void software_window::resize_surface(const size& aSize)
+	{
+		iExtents = aSize;
+	}
+
+	point software_window::mouse_position() const
+	{
+		return point{};
+	}
+
+	bool software_window::is_mouse_button_pressed(mouse_button) const
+	{
+		return false;
+	}
+
+	void software_window::save_mouse_cursor()
+	{
+	}
+
+	void software_window::set_mouse_cursor(mouse_system_cursor)
+	{
+	}
+
+	void software_window::restore_mouse_cursor()
+	{
+	}
+
+	uint64_t software_window::frame_counter() const
+	{
+		return iFrameCounter;
+	}
+
+	bool software_window::using_frame_buffer() const
+	{
+		// the back buffer keeps its contents between frames
+		return true;
+	}
+
+	void software_window::limit_frame_rate(uint32_t aFps)
+	{
+		iFrameScheduler.set_frame_rate(aFps);
+	}
+
+	neogfx::frame_pacing software_window::frame_pacing() const
+	{
+		return iFrameScheduler.frame_pacing();
+	}
+
+	void software_window::set_frame_pacing(neogfx::frame_pacing aPacing)
+	{
+		iFrameScheduler.set_frame_pacing(aPacing);
+	}
+
+	neogfx::frame_statistics software_window::frame_statistics() const
+	{
+		return iFrameScheduler.frame_statistics();
+	}
+
+	boost::optional<frame_scheduler::time_point> software_window::next_frame_time() const
+	{
+		if (iFrameScheduler.frame_pacing() == neogfx::frame_pacing::OnDemand && iInvalidatedRegion.empty())
+			return boost::none;
+		return iFrameScheduler.next_frame_time();
+	}
+
+	bool software_window::threaded_presentation() const
+	{
+		return false;
+	}
+
+	void software_window::set_threaded_presentation(bool)
+	{
+		// nothing is presented so there is nothing to hand over to another thread
+	}
+
+	void software_window::invalidate(const rect& aInvalidatedRect)
+	{
+		iInvalidatedRegion.combine(aInvalidatedRect);
+	}
+
+	void software_window::render()
+	{
+		if (iRendering || iDestroyed)
+			return;
+
+		auto now = frame_scheduler::clock::now();
+		if (!iFrameScheduler.frame_due(now))
+			return;
+
+		if (!iEventHandler.native_window_ready_to_render())
+			return;
+
+		rendering_check.trigger();
+
+		if (iBackBuffer.extents() != extents())
+		{
+			iBackBuffer.resize(extents());
+			invalidate(rect{ point{}, extents() });
+		}
+
+		iInvalidatedRegion.intersect(rect{ point{}, surface_size() });
+		if (iInvalidatedRegion.empty())
+		{
+			iFrameScheduler.frame_skipped(now);
+			return;
+		}
+
+		++iFrameCounter;
+
+		profiler::scope ps(profiler::Frame);
+
+		iRendering = true;
+		iFrameScheduler.frame_started(now);
+
+		rendering.trigger();
+
+		rect invalidatedRect = iInvalidatedRegion.bounding_rect();
+		iInvalidatedRegion.clear();
+
+		iEventHandler.native_window_render(invalidatedRect);
+		rendering_engine().texture_manager().end_frame();
+
+		rendering_statistics statistics = {};
+		statistics.frame = iFrameCounter;
+		iRenderingEngine.frame_rendered(statistics);
+
+		auto finished = frame_scheduler::clock::now();
+		iFrameScheduler.frame_presented(finished, finished);
+
+		iRendering = false;
+
+		rendering_finished.trigger();
+	}
+
+	bool software_window::is_rendering() const
+	{
+		return iRendering;
+	}
+
+	void software_window::read_pixels(i_image& aImage) const
+	{
+		if (aImage.colour_format() != ColourFormatRGBA8)
+			throw unsupported_colour_format();
+		aImage.resize(extents());
+		if (iBackBuffer.extents() != aImage.extents() || aImage.size() == 0)
+			return;
+		const uint8_t* pixels = static_cast<const uint8_t*>(iBackBuffer.data());
+		std::copy(pixels, pixels + iBackBuffer.size(), static_cast<uint8_t*>(aImage.data()));
+	}
+
+	std::unique_ptr<i_native_graphics_context> software_window::create_graphics_context() const
+	{
+		return std::unique_ptr<i_native_graphics_context>(new software_graphics_context(rendering_engine(), *this));
+	}
+
+	std::unique_ptr<i_native_graphics_context> software_window::create_graphics_context(const i_widget& aWidget) const
+	{
+		return std::unique_ptr<i_native_graphics_context>(new software_graphics_context(rendering_engine(), *this, aWidget));
+	}
+
+	void software_window::activate_context() const
+	{
+	}
+
+	void software_window::deactivate_context() const
+	{
+	}
+
+	size software_window::extents() const
+	{
+		return surface_size();
+	}
+
+	dimension software_window::horizontal_dpi() const
+	{
+		return iRenderingEngine.screen_metrics().horizontal_dpi();
+	}
+
+	dimension software_window::vertical_dpi() const
+	{
+		return iRenderingEngine.screen_metrics().vertical_dpi();
+	}
+
+	dimension software_window::em_size() const
+	{
+		return 0;
+	}
+
+	void software_window::close()
+	{
+		if (!iDestroyed)
+		{
+			iEventHandler.native_window_closing();
+			iDestroyed = true;
+			iEventHandler.native_window_closed();
+		}
+	}
+
+	void software_window::show(bool aActivate)
+	{
+		iVisible = true;
+		if (aActivate)
+			activate();
+	}
+
+	void software_window::hide()
+	{
+		iVisible = false;
+		iActive = false;
+	}
+
+	bool software_window::is_active() const
+	{
+		return iActive;
+	}
+
+	void software_window::activate()
+	{
+		iActive = true;
+	}
+
+	void software_window::enable(bool)
+	{
+	}
+
+	void software_window::set_capture()
+	{
+	}
+
+	void software_window::release_capture()
+	{
+	}
+
+	bool software_window::is_destroyed() const
+	{
+		return iDestroyed;
+	}
+
+	i_image& software_window::back_buffer() const
+	{
+		return iBackBuffer;
+	}
+}
@@ -26,35 +26,40 @@
 namespace neogfx
 {
 	sprite_plane::sprite_plane() : 
+		iPacedSurface(nullptr),
+		iPreviousPacing(frame_pacing::OnDemand),
 		iEnableZSorting(false),
 		iG(6.67408e-11)
 	{
 	}
 
 	sprite_plane::sprite_plane(i_widget& aParent) :
-		widget(aParent), iEnableZSorting(false), iG(6.67408e-11)
+		widget(aParent), iPacedSurface(nullptr), iPreviousPacing(frame_pacing::OnDemand), iEnableZSorting(false), iG(6.67408e-11)
 	{
 		surface().native_surface().rendering_check([this]()
 		{
 			if (update_objects())
 				update();
 		}, this);
+		request_continuous_pacing();
 	}
 
 	sprite_plane::sprite_plane(i_layout& aLayout) :
-		widget(aLayout), iEnableZSorting(false), iG(6.67408e-11)
+		widget(aLayout), iPacedSurface(nullptr), iPreviousPacing(frame_pacing::OnDemand), iEnableZSorting(false), iG(6.67408e-11)
 	{
 		surface().native_surface().rendering_check([this]()
 		{
 			if (update_objects())
 				update();
 		}, this);
+		request_continuous_pacing();
 	}
 
 	sprite_plane::~sprite_plane()
 	{
 		if (has_surface() && !surface().destroyed())
 			surface().native_surface().rendering_check.unsubscribe(this);
+		restore_pacing();
 	}
 
 	void sprite_plane::parent_changed()
@@ -65,6 +70,7 @@ namespace neogfx
 			if (update_objects())
 				update();
 		}, this);
+		request_continuous_pacing();
 	}
 
 	logical_coordinate_system sprite_plane::logical_coordinate_system() const
@@ -345,4 +351,20 @@ namespace neogfx
 		physics_applied.trigger();
 		return updated;
 	}
+
+	void sprite_plane::request_continuous_pacing()
+	{
+		restore_pacing();
+		iPacedSurface = &surface().native_surface();
+		iPreviousPacing = iPacedSurface->frame_pacing();
+		iPacedSurface->set_frame_pacing(frame_pacing::Continuous);
+	}
+
+	void sprite_plane::restore_pacing()
+	{
+		// we can only be sure the surface we changed is still alive if it is still ours
+		if (iPacedSurface != nullptr && has_surface() && !surface().destroyed() && &surface().native_surface() == iPacedSurface)
+			iPacedSurface->set_frame_pacing(iPreviousPacing);
+		iPacedSurface = nullptr;
+	}
 }
\ No newline at end of file
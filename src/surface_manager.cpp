@@ -121,6 +121,20 @@ namespace neogfx
 		iRenderingSurfaces = false;
 	}
 
+	boost::optional<frame_scheduler::time_point> surface_manager::next_frame_time() const
+	{
+		boost::optional<frame_scheduler::time_point> result;
+		for (auto& s : iSurfaces)
+		{
+			if (s->destroyed())
+				continue;
+			auto next = s->native_surface().next_frame_time();
+			if (next != boost::none && (result == boost::none || *next < *result))
+				result = next;
+		}
+		return result;
+	}
+
 	void surface_manager::display_error_message(const std::string& aTitle, const std::string& aMessage) const
 	{
 		for (auto i = iSurfaces.begin(); i != iSurfaces.end(); ++i)
@@ -162,6 +176,8 @@ namespace neogfx
 #else
 		/* todo */
 		rect rectSurface{ aSurface.surface_position(), aSurface.surface_size() };
+		if (display_count() == 0)
+			return rectSurface; // no displays (offscreen) so the surface is all the desktop there is
 		std::multimap<double, uint32_t> matches;
 		for (uint32_t i = 0; i < display_count(); ++i)
 		{
@@ -0,0 +1,118 @@
+// tessellation_cache.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "neogfx.hpp"
+#include "tessellation_cache.hpp"
+
+namespace neogfx
+{
+	tessellation_cache::tessellation_cache(std::size_t aCapacity) :
+		iCapacity(aCapacity), iHits(0), iMisses(0)
+	{
+	}
+
+	const tessellation_cache::vertices_t& tessellation_cache::arc(dimension aRadius, angle aStartAngle, angle aEndAngle, bool aIncludeCentre)
+	{
+		key_type key{ aRadius, aStartAngle, aEndAngle, aIncludeCentre };
+		auto existing = iIndex.find(key);
+		if (existing != iIndex.end())
+		{
+			++iHits;
+			iEntries.splice(iEntries.begin(), iEntries, existing->second);
+			return existing->second->second;
+		}
+		++iMisses;
+		iEntries.emplace_front(key, tessellate_arc(aRadius, aStartAngle, aEndAngle, aIncludeCentre));
+		iIndex[key] = iEntries.begin();
+		trim();
+		return iEntries.front().second;
+	}
+
+	void tessellation_cache::clear()
+	{
+		iEntries.clear();
+		iIndex.clear();
+	}
+
+	std::size_t tessellation_cache::size() const
+	{
+		return iEntries.size();
+	}
+
+	std::size_t tessellation_cache::capacity() const
+	{
+		return iCapacity;
+	}
+
+	void tessellation_cache::set_capacity(std::size_t aCapacity)
+	{
+		iCapacity = aCapacity;
+		trim();
+	}
+
+	uint64_t tessellation_cache::hits() const
+	{
+		return iHits;
+	}
+
+	uint64_t tessellation_cache::misses() const
+	{
+		return iMisses;
+	}
+
+	void tessellation_cache::reset_counters()
+	{
+		iHits = 0;
+		iMisses = 0;
+	}
+
+	tessellation_cache::vertices_t tessellation_cache::tessellate_arc(dimension aRadius, angle aStartAngle, angle aEndAngle, bool aIncludeCentre)
+	{
+		vertices_t result;
+		uint32_t segments = static_cast<uint32_t>(20 * std::sqrt(aRadius));
+		result.reserve(segments + (aIncludeCentre ? 1 : 0));
+		if (aIncludeCentre)
+			result.push_back(vec2{ 0.0, 0.0 });
+		coordinate theta = (aEndAngle - aStartAngle) / static_cast<coordinate>(segments);
+		coordinate c = std::cos(theta);
+		coordinate s = std::sin(theta);
+		auto startCoordinate = mat22{ { std::cos(aStartAngle), std::sin(aStartAngle) },{ -std::sin(aStartAngle), std::cos(aStartAngle) } } *
+			vec2{ aRadius, 0.0 };
+		coordinate x = startCoordinate.x;
+		coordinate y = startCoordinate.y;
+		for (uint32_t i = 0; i < segments; ++i)
+		{
+			result.push_back(vec2{ x, y });
+			coordinate t = x;
+			x = c * x - s * y;
+			y = s * t + c * y;
+		}
+		return result;
+	}
+
+	void tessellation_cache::trim()
+	{
+		// never evict the most recently used entry as a reference to it may have just been returned
+		while (iEntries.size() > std::max<std::size_t>(iCapacity, 1))
+		{
+			iIndex.erase(iEntries.back().first);
+			iEntries.pop_back();
+		}
+	}
+}
@@ -1142,82 +1142,58 @@ namespace neogfx
 
 	void text_edit::draw_glyphs(const graphics_context& aGraphicsContext, const point& aPoint, glyph_lines::const_iterator aLine) const
 	{
+		glyph_run outlineRun;
+		glyph_run textRun;
+		point pos = aPoint;
+		for (document_glyphs::const_iterator i = aLine->start; i != aLine->end; ++i)
 		{
-			std::unique_ptr<graphics_context::glyph_drawing> gd;
-			bool outlinesPresent = false;
-			for (uint32_t pass = 0; pass <= 2; ++pass)
+			bool selected = static_cast<cursor::position_type>(i - iGlyphs.begin()) >= std::min(cursor().position(), cursor().anchor()) &&
+				static_cast<cursor::position_type>(i - iGlyphs.begin()) < std::max(cursor().position(), cursor().anchor());
+			const auto& glyph = *i;
+			const auto& tagContents = iText.tag(iText.begin() + from_glyph(i).first).contents();
+			const auto& style = *static_variant_cast<style_list::const_iterator>(tagContents);
+			const auto& glyphFont = style.font() != boost::none ? *style.font() : font();
+			if (selected)
+				aGraphicsContext.fill_rect(rect{ pos, size{glyph.extents().cx, aLine->extents.cy} }, app::instance().current_style().selection_colour());
+			if (!style.text_outline_colour().empty())
 			{
-				if (pass == 1)
-					gd = std::make_unique<graphics_context::glyph_drawing>(aGraphicsContext);
-				point pos = aPoint;
-				for (document_glyphs::const_iterator i = aLine->start; i != aLine->end; ++i)
+				static point sOutlinePositions[] = 
 				{
-					bool selected = static_cast<cursor::position_type>(i - iGlyphs.begin()) >= std::min(cursor().position(), cursor().anchor()) &&
-						static_cast<cursor::position_type>(i - iGlyphs.begin()) < std::max(cursor().position(), cursor().anchor());
-					const auto& glyph = *i;
-					const auto& tagContents = iText.tag(iText.begin() + from_glyph(i).first).contents();
-					const auto& style = *static_variant_cast<style_list::const_iterator>(tagContents);
-					const auto& glyphFont = style.font() != boost::none ? *style.font() : font();
-					switch (pass)
-					{
-					case 0:
-						if (selected)
-							aGraphicsContext.fill_rect(rect{ pos, size{glyph.extents().cx, aLine->extents.cy} }, app::instance().current_style().selection_colour());
-						break;
-					case 1:
-						if (style.text_outline_colour().empty())
-						{
-							pos.x += glyph.extents().cx;
-							continue;
-						}
-						outlinesPresent = true;
-						for (uint32_t outlinePos = 0; outlinePos < 8; ++outlinePos)
-						{
-							static point sOutlinePositions[] = 
-							{
-								point{-1.0, -1.0}, point{0.0, -1.0}, point{1.0, -1.0},
-								point{-1.0, 0.0}, point{1.0, 0.0},
-								point{-1.0, 1.0}, point{0.0, 1.0}, point{1.0, 1.0},
-							};
-							aGraphicsContext.draw_glyph(sOutlinePositions[outlinePos] + pos + glyph.offset() + point{ 0.0, aLine->extents.cy - glyphFont.height() - 1.0 }, glyph,
-								glyphFont,
-								style.text_outline_colour().is<colour>() ?
-									static_variant_cast<const colour&>(style.text_outline_colour()) : style.text_outline_colour().is<gradient>() ?
-										static_variant_cast<const gradient&>(style.text_outline_colour()).at((pos.x - margins().left + horizontal_scrollbar().position()) / std::max(client_rect(false).width(), iTextExtents.cx)) :
-										default_text_colour());
-						}
-						break;
-					case 2:
-						aGraphicsContext.draw_glyph(pos + glyph.offset() + point{ 0.0, aLine->extents.cy - glyphFont.height() - (outlinesPresent ? 1.0 : 0.0)}, glyph,
-							glyphFont,
-							selected ? 
-								(app::instance().current_style().selection_colour().light() ? colour::Black : colour::White) :
-								style.text_colour().is<colour>() ?
-									static_variant_cast<const colour&>(style.text_colour()) : style.text_colour().is<gradient>() ? 
-										static_variant_cast<const gradient&>(style.text_colour()).at((pos.x - margins().left + horizontal_scrollbar().position()) / std::max(client_rect(false).width(), iTextExtents.cx)) :
-										default_text_colour());
-						break;
-					}
-					pos.x += glyph.extents().cx;
-				}
+					point{-1.0, -1.0}, point{0.0, -1.0}, point{1.0, -1.0},
+					point{-1.0, 0.0}, point{1.0, 0.0},
+					point{-1.0, 1.0}, point{0.0, 1.0}, point{1.0, 1.0},
+				};
+				colour outlineColour = style.text_outline_colour().is<colour>() ?
+					static_variant_cast<const colour&>(style.text_outline_colour()) : style.text_outline_colour().is<gradient>() ?
+						static_variant_cast<const gradient&>(style.text_outline_colour()).at((pos.x - margins().left + horizontal_scrollbar().position()) / std::max(client_rect(false).width(), iTextExtents.cx)) :
+						default_text_colour();
+				for (uint32_t outlinePos = 0; outlinePos < 8; ++outlinePos)
+					outlineRun.push_back(glyph_run_item{ sOutlinePositions[outlinePos] + pos + point{ 0.0, aLine->extents.cy - glyphFont.height() - 1.0 }, &glyph, &glyphFont, outlineColour, false });
 			}
+			pos.x += glyph.extents().cx;
 		}
-		point pos = aPoint;
+		bool outlinesPresent = !outlineRun.empty();
+		pos = aPoint;
 		for (document_glyphs::const_iterator i = aLine->start; i != aLine->end; ++i)
 		{
+			bool selected = static_cast<cursor::position_type>(i - iGlyphs.begin()) >= std::min(cursor().position(), cursor().anchor()) &&
+				static_cast<cursor::position_type>(i - iGlyphs.begin()) < std::max(cursor().position(), cursor().anchor());
 			const auto& glyph = *i;
 			const auto& tagContents = iText.tag(iText.begin() + from_glyph(i).first).contents();
 			const auto& style = *static_variant_cast<style_list::const_iterator>(tagContents);
 			const auto& glyphFont = style.font() != boost::none ? *style.font() : font();
-			if (glyph.underline())
-				aGraphicsContext.draw_glyph_underline(pos + point{ 0.0, aLine->extents.cy - glyphFont.height() }, glyph,
-					glyphFont,
+			textRun.push_back(glyph_run_item{ pos + point{ 0.0, aLine->extents.cy - glyphFont.height() - (outlinesPresent ? 1.0 : 0.0) }, &glyph, &glyphFont,
+				selected ?
+					(app::instance().current_style().selection_colour().light() ? colour::Black : colour::White) :
 					style.text_colour().is<colour>() ?
-						static_variant_cast<const colour&>(style.text_colour()) : style.text_colour().is<gradient>() ? 
-							static_variant_cast<const gradient&>(style.text_colour()).at((pos.x - margins().left) / client_rect(false).width()) : 
-							default_text_colour());
+						static_variant_cast<const colour&>(style.text_colour()) : style.text_colour().is<gradient>() ?
+							static_variant_cast<const gradient&>(style.text_colour()).at((pos.x - margins().left + horizontal_scrollbar().position()) / std::max(client_rect(false).width(), iTextExtents.cx)) :
+							default_text_colour(),
+				glyph.underline() });
 			pos.x += glyph.extents().cx;
 		}
+		aGraphicsContext.draw_glyph_run(outlineRun);
+		aGraphicsContext.draw_glyph_run(textRun);
 	}
 
 	void text_edit::draw_cursor(const graphics_context& aGraphicsContext) const
@@ -0,0 +1,258 @@
+// text_shaper.cpp
+/*
+  neogfx C++ GUI Library
+  Copyright(C) 2016 Leigh Johnston
+  
+  This program is free software: you can redistribute it and / or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+  
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+  
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "neogfx.hpp"
+#include "text_shaper.hpp"
+#include "text_direction_map.hpp"
+#include "i_native_font_face.hpp"
+#include "native_font_face.hpp"
+
+namespace neogfx
+{
+	glyph_text text_shaper::to_glyph_text(string::const_iterator aTextBegin, string::const_iterator aTextEnd, std::function<font(std::string::size_type)> aFontSelector) const
+	{
+		bool fallbackNeeded = false;
+		glyph_text::container result = to_glyph_text_impl(aTextBegin, aTextEnd, aFontSelector, fallbackNeeded);
+		if (fallbackNeeded)
+		{
+			glyph_text::container fallbackResult = 
+				to_glyph_text_impl(aTextBegin, aTextEnd, [&aFontSelector](std::string::size_type aSourceIndex) { return aFontSelector(aSourceIndex).fallback(); }, fallbackNeeded);
+			for (auto i = result.begin(), j = fallbackResult.begin(); i != result.end(); ++i, ++j)
+			{
+				if (i->use_fallback())
+				{
+					*i = *j;
+					i->set_use_fallback(true);
+				}
+			}
+		}
+		return glyph_text(aFontSelector(0), std::move(result));
+	}
+
+	void text_shaper::set_mnemonic(bool aShowMnemonics, char aMnemonicPrefix)
+	{
+		iMnemonic = std::make_pair(aShowMnemonics, aMnemonicPrefix);
+	}
+
+	void text_shaper::unset_mnemonic()
+	{
+		iMnemonic = boost::none;
+	}
+
+	bool text_shaper::mnemonics_shown() const
+	{
+		return iMnemonic != boost::none && iMnemonic->first;
+	}
+
+
+	glyph_text::container text_shaper::to_glyph_text_impl(string::const_iterator aTextBegin, string::const_iterator aTextEnd, std::function<font(std::string::size_type)> aFontSelector, bool& aFallbackFontNeeded) const
+	{
+		glyph_text::container result;
+		aFallbackFontNeeded = false;
+		if (aTextEnd - aTextBegin == 0)
+			return result;
+
+		auto& clusterMap = iClusterMap;
+		clusterMap.clear();
+		auto& textDirections = iTextDirections;
+		textDirections.clear();
+
+		iCodePointsBuffer.clear();
+		std::u32string& codePoints = iCodePointsBuffer;
+
+		codePoints = neolib::utf8_to_utf32(aTextBegin, aTextEnd, [&clusterMap](std::string::size_type aFrom, std::u32string::size_type)
+		{
+			clusterMap.push_back(cluster{aFrom});
+		});
+		
+		if (iMnemonic != boost::none)
+		{
+			for (auto i = codePoints.begin(); i != codePoints.end();)
+			{
+				if (*i == static_cast<char32_t>(iMnemonic->second))
+				{
+					clusterMap.erase(clusterMap.begin() + (i - codePoints.begin()));
+					i = codePoints.erase(i);
+					if (i != codePoints.end())
+					{
+						auto& cluster = *(clusterMap.begin() + (i - codePoints.begin()));
+						if (*i != static_cast<char32_t>(iMnemonic->second))
+							cluster.flags = glyph::Mnemonic;
+					}
+				}
+				else
+					++i;
+			}
+		}
+
+		if (codePoints.empty())
+			return result;
+		
+		auto& runs = iRuns;
+		runs.clear();
+		text_direction previousDirection = get_text_direction(codePoints[0]);
+		char32_t* runStart = &codePoints[0];
+		std::size_t lastCodePointIndex = codePoints.size() - 1;
+		font previousFont = aFontSelector(clusterMap[0].from);
+		hb_script_t previousScript = hb_unicode_script(static_cast<native_font_face::hb_handle*>(previousFont.native_font_face().aux_handle())->unicodeFuncs, codePoints[0]);
+
+		std::deque<std::pair<text_direction, bool>> directionStack;
+		const char32_t LRE = U'\u202A';
+		const char32_t RLE = U'\u202B';
+		const char32_t LRO = U'\u202D';
+		const char32_t RLO = U'\u202E';
+		const char32_t PDF = U'\u202C';
+
+		bool currentLineHasLTR = false;
+
+		for (std::size_t i = 0; i <= lastCodePointIndex; ++i)
+		{
+			font currentFont = aFontSelector(clusterMap[i].from);
+			if (currentFont.password())
+				codePoints[i] = neolib::utf8_to_utf32(currentFont.password_mask())[0];
+			if (codePoints[i] == '\r' || codePoints[i] == '\n')
+				currentLineHasLTR = false;
+			switch (codePoints[i])
+			{
+			case PDF:
+				if (!directionStack.empty())
+					directionStack.pop_back();
+				break;
+			case LRE:
+				directionStack.push_back(std::make_pair(text_direction::LTR, false));
+				break;
+			case RLE:
+				directionStack.push_back(std::make_pair(text_direction::RTL, false));
+				break;
+			case LRO:
+				directionStack.push_back(std::make_pair(text_direction::LTR, true));
+				break;
+			case RLO:
+				directionStack.push_back(std::make_pair(text_direction::RTL, true));
+				break;
+			default:
+				break;
+			}
+			hb_unicode_funcs_t* unicodeFuncs = static_cast<native_font_face::hb_handle*>(currentFont.native_font_face().aux_handle())->unicodeFuncs;
+			text_direction currentDirection = get_text_direction(codePoints[i]);
+			textDirections.push_back(currentDirection);
+			auto bidi_check = [&directionStack](text_direction aDirection)
+			{
+				if (!directionStack.empty())
+				{
+					switch (aDirection)
+					{
+					case text_direction::LTR:
+					case text_direction::RTL:
+						if (directionStack.back().second == true)
+							return directionStack.back().first;
+						break;
+					case text_direction::None:
+					case text_direction::Whitespace:
+						return directionStack.back().first;
+						break;
+					default:
+						break;
+					}
+				}
+				return aDirection;
+			};
+			currentDirection = bidi_check(currentDirection);
+			if (currentDirection == text_direction::LTR)
+				currentLineHasLTR = true;
+			hb_script_t currentScript = hb_unicode_script(unicodeFuncs, codePoints[i]);
+			bool newRun = previousFont != currentFont || (previousDirection == text_direction::LTR && currentDirection == text_direction::RTL) ||
+				(previousDirection == text_direction::RTL && currentDirection == text_direction::LTR) ||
+				(previousScript != currentScript && (previousScript != HB_SCRIPT_COMMON && currentScript != HB_SCRIPT_COMMON)) ||
+				i == lastCodePointIndex;
+			if (!newRun)
+			{
+				if ((currentDirection == text_direction::Whitespace || currentDirection == text_direction::None) && previousDirection == text_direction::RTL)
+				{
+					for (std::size_t j = i + 1; j <= lastCodePointIndex; ++j)
+					{
+						text_direction nextDirection = bidi_check(get_text_direction(codePoints[j]));
+						if (nextDirection == text_direction::RTL)
+							break;
+						else if (nextDirection == text_direction::LTR || (j == lastCodePointIndex - 1 && currentLineHasLTR))
+						{
+							newRun = true;
+							currentDirection = text_direction::LTR;
+							break;
+						}
+					}
+				}
+			}
+			if (newRun)
+			{
+				runs.push_back(std::make_tuple(runStart, &codePoints[i != lastCodePointIndex ? i : i+1], previousDirection, previousScript));
+				runStart = &codePoints[i];
+			}
+			if (currentDirection == text_direction::LTR || currentDirection == text_direction::RTL)
+			{
+				previousDirection = currentDirection;
+				previousScript = currentScript;
+			}
+			previousFont = currentFont;
+		}
+
+		for (std::size_t i = 0; i < runs.size(); ++i)
+		{
+			std::string::size_type sourceClusterRunStart = (clusterMap.begin() + (std::get<0>(runs[i]) - &codePoints[0]))->from;
+			hb_font_t* hbFont = static_cast<native_font_face::hb_handle*>(aFontSelector(sourceClusterRunStart).native_font_face().aux_handle())->font;
+			hb_buffer_t* buf = static_cast<native_font_face::hb_handle*>(aFontSelector(sourceClusterRunStart).native_font_face().aux_handle())->buf;
+			hb_buffer_set_direction(buf, std::get<2>(runs[i]) == text_direction::RTL ? HB_DIRECTION_RTL : HB_DIRECTION_LTR);
+			hb_buffer_set_script(buf, std::get<3>(runs[i]));
+			hb_buffer_add_utf32(buf, reinterpret_cast<const uint32_t*>(std::get<0>(runs[i])), std::get<1>(runs[i]) - std::get<0>(runs[i]), 0, std::get<1>(runs[i]) - std::get<0>(runs[i]));
+			hb_shape(hbFont, buf, NULL, 0);
+			unsigned int glyphCount;
+			hb_glyph_info_t* glyphInfo = hb_buffer_get_glyph_infos(buf, &glyphCount);
+			hb_glyph_position_t* glyphPos = hb_buffer_get_glyph_positions(buf, &glyphCount);
+			for (unsigned int j = 0; j < glyphCount; ++j)
+			{
+				std::u32string::size_type cluster = glyphInfo[j].cluster + (std::get<0>(runs[i]) - &codePoints[0]);
+				if (glyphInfo[j].codepoint == 0)
+					glyphInfo[j].codepoint = aFontSelector(sourceClusterRunStart).native_font_face().glyph_index(codePoints[cluster]);
+				if (glyphInfo[j].codepoint == 0)
+					aFallbackFontNeeded = true;
+				std::string::size_type sourceClusterStart, sourceClusterEnd;
+				auto c = clusterMap.begin() + cluster;
+				sourceClusterStart = c->from;
+				if (c + 1 != clusterMap.end())
+					sourceClusterEnd = (c + 1)->from;
+				else
+					sourceClusterEnd = aTextEnd - aTextBegin;
+				if (j > 0)
+					result.back().kerning_adjust(static_cast<float>(aFontSelector(sourceClusterStart).kerning(glyphInfo[j - 1].codepoint, glyphInfo[j].codepoint)));
+				result.push_back(glyph(textDirections[cluster], glyphInfo[j].codepoint, glyph::source_type(sourceClusterStart, sourceClusterEnd), size(glyphPos[j].x_advance / 64.0, glyphPos[j].y_advance / 64.0), size(glyphPos[j].x_offset / 64.0, glyphPos[j].y_offset / 64.0)));
+				if (result.back().direction() == text_direction::Whitespace)
+					result.back().set_value(aTextBegin[sourceClusterStart]);
+				if ((aFontSelector(sourceClusterStart).style() & font::Underline) == font::Underline)
+					result.back().set_underline(true);
+				if ((c->flags & glyph::Mnemonic) == glyph::Mnemonic)
+					result.back().set_mnemonic(true);
+				if (glyphInfo[j].codepoint == 0)
+					result.back().set_use_fallback(true);
+			}
+			hb_buffer_clear_contents(buf);
+		}
+
+		return result;
+	}
+}
\ No newline at end of file
@@ -29,6 +29,11 @@ namespace neogfx
 	{
 	}
 
+	texture::texture(const size& aExtents) :
+		iNativeTexture(app::instance().rendering_engine().texture_manager().create_texture(aExtents))
+	{
+	}
+
 	texture::texture(const i_texture& aTexture) :
 		iNativeTexture(!aTexture.is_empty() ? aTexture.native_texture() : std::shared_ptr<i_native_texture>())
 	{
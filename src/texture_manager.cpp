@@ -18,15 +18,17 @@
 */
 
 #include "neogfx.hpp"
+#include <algorithm>
 #include "texture_manager.hpp"
 
 namespace neogfx
 {
 	class texture_wrapper : public i_native_texture
 	{
+		friend class texture_manager;
 	public:
 		texture_wrapper(texture_manager& aParent, texture_manager::texture_list::iterator aTexture) :
-			iParent(aParent), iTexture(aTexture), iTextureReference(aTexture->lock())
+			iParent(aParent), iTexture(aTexture), iTextureReference(aTexture->texture.lock())
 		{
 		}
 		~texture_wrapper()
@@ -52,22 +54,55 @@ namespace neogfx
 		{
 			return iTextureReference->is_resident();
 		}
+		virtual bool is_evictable() const
+		{
+			return iTextureReference->is_evictable();
+		}
+		virtual std::size_t memory_size() const
+		{
+			return iTextureReference->memory_size();
+		}
+		virtual void make_resident()
+		{
+			iParent.make_resident(iTexture);
+		}
+		virtual void evict()
+		{
+			iParent.evict(iTexture);
+		}
 		virtual const std::string& uri() const
 		{
 			return iTextureReference->uri();
 		}
+	public:
+		virtual const void* data() const
+		{
+			return iTextureReference->data();
+		}
+		virtual void update(const rect& aRect, const void* aPixels)
+		{
+			iTextureReference->update(aRect, aPixels);
+		}
 	private:
 		texture_manager& iParent;
 		texture_manager::texture_list::iterator iTexture;
 		std::shared_ptr<i_native_texture> iTextureReference;
 	};
 
+	texture_manager::texture_manager() :
+		iMemoryBudget(DefaultTextureMemoryBudget), iMemoryUsed(0), iFrame(0), iUploads(0), iEvictions(0)
+	{
+	}
+
 	std::unique_ptr<i_native_texture> texture_manager::join_texture(const i_native_texture& aTexture)
 	{
+		auto wrapper = dynamic_cast<const texture_wrapper*>(&aTexture);
+		if (wrapper != nullptr)
+			return std::make_unique<texture_wrapper>(*this, wrapper->iTexture);
 		for (auto i = iTextures.begin(); i != iTextures.end(); ++i)
 		{
-			auto p = i->lock();
-			if (aTexture.handle() == p->handle())
+			auto p = i->texture.lock();
+			if (p.get() == &aTexture)
 				return std::make_unique<texture_wrapper>(*this, i);
 		}
 		throw texture_not_found();
@@ -81,6 +116,38 @@ namespace neogfx
 	void texture_manager::clear_textures()
 	{
 		iTextures.clear();
+		iMemoryUsed = 0;
+	}
+
+	uint64_t texture_manager::texture_memory_budget() const
+	{
+		return iMemoryBudget;
+	}
+
+	void texture_manager::set_texture_memory_budget(uint64_t aBudget)
+	{
+		iMemoryBudget = aBudget;
+	}
+
+	uint64_t texture_manager::texture_memory_used() const
+	{
+		return iMemoryUsed;
+	}
+
+	uint64_t texture_manager::texture_uploads() const
+	{
+		return iUploads;
+	}
+
+	uint64_t texture_manager::texture_evictions() const
+	{
+		return iEvictions;
+	}
+
+	void texture_manager::end_frame()
+	{
+		evict_to_budget(0);
+		++iFrame;
 	}
 
 	const texture_manager::texture_list& texture_manager::textures() const
@@ -97,7 +164,7 @@ namespace neogfx
 	{
 		for (auto i = iTextures.begin(); i != iTextures.end(); ++i)
 		{
-			auto p = i->lock();
+			auto p = i->texture.lock();
 			if (!aImage.uri().empty() && aImage.uri() == p->uri())
 				return i;
 		}
@@ -108,7 +175,7 @@ namespace neogfx
 	{
 		for (auto i = iTextures.begin(); i != iTextures.end(); ++i)
 		{
-			auto p = i->lock();
+			auto p = i->texture.lock();
 			if (!aImage.uri().empty() && aImage.uri() == p->uri())
 				return i;
 		}
@@ -117,13 +184,55 @@ namespace neogfx
 
 	std::unique_ptr<i_native_texture> texture_manager::add_texture(std::shared_ptr<i_native_texture> aTexture)
 	{
-		auto newTexture = iTextures.insert(iTextures.end(), aTexture);
+		auto newTexture = iTextures.insert(iTextures.end(), texture_entry{ aTexture, 0, iFrame });
 		return std::make_unique<texture_wrapper>(*this, newTexture);
 	}
 
+	void texture_manager::make_resident(texture_list::iterator aTexture)
+	{
+		aTexture->lastUsed = iFrame;
+		auto p = aTexture->texture.lock();
+		if (p->is_resident())
+			return;
+		evict_to_budget(p->memory_size());
+		p->make_resident();
+		aTexture->residentSize = p->memory_size();
+		iMemoryUsed += aTexture->residentSize;
+		++iUploads;
+	}
+
+	void texture_manager::evict(texture_list::iterator aTexture)
+	{
+		auto p = aTexture->texture.lock();
+		if (!p->is_resident() || !p->is_evictable())
+			return;
+		p->evict();
+		iMemoryUsed -= aTexture->residentSize;
+		aTexture->residentSize = 0;
+		++iEvictions;
+	}
+
+	void texture_manager::evict_to_budget(uint64_t aRequired)
+	{
+		if (iMemoryUsed + aRequired <= iMemoryBudget)
+			return;
+		// only textures not drawn during the current frame are candidates as commands referencing the others
+		// may not have been replayed yet
+		std::vector<texture_list::iterator> candidates;
+		for (auto i = iTextures.begin(); i != iTextures.end(); ++i)
+			if (i->residentSize != 0 && i->lastUsed != iFrame && !i->texture.expired() && i->texture.lock()->is_evictable())
+				candidates.push_back(i);
+		std::sort(candidates.begin(), candidates.end(), [](texture_list::iterator aLeft, texture_list::iterator aRight) { return aLeft->lastUsed < aRight->lastUsed; });
+		for (auto i = candidates.begin(); i != candidates.end() && iMemoryUsed + aRequired > iMemoryBudget; ++i)
+			evict(*i);
+	}
+
 	void texture_manager::cleanup(texture_list::iterator aTexture)
 	{
-		if (aTexture->expired())
+		if (aTexture->texture.expired())
+		{
+			iMemoryUsed -= aTexture->residentSize;
 			iTextures.erase(aTexture);
+		}
 	}
 }
\ No newline at end of file
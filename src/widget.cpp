@@ -20,6 +20,7 @@
 #include "neogfx.hpp"
 #include <neolib/raii.hpp>
 #include "app.hpp"
+#include "profiler.hpp"
 #include "widget.hpp"
 #include "i_layout.hpp"
 
@@ -27,6 +28,8 @@
 
 namespace neogfx
 {
+	uint32_t widget::sUpdatePropagation;
+
 	widget::device_metrics_forwarder::device_metrics_forwarder(widget& aOwner) :
 		iOwner(aOwner)
 	{
@@ -61,6 +64,10 @@ namespace neogfx
 		iMinimumSize{},
 		iMaximumSize{},
 		iLayoutInProgress(0),
+		iLayerCaching(neogfx::layer_caching::Automatic),
+		iLayerValid(false),
+		iSelfUpdatePending(false),
+		iLayerReuse(0),
 		iVisible(true),
 		iEnabled(true),
 		iFocusPolicy(focus_policy::NoFocus),
@@ -79,6 +86,10 @@ namespace neogfx
 		iMinimumSize{},
 		iMaximumSize{},
 		iLayoutInProgress(0),
+		iLayerCaching(neogfx::layer_caching::Automatic),
+		iLayerValid(false),
+		iSelfUpdatePending(false),
+		iLayerReuse(0),
 		iVisible(true),
 		iEnabled(true),
 		iFocusPolicy(focus_policy::NoFocus),
@@ -98,6 +109,10 @@ namespace neogfx
 		iMinimumSize{},
 		iMaximumSize{},
 		iLayoutInProgress(0),
+		iLayerCaching(neogfx::layer_caching::Automatic),
+		iLayerValid(false),
+		iSelfUpdatePending(false),
+		iLayerReuse(0),
 		iVisible(true),
 		iEnabled(true),
 		iFocusPolicy(focus_policy::NoFocus),
@@ -440,6 +455,7 @@ namespace neogfx
 		{
 			if (has_layout())
 			{
+				profiler::scope ps(profiler::Layout, this);
 				layout_items_started();
 				if (is_root() && size_policy() != neogfx::size_policy::Manual)
 				{
@@ -729,22 +745,40 @@ namespace neogfx
 			return;
 		if (aUpdateRect.empty())
 			return;
-		if (iUpdateRects.find(aUpdateRect) == iUpdateRects.end())
+		if (sUpdatePropagation == 0)
+		{
+			profiler::record_update(*this);
+			// our own content has changed so any layer containing it (ours, a descendant's or an ancestor's) is now stale
+			iSelfUpdatePending = true;
+			invalidate_layer(true);
+			for (i_widget* w = this;; w = &w->parent())
+			{
+				w->invalidate_layer();
+				if (w->is_root() || !w->has_parent())
+					break;
+			}
+		}
+		if (!iUpdateRegion.contains(aUpdateRect))
 		{
-			iUpdateRects.insert(aUpdateRect);
+			iUpdateRegion.combine(aUpdateRect);
+			++sUpdatePropagation;
 			if ((iBackgroundColour == boost::none || iBackgroundColour->alpha() != 0xFF) && has_parent() && has_surface() && same_surface(parent()))
 				parent().update(rect(aUpdateRect.position() + position() + (origin() - origin(true)), aUpdateRect.extents()));
 			else
 				surface().invalidate_surface(aUpdateRect + origin());
-			for (auto& c : iChildren)
+			if (!layer_cached())
 			{
-				if (c->hidden())
-					continue;
-				rect rectChild(c->position(), c->extents());
-				rect intersection = aUpdateRect.intersection(rectChild);
-				if (!intersection.empty())
-					c->update();
+				for (auto& c : iChildren)
+				{
+					if (c->hidden())
+						continue;
+					rect rectChild(c->position(), c->extents());
+					rect intersection = aUpdateRect.intersection(rectChild);
+					if (!intersection.empty())
+						c->update();
+				}
 			}
+			--sUpdatePropagation;
 		}
 	}
 
@@ -753,17 +787,22 @@ namespace neogfx
 		if (!surface().native_surface().using_frame_buffer())
 			return true;
 		else
-			return !iUpdateRects.empty();
+			return !iUpdateRegion.empty();
 	}
 
 	rect widget::update_rect() const
 	{
-		if (iUpdateRects.empty())
+		if (iUpdateRegion.empty())
 			throw no_update_rect();
-		rect result = *(iUpdateRects.begin());
-		for (const auto& ur : iUpdateRects)
-			result = result.combine(ur);
-		return result;
+		return iUpdateRegion.bounding_rect();
+	}
+
+	void widget::discard_update()
+	{
+		iUpdateRegion.clear();
+		iSelfUpdatePending = false;
+		for (auto& c : iChildren)
+			c->discard_update();
 	}
 
 	rect widget::default_clip_rect(bool aIncludeNonClient) const
@@ -786,43 +825,94 @@ namespace neogfx
 	{
 		if (effectively_hidden())
 		{
-			iUpdateRects.clear();
+			iUpdateRegion.clear();
 			return;
 		}
+		profiler::scope ps(profiler::Render, this);
+		compute_occlusion();
+		bool restoredFromLayer = false;
+		bool repaintedEntirely = false;
 		if (requires_update())
 		{
-			aGraphicsContext.set_extents(extents());
-			aGraphicsContext.set_origin(origin(true));
-			aGraphicsContext.scissor_on(default_clip_rect(true));
-			paint_non_client(aGraphicsContext);
-			aGraphicsContext.scissor_off();
-			aGraphicsContext.set_extents(client_rect().extents());
-			aGraphicsContext.set_origin(origin());
-			aGraphicsContext.scissor_on(default_clip_rect());
-			auto savedCoordinateSystem = aGraphicsContext.logical_coordinate_system();
-			if (savedCoordinateSystem != logical_coordinate_system())
+			// repaints caused only by changes around us are what a layer saves so they are what enables automatic caching
+			if (iSelfUpdatePending)
+				iLayerReuse = iLayerReuse > 0 ? iLayerReuse - 1 : 0;
+			else if (iLayerReuse < AutomaticLayerCachingThreshold * 2)
+				++iLayerReuse;
+			iSelfUpdatePending = false;
+			if (layer_cached())
+			{
+				aGraphicsContext.set_extents(extents());
+				aGraphicsContext.set_origin(origin(true));
+				aGraphicsContext.copy_from_texture(*iLayer, point{});
+				restoredFromLayer = true;
+			}
+			else if (surface().native_surface().using_frame_buffer() && iUpdateRegion.difference(iOccludedRegion).empty())
+			{
+				// our opaque children are about to paint over everything that needs updating
+				repaintedEntirely = iUpdateRegion.contains(rect{ origin(true) - origin(), extents() });
+			}
+			else
 			{
-				aGraphicsContext.set_logical_coordinate_system(logical_coordinate_system());
-				if (logical_coordinate_system() == neogfx::logical_coordinate_system::AutomaticGui)
-					aGraphicsContext.set_origin(origin());
-				else if (logical_coordinate_system() == neogfx::logical_coordinate_system::AutomaticGame)
-					aGraphicsContext.set_origin(point{origin().x, surface().extents().cy - (origin().y + extents().cy)});
+				profiler::scope ps(profiler::Paint, this);
+				repaintedEntirely = iUpdateRegion.contains(rect{ origin(true) - origin(), extents() });
+				aGraphicsContext.set_extents(extents());
+				aGraphicsContext.set_origin(origin(true));
+				aGraphicsContext.scissor_on(default_clip_rect(true));
+				paint_non_client(aGraphicsContext);
+				aGraphicsContext.scissor_off();
+				aGraphicsContext.set_extents(client_rect().extents());
+				aGraphicsContext.set_origin(origin());
+				// pixels outside the update region are still valid in a frame buffer so leave them alone
+				aGraphicsContext.scissor_on(surface().native_surface().using_frame_buffer() ? 
+					default_clip_rect().intersection(iUpdateRegion.difference(iOccludedRegion).bounding_rect()) : default_clip_rect());
+				auto savedCoordinateSystem = aGraphicsContext.logical_coordinate_system();
+				if (savedCoordinateSystem != logical_coordinate_system())
+				{
+					aGraphicsContext.set_logical_coordinate_system(logical_coordinate_system());
+					if (logical_coordinate_system() == neogfx::logical_coordinate_system::AutomaticGui)
+						aGraphicsContext.set_origin(origin());
+					else if (logical_coordinate_system() == neogfx::logical_coordinate_system::AutomaticGame)
+						aGraphicsContext.set_origin(point{origin().x, surface().extents().cy - (origin().y + extents().cy)});
+				}
+				painting.trigger(aGraphicsContext);
+				paint(aGraphicsContext);
+				if (savedCoordinateSystem != aGraphicsContext.logical_coordinate_system())
+					aGraphicsContext.set_logical_coordinate_system(savedCoordinateSystem);
+				aGraphicsContext.scissor_off();
 			}
-			painting.trigger(aGraphicsContext);
-			paint(aGraphicsContext);
-			if (savedCoordinateSystem != aGraphicsContext.logical_coordinate_system())
-				aGraphicsContext.set_logical_coordinate_system(savedCoordinateSystem);
-			aGraphicsContext.scissor_off();
 		}
-		iUpdateRects.clear();
+		iUpdateRegion.clear();
+		std::size_t index = iChildren.size();
 		for (auto i = iChildren.rbegin(); i != iChildren.rend(); ++i)
 		{
 			const auto& c = *i;
+			if (iOccludedChildren[--index])
+			{
+				c->discard_update();
+				continue;
+			}
 			rect rectChild(c->position(), c->extents());
 			rect intersection = client_rect().intersection(rectChild);
 			if (!intersection.empty())
 				c->render(aGraphicsContext);
 		}
+		iOccludedRegion.clear();
+		if (!layer_caching_active() || !layer_cacheable())
+		{
+			iLayer = boost::none;
+			iLayerValid = false;
+		}
+		else if (repaintedEntirely && !restoredFromLayer)
+		{
+			// everything within our bounds has just been painted by us and our children so it can be kept for reuse
+			if (iLayer == boost::none || iLayer->extents() != extents())
+				iLayer = texture{ extents() };
+			aGraphicsContext.set_extents(extents());
+			aGraphicsContext.set_origin(origin(true));
+			aGraphicsContext.copy_to_texture(rect{ point{}, extents() }, *iLayer);
+			iLayerValid = true;
+		}
 	}
 
 	bool widget::transparent_background() const
@@ -834,11 +924,11 @@ namespace neogfx
 	{
 		if (has_background_colour() || !transparent_background())
 		{
-			if (surface().native_surface().using_frame_buffer())
-				for (const auto& ur : iUpdateRects)
-					aGraphicsContext.fill_rect(ur + (origin() - origin(true)), background_colour());
-			else
-				aGraphicsContext.fill_rect(client_rect() + (origin() - origin(true)), background_colour());
+			// whatever our opaque children cover will be painted by them
+			region fillRegion = surface().native_surface().using_frame_buffer() ? iUpdateRegion : region{ client_rect() };
+			fillRegion.subtract(iOccludedRegion);
+			for (const auto& fr : fillRegion)
+				aGraphicsContext.fill_rect(fr + (origin() - origin(true)), background_colour());
 		}
 	}
 
@@ -846,6 +936,45 @@ namespace neogfx
 	{
 	}
 
+	neogfx::layer_caching widget::layer_caching() const
+	{
+		return iLayerCaching;
+	}
+
+	void widget::set_layer_caching(neogfx::layer_caching aLayerCaching)
+	{
+		if (iLayerCaching != aLayerCaching)
+		{
+			iLayerCaching = aLayerCaching;
+			invalidate_layer();
+		}
+	}
+
+	bool widget::layer_cached() const
+	{
+		return iLayerValid && iLayer != boost::none && iLayer->extents() == extents() && layer_caching_active() && layer_cacheable();
+	}
+
+	void widget::invalidate_layer(bool aIncludeDescendants)
+	{
+		if (iLayerValid)
+		{
+			iLayerValid = false;
+			// a pending update was going to be satisfied from the layer without involving our children
+			if (!iUpdateRegion.empty())
+			{
+				++sUpdatePropagation;
+				for (auto& c : iChildren)
+					if (!c->hidden() && iUpdateRegion.intersects(rect{ c->position(), c->extents() }))
+						c->update();
+				--sUpdatePropagation;
+			}
+		}
+		if (aIncludeDescendants)
+			for (auto& c : iChildren)
+				c->invalidate_layer(true);
+	}
+
 	bool widget::has_foreground_colour() const
 	{
 		return iForegroundColour != boost::none;
@@ -1158,6 +1287,63 @@ namespace neogfx
 			return *this;
 	}
 
+	bool widget::layer_caching_active() const
+	{
+		switch (iLayerCaching)
+		{
+		case neogfx::layer_caching::On:
+			return true;
+		case neogfx::layer_caching::Automatic:
+			return iLayerReuse >= AutomaticLayerCachingThreshold;
+		case neogfx::layer_caching::Off:
+		default:
+			return false;
+		}
+	}
+
+	bool widget::layer_cacheable() const
+	{
+		// a layer is only reusable if it does not depend on anything painted beneath us and holds all of our pixels
+		if (is_root() || !has_surface() || !surface().native_surface().using_frame_buffer() ||
+			logical_coordinate_system() != neogfx::logical_coordinate_system::AutomaticGui)
+			return false;
+		if (!opaque(*this))
+			return false;
+		return default_clip_rect(true).contains(rect{ point{}, extents() });
+	}
+
+	bool widget::opaque(const i_widget& aWidget)
+	{
+		return (aWidget.has_background_colour() || !aWidget.transparent_background()) && aWidget.background_colour().alpha() == 0xFF;
+	}
+
+	void widget::compute_occlusion() const
+	{
+		// walk our children front to back: a child is not rendered if opaque children in front of it cover it entirely and 
+		// the area covered by opaque children need not be filled with our background
+		iOccludedRegion.clear();
+		iOccludedChildren.assign(iChildren.size(), false);
+		std::size_t index = 0;
+		for (const auto& c : iChildren)
+		{
+			std::size_t current = index++;
+			if (c->effectively_hidden())
+				continue;
+			rect visible = client_rect().intersection(rect{ c->position(), c->extents() });
+			if (visible.empty())
+				continue;
+			if (iOccludedRegion.contains(visible))
+				iOccludedChildren[current] = true;
+			else if (opaque(*c))
+			{
+				// only a child's client area is sure to be filled; its non-client area (e.g. a dotted frame) may not be
+				rect filled = client_rect().intersection(c->client_rect() + c->position());
+				if (!filled.empty())
+					iOccludedRegion.combine(filled);
+			}
+		}
+	}
+
 	graphics_context widget::create_graphics_context() const
 	{
 		return graphics_context(*this);
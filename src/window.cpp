@@ -418,7 +418,11 @@ namespace neogfx
 	{
 		iNativeWindow->invalidate(aInvalidatedRect);
 		if (!aInternal)
+		{
+			// external invalidation (e.g. a style change) can alter the appearance of any widget
+			invalidate_layer(true);
 			update(aInvalidatedRect);
+		}
 	}
 
 	void window::render_surface()
@@ -705,7 +709,9 @@ namespace neogfx
 		graphics_context gc(surface());
 		gc.set_extents(extents());
 		gc.set_origin(origin());
+		gc.begin_recording();
 		render(gc);
+		gc.end_recording();
 	}
 
 	void window::native_window_dismiss_children()